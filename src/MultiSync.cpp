@@ -70,6 +70,16 @@ MultiSync *multiSync;
 
 static const char * MULTISYNC_MULTICAST_ADDRESS = "239.70.80.80"; // 239.F.P.P
 
+// remote clock estimator tuning
+#define CLOCK_SAMPLE_COUNT       16   // samples kept for the drift fit
+#define CLOCK_FILTER_COUNT       8    // newest samples searched for the best offset
+#define CLOCK_MIN_SAMPLES        4    // samples needed before the estimate is used
+#define CLOCK_FAST_INTERVAL      250000
+#define CLOCK_REQUEST_INTERVAL   1000000
+#define CLOCK_MAX_DELAY          500000
+#define CLOCK_MIN_DRIFT_SPAN     5000000
+#define CLOCK_MAX_DRIFT_PPM      500.0
+
 /*
  *
  */
@@ -82,10 +92,28 @@ MultiSync::MultiSync()
 	m_remoteOffset(0.0),
     m_numLocalSystems(0),
     m_lastPingTime(0),
-    m_lastCheckTime(0)
+    m_lastCheckTime(0),
+	m_clockSampleIdx(0),
+	m_clockValid(false),
+	m_clockOffset(0),
+	m_clockOffsetTime(0),
+	m_clockDelay(0),
+	m_clockDrift(0.0),
+	m_lastTimeRequest(0),
+	m_timeRequests(0),
+	m_timeReplies(0),
+	m_syncThreadRunning(false),
+	m_syncPending(false),
+	m_syncSending(false),
+	m_syncFrame(0),
+	m_syncSeconds(0.0),
+	m_syncTime(0)
 {
 	pthread_mutex_init(&m_systemsLock, NULL);
 	pthread_mutex_init(&m_socketLock, NULL);
+	pthread_mutex_init(&m_clockLock, NULL);
+	pthread_mutex_init(&m_syncLock, NULL);
+	pthread_cond_init(&m_syncCond, NULL);
 }
 
 /*
@@ -97,6 +125,9 @@ MultiSync::~MultiSync()
 
 	pthread_mutex_destroy(&m_systemsLock);
 	pthread_mutex_destroy(&m_socketLock);
+	pthread_mutex_destroy(&m_clockLock);
+	pthread_mutex_destroy(&m_syncLock);
+	pthread_cond_destroy(&m_syncCond);
 }
 
 /*
@@ -118,6 +149,8 @@ int MultiSync::Init(void)
 
 		if (!OpenCSVControlSockets())
 			return 0;
+
+		StartSyncSendThread();
 	}
 
 	return 1;
@@ -555,7 +588,12 @@ int MultiSync::CreatePingPacket(MultiSyncSystem &sysInfo, char* outBuf, int disc
     strncpy((char *)(ed + 12), sysInfo.hostname.c_str(), 65);
     strncpy((char *)(ed + 77), sysInfo.version.c_str(), 41);
     strncpy((char *)(ed + 118), sysInfo.model.c_str(), 41);
-    strncpy((char *)(ed + 159), sysInfo.ranges.c_str(), 41);
+    // only room for 40 chars of ranges, don't send a partial range
+    std::string ranges = sysInfo.ranges;
+    while (ranges.size() > 40 && ranges.find(',') != std::string::npos) {
+        ranges = ranges.substr(0, ranges.rfind(','));
+    }
+    strncpy((char *)(ed + 159), ranges.c_str(), 41);
     SendBroadcastPacket(outBuf, sizeof(ControlPkt) + cpkt->extraDataLen);
     return sizeof(ControlPkt) + cpkt->extraDataLen;
 }
@@ -586,6 +624,8 @@ void MultiSync::SendSeqSyncStartPacket(const char *filename)
 	cpkt->pktType        = CTRL_PKT_SYNC;
 	cpkt->extraDataLen   = sizeof(SyncPkt) + strlen(filename);
 	
+	CancelPendingSeqSync();
+
 	spkt->pktType  = SYNC_PKT_START;
 	spkt->fileType = SYNC_FILE_SEQ;
 	spkt->frameNumber = 0;
@@ -602,6 +642,43 @@ void MultiSync::SendSeqSyncStartPacket(const char *filename)
 	}
 }
 
+/*
+ * Tell the remotes which sequence will be started next so they can open
+ * it and read the first frames before the start packet arrives.  Older
+ * remotes ignore the unknown packet type.
+ */
+void MultiSync::SendSeqOpenPacket(const char *filename)
+{
+	LogDebug(VB_SYNC, "SendSeqOpenPacket('%s')\n", filename);
+
+	if (!filename || !filename[0])
+		return;
+
+	if (m_controlSock < 0) {
+		LogErr(VB_SYNC, "ERROR: Tried to send open packet but sync socket is not open.\n");
+		return;
+	}
+
+	char           outBuf[2048];
+	bzero(outBuf, sizeof(outBuf));
+
+	ControlPkt    *cpkt = (ControlPkt*)outBuf;
+	SyncPkt *spkt = (SyncPkt*)(outBuf + sizeof(ControlPkt));
+
+	InitControlPacket(cpkt);
+
+	cpkt->pktType        = CTRL_PKT_SYNC;
+	cpkt->extraDataLen   = sizeof(SyncPkt) + strlen(filename);
+
+	spkt->pktType  = SYNC_PKT_OPEN;
+	spkt->fileType = SYNC_FILE_SEQ;
+	spkt->frameNumber = 0;
+	spkt->secondsElapsed = 0;
+	strcpy(spkt->filename, filename);
+
+	SendControlPacket(outBuf, sizeof(ControlPkt) + sizeof(SyncPkt) + strlen(filename));
+}
+
 /*
  *
  */
@@ -628,6 +705,8 @@ void MultiSync::SendSeqSyncStopPacket(const char *filename)
 	cpkt->pktType        = CTRL_PKT_SYNC;
 	cpkt->extraDataLen   = sizeof(SyncPkt) + strlen(filename);
 	
+	CancelPendingSeqSync();
+
 	spkt->pktType  = SYNC_PKT_STOP;
 	spkt->fileType = SYNC_FILE_SEQ;
 	spkt->frameNumber = 0;
@@ -649,7 +728,7 @@ void MultiSync::SendSeqSyncStopPacket(const char *filename)
  */
 void MultiSync::SendSeqSyncPacket(const char *filename, int frames, float seconds)
 {
-	LogDebug(VB_SYNC, "SendSeqSyncPacket( '%s', %d, %.2f)\n",
+	LogExcess(VB_SYNC, "SendSeqSyncPacket( '%s', %d, %.2f)\n",
 		filename, frames, seconds);
 
 	if (!filename || !filename[0])
@@ -660,34 +739,167 @@ void MultiSync::SendSeqSyncPacket(const char *filename, int frames, float second
 		return;
 	}
 
-	char           outBuf[2048];
-	bzero(outBuf, sizeof(outBuf));
+	// stamp when this frame started so remotes can line up to the
+	// microsecond instead of the frame
+	long long sendTime = GetMonotonicTime();
 
-	ControlPkt    *cpkt = (ControlPkt*)outBuf;
-	SyncPkt *spkt = (SyncPkt*)(outBuf + sizeof(ControlPkt));
+	if (!m_syncThreadRunning) {
+		BuildSeqSyncTemplates(filename);
+		SendSeqSyncTemplates(frames, seconds, sendTime);
+		return;
+	}
+
+	// Called from the output thread, hand the frame off rather than
+	// sending to every remote here.  If the previous sync hasn't gone
+	// out yet it is replaced, only the newest position matters.
+	pthread_mutex_lock(&m_syncLock);
+	if (m_syncFilename != filename)
+		m_syncFilename = filename;
+	m_syncFrame   = frames;
+	m_syncSeconds = seconds;
+	m_syncTime    = sendTime;
+	m_syncPending = true;
+	pthread_cond_broadcast(&m_syncCond);
+	pthread_mutex_unlock(&m_syncLock);
+}
+
+/*
+ * Drop any queued sequence sync and wait for one being sent so it can't
+ * arrive at the remotes after a start/stop for another sequence
+ */
+void MultiSync::CancelPendingSeqSync(void)
+{
+	if (!m_syncThreadRunning)
+		return;
+
+	pthread_mutex_lock(&m_syncLock);
+	m_syncPending = false;
+	while (m_syncSending)
+		pthread_cond_wait(&m_syncCond, &m_syncLock);
+	pthread_mutex_unlock(&m_syncLock);
+}
+
+/*
+ * Build the binary and CSV sequence sync packets for a file, the per
+ * frame fields are patched in by SendSeqSyncTemplates()
+ */
+void MultiSync::BuildSeqSyncTemplates(const std::string &filename)
+{
+	if ((filename == m_syncTemplateFile) && !m_syncTemplate.empty())
+		return;
+
+	m_syncTemplateFile = filename;
+
+	int extraDataLen = sizeof(SyncPkt) + filename.size() + sizeof(SyncTimePkt);
+	m_syncTemplate.assign(sizeof(ControlPkt) + extraDataLen, 0);
+
+	ControlPkt *cpkt = (ControlPkt*)&m_syncTemplate[0];
+	SyncPkt    *spkt = (SyncPkt*)(&m_syncTemplate[0] + sizeof(ControlPkt));
 
 	InitControlPacket(cpkt);
+	cpkt->pktType      = CTRL_PKT_SYNC;
+	cpkt->extraDataLen = extraDataLen;
 
-	cpkt->pktType        = CTRL_PKT_SYNC;
-	cpkt->extraDataLen   = sizeof(SyncPkt) + strlen(filename);
-	
 	spkt->pktType  = SYNC_PKT_SYNC;
 	spkt->fileType = SYNC_FILE_SEQ;
-	spkt->frameNumber = frames;
+	strcpy(spkt->filename, filename.c_str());
+
+	SyncTimePkt *tpkt = (SyncTimePkt*)(spkt->filename + filename.size() + 1);
+	tpkt->version = SYNC_TIME_VERSION;
+
+	char prefix[2048];
+	snprintf(prefix, sizeof(prefix), "FPP,%d,%d,%d,%s,",
+		CTRL_PKT_SYNC, SYNC_FILE_SEQ, SYNC_PKT_SYNC, filename.c_str());
+	m_syncCSVPrefix = prefix;
+}
+
+/*
+ * Patch the frame position into the prebuilt sync packets and send them
+ * to all remotes
+ */
+void MultiSync::SendSeqSyncTemplates(int frames, float seconds, long long sendTime)
+{
+	SyncPkt *spkt = (SyncPkt*)(&m_syncTemplate[0] + sizeof(ControlPkt));
+	SyncTimePkt *tpkt = (SyncTimePkt*)(spkt->filename + m_syncTemplateFile.size() + 1);
+
+	spkt->frameNumber    = frames;
 	spkt->secondsElapsed = seconds;
-	strcpy(spkt->filename, filename);
+	tpkt->frameTime      = GetChannelOutputFrameTime();
+	tpkt->sendTime       = sendTime;
 
-	SendControlPacket(outBuf, sizeof(ControlPkt) + sizeof(SyncPkt) + strlen(filename));
+	SendControlPacket(&m_syncTemplate[0], m_syncTemplate.size());
 
     if (m_destAddrCSV.size() > 0) {
 		// Now send the Broadcast CSV version
-		sprintf(outBuf, "FPP,%d,%d,%d,%s,%d,%d\n",
-			CTRL_PKT_SYNC, SYNC_FILE_SEQ, SYNC_PKT_SYNC, filename,
+		char outBuf[2048];
+		int len = m_syncCSVPrefix.size();
+		if (len > (sizeof(outBuf) - 32))
+			return;
+
+		memcpy(outBuf, m_syncCSVPrefix.c_str(), len);
+		len += snprintf(outBuf + len, sizeof(outBuf) - len, "%d,%d\n",
 			(int)seconds, (int)(seconds * 1000) % 1000);
-		SendCSVControlPacket(outBuf, strlen(outBuf));
+		SendCSVControlPacket(outBuf, len);
 	}
 }
 
+/*
+ * Sequence sync sender
+ */
+void MultiSync::StartSyncSendThread(void)
+{
+	m_syncThreadRunning = true;
+	if (pthread_create(&m_syncThread, NULL, &MultiSync::RunSyncSendThread, this)) {
+		LogErr(VB_SYNC, "Unable to start sync send thread, sending sync from the output thread\n");
+		m_syncThreadRunning = false;
+	}
+}
+
+void MultiSync::StopSyncSendThread(void)
+{
+	if (!m_syncThreadRunning)
+		return;
+
+	pthread_mutex_lock(&m_syncLock);
+	m_syncThreadRunning = false;
+	pthread_cond_broadcast(&m_syncCond);
+	pthread_mutex_unlock(&m_syncLock);
+
+	pthread_join(m_syncThread, NULL);
+}
+
+void *MultiSync::RunSyncSendThread(void *data)
+{
+	MultiSync *ms = (MultiSync*)data;
+
+	pthread_mutex_lock(&ms->m_syncLock);
+	while (true) {
+		while (ms->m_syncThreadRunning && !ms->m_syncPending)
+			pthread_cond_wait(&ms->m_syncCond, &ms->m_syncLock);
+
+		if (!ms->m_syncThreadRunning)
+			break;
+
+		ms->m_syncPending = false;
+		if (ms->m_syncFilename != ms->m_syncTemplateFile)
+			ms->BuildSeqSyncTemplates(ms->m_syncFilename);
+		int frames = ms->m_syncFrame;
+		float seconds = ms->m_syncSeconds;
+		long long sendTime = ms->m_syncTime;
+		ms->m_syncSending = true;
+		pthread_mutex_unlock(&ms->m_syncLock);
+
+		ms->SendSeqSyncTemplates(frames, seconds, sendTime);
+
+		pthread_mutex_lock(&ms->m_syncLock);
+		ms->m_syncSending = false;
+		pthread_cond_broadcast(&ms->m_syncCond);
+	}
+	pthread_mutex_unlock(&ms->m_syncLock);
+
+	return NULL;
+}
+
 /*
  *
  */
@@ -902,6 +1114,8 @@ void MultiSync::ShutdownSync(void)
 {
 	LogDebug(VB_SYNC, "ShutdownSync()\n");
 
+	StopSyncSendThread();
+
 	pthread_mutex_lock(&m_socketLock);
 
 	if (m_broadcastSock >= 0) {
@@ -1079,19 +1293,19 @@ void MultiSync::SendControlPacket(void *outBuf, int len)
 		HexDump("Sending Control packet with contents:", outBuf, len);
 	}
 
-    m_destIovec.iov_base = outBuf;
-    m_destIovec.iov_len = len;
-
     int msgCount = m_destMsgs.size();
     if (msgCount == 0) {
         return;
     }
     
+    // all destinations share the one iovec, see OpenControlSockets()
     pthread_mutex_lock(&m_socketLock);
+    m_destIovec.iov_base = outBuf;
+    m_destIovec.iov_len = len;
     int oc = sendmmsg(m_controlSock, &m_destMsgs[0], msgCount, 0);
     int outputCount = oc;
     while (oc > 0 && outputCount != msgCount) {
-        int oc = sendmmsg(m_controlSock, &m_destMsgs[outputCount], msgCount - outputCount, 0);
+        oc = sendmmsg(m_controlSock, &m_destMsgs[outputCount], msgCount - outputCount, 0);
         if (oc >= 0) {
             outputCount += oc;
         }
@@ -1183,19 +1397,19 @@ void MultiSync::SendCSVControlPacket(void *outBuf, int len)
 	}
 
 
-    m_destIovecCSV.iov_base = outBuf;
-    m_destIovecCSV.iov_len = len;
     int msgCount = m_destMsgsCSV.size();
     if (msgCount == 0) {
         return;
     }
     
     pthread_mutex_lock(&m_socketLock);
+    m_destIovecCSV.iov_base = outBuf;
+    m_destIovecCSV.iov_len = len;
 
     int oc = sendmmsg(m_controlCSVSock, &m_destMsgsCSV[0], msgCount, 0);
     int outputCount = oc;
     while (oc > 0 && outputCount != msgCount) {
-        int oc = sendmmsg(m_controlCSVSock, &m_destMsgsCSV[outputCount], msgCount - outputCount, 0);
+        oc = sendmmsg(m_controlCSVSock, &m_destMsgsCSV[outputCount], msgCount - outputCount, 0);
         if (oc >= 0) {
             outputCount += oc;
         }
@@ -1262,6 +1476,12 @@ int MultiSync::OpenReceiveSocket(void)
 		return 0;
 	}
 
+	// kernel receive timestamps keep main loop latency out of the clock
+	// offset measurements
+	if (setsockopt(m_receiveSock, SOL_SOCKET, SO_TIMESTAMPNS, &optval, sizeof(optval)) < 0) {
+		LogWarn(VB_SYNC, "Could not enable receive timestamps; %s\n", strerror(errno));
+	}
+
     struct ip_mreq mreq;
     struct ifaddrs *interfaces,*tmp;
     getifaddrs(&interfaces);
@@ -1322,6 +1542,12 @@ void MultiSync::ProcessControlPacket(void)
 	LogExcess(VB_SYNC, "ProcessControlPacket()\n");
 
 	ControlPkt *pkt;
+
+    // recvmmsg() updates these with the actual sizes, put them back
+    for (int i = 0; i < MAX_MS_RCV_MSG; i++) {
+        rcvMsgs[i].msg_hdr.msg_namelen    = sizeof(struct sockaddr_storage);
+        rcvMsgs[i].msg_hdr.msg_controllen = 0x100;
+    }
     
     int msgcnt = recvmmsg(m_receiveSock, rcvMsgs, MAX_MS_RCV_MSG, MSG_DONTWAIT, nullptr);
     LogExcess(VB_SYNC, "ProcessControlPacket msgcnt: %d\n", msgcnt);
@@ -1384,7 +1610,7 @@ void MultiSync::ProcessControlPacket(void)
             case CTRL_PKT_CMD:	ProcessCommandPacket(pkt, len);
                                 break;
             case CTRL_PKT_SYNC: if (getFPPmode() == REMOTE_MODE)
-                                    ProcessSyncPacket(pkt, len);
+                                    ProcessSyncPacket(pkt, len, (struct sockaddr_in *)&rcvSrcAddr[msg]);
                                 break;
             case CTRL_PKT_EVENT:
                                 if (getFPPmode() == REMOTE_MODE)
@@ -1397,10 +1623,24 @@ void MultiSync::ProcessControlPacket(void)
             case CTRL_PKT_PING:
                                 ProcessPingPacket(pkt, len);
                                 break;
+            case CTRL_PKT_TIME:
+                                ProcessTimePacket(pkt, len, (struct sockaddr_in *)&rcvSrcAddr[msg],
+                                                  GetReceiveTime(&rcvMsgs[msg].msg_hdr));
+                                break;
         }
     }
 }
 
+/*
+ *
+ */
+void MultiSync::PrepareSyncedSequence(char *filename)
+{
+	LogDebug(VB_SYNC, "PrepareSyncedSequence(%s)\n", filename);
+
+	sequence->PrepareSequenceFile(filename);
+}
+
 /*
  *
  */
@@ -1425,16 +1665,20 @@ void MultiSync::StopSyncedSequence(char *filename)
 /*
  *
  */
-void MultiSync::SyncSyncedSequence(char *filename, int frameNumber, float secondsElapsed)
+void MultiSync::SyncSyncedSequence(char *filename, int frameNumber, float secondsElapsed,
+	long long frameTime)
 {
-	LogExcess(VB_SYNC, "SyncSyncedSequence('%s', %d, %.2f)\n",
-		filename, frameNumber, secondsElapsed);
+	LogExcess(VB_SYNC, "SyncSyncedSequence('%s', %d, %.2f, %lld)\n",
+		filename, frameNumber, secondsElapsed, frameTime);
 
 	if (!sequence->IsSequenceRunning(filename)) {
         sequence->OpenSequenceFile(filename, frameNumber);
 	}
     if (sequence->IsSequenceRunning(filename)) {
-		UpdateMasterPosition(frameNumber);
+		if (frameTime)
+			UpdateMasterPositionAtTime(frameNumber, frameTime);
+		else
+			UpdateMasterPosition(frameNumber);
     }
 }
 
@@ -1515,7 +1759,7 @@ void MultiSync::SyncSyncedMedia(char *filename, int frameNumber, float secondsEl
 /*
  *
  */
-void MultiSync::ProcessSyncPacket(ControlPkt *pkt, int len)
+void MultiSync::ProcessSyncPacket(ControlPkt *pkt, int len, struct sockaddr_in *src)
 {
 	if (pkt->extraDataLen < sizeof(SyncPkt)) {
 		LogErr(VB_SYNC, "Error: Invalid length of received sync packet\n");
@@ -1536,12 +1780,15 @@ void MultiSync::ProcessSyncPacket(ControlPkt *pkt, int len)
 								 break;
 			case SYNC_PKT_STOP:  StopSyncedSequence(spkt->filename);
 								 break;
+			case SYNC_PKT_OPEN:  PrepareSyncedSequence(spkt->filename);
+								 break;
 			case SYNC_PKT_SYNC:  secondsElapsed = spkt->secondsElapsed - m_remoteOffset;
 								 if (secondsElapsed < 0)
 									secondsElapsed = 0.0;
 
 								 SyncSyncedSequence(spkt->filename,
-									spkt->frameNumber, secondsElapsed);
+									spkt->frameNumber, secondsElapsed,
+									GetLocalFrameTime(pkt, spkt, src));
 								 break;
 		}
 	} else if (spkt->fileType == SYNC_FILE_MEDIA) {
@@ -1561,6 +1808,254 @@ void MultiSync::ProcessSyncPacket(ControlPkt *pkt, int len)
 	}
 }
 
+/*
+ * Work out when the master started the synced frame in our own clock.
+ * Returns 0 if the master didn't send a timestamp or we don't know its
+ * clock yet, the caller then falls back to frame counting.
+ */
+long long MultiSync::GetLocalFrameTime(ControlPkt *pkt, SyncPkt *spkt, struct sockaddr_in *src)
+{
+	int nameLen = strnlen(spkt->filename, pkt->extraDataLen - offsetof(SyncPkt, filename));
+	int timeOffset = offsetof(SyncPkt, filename) + nameLen + 1;
+
+	if ((timeOffset + sizeof(SyncTimePkt)) > pkt->extraDataLen)
+		return 0;
+
+	SyncTimePkt *tpkt = (SyncTimePkt*)(((char*)spkt) + timeOffset);
+	if (tpkt->version != SYNC_TIME_VERSION)
+		return 0;
+
+	long long now = GetMonotonicTime();
+	long long interval = (m_clockSamples.size() < CLOCK_FILTER_COUNT)
+		? CLOCK_FAST_INTERVAL : CLOCK_REQUEST_INTERVAL;
+	if ((now - m_lastTimeRequest) >= interval)
+		SendTimeRequest(src);
+
+	if (tpkt->frameTime != GetChannelOutputFrameTime()) {
+		LogDebug(VB_SYNC, "Master frame time %dus doesn't match ours (%dus), syncing by frame\n",
+			tpkt->frameTime, GetChannelOutputFrameTime());
+		return 0;
+	}
+
+	long long offset;
+	double drift;
+	if (!GetMasterClockOffset(now, offset, drift))
+		return 0;
+
+	return (long long)tpkt->sendTime - offset;
+}
+
+/*
+ * Ask the master for its clock.  The reply comes back to our control port.
+ */
+void MultiSync::SendTimeRequest(struct sockaddr_in *master)
+{
+	char outBuf[sizeof(ControlPkt) + sizeof(TimePkt)];
+	bzero(outBuf, sizeof(outBuf));
+
+	ControlPkt *cpkt = (ControlPkt*)outBuf;
+	TimePkt    *tpkt = (TimePkt*)(outBuf + sizeof(ControlPkt));
+
+	InitControlPacket(cpkt);
+	cpkt->pktType      = CTRL_PKT_TIME;
+	cpkt->extraDataLen = sizeof(TimePkt);
+
+	struct sockaddr_in dest_addr;
+	memset(&dest_addr, 0, sizeof(dest_addr));
+	dest_addr.sin_family = AF_INET;
+	dest_addr.sin_addr   = master->sin_addr;
+	dest_addr.sin_port   = htons(FPP_CTRL_PORT);
+
+	tpkt->pktType = TIME_PKT_REQUEST;
+
+	pthread_mutex_lock(&m_socketLock);
+	m_lastTimeRequest = GetMonotonicTime();
+	tpkt->originTime = m_lastTimeRequest;
+	if (sendto(m_receiveSock, outBuf, sizeof(outBuf), MSG_DONTWAIT,
+			(struct sockaddr*)&dest_addr, sizeof(dest_addr)) < 0) {
+		LogDebug(VB_SYNC, "Unable to send time request: %s\n", strerror(errno));
+	}
+	pthread_mutex_unlock(&m_socketLock);
+
+	m_timeRequests++;
+}
+
+/*
+ * Answer a remote's time request, or take a sample from the master's reply
+ */
+void MultiSync::ProcessTimePacket(ControlPkt *pkt, int len, struct sockaddr_in *src, long long rxTime)
+{
+	if (pkt->extraDataLen < sizeof(TimePkt)) {
+		LogErr(VB_SYNC, "Error: Invalid length of received time packet\n");
+		HexDump("Received data:", (void*)pkt, len);
+		return;
+	}
+
+	TimePkt *tpkt = (TimePkt*)(((char*)pkt) + sizeof(ControlPkt));
+
+	if ((tpkt->pktType == TIME_PKT_REQUEST) && (getFPPmode() == MASTER_MODE)) {
+		char outBuf[sizeof(ControlPkt) + sizeof(TimePkt)];
+		memcpy(outBuf, pkt, sizeof(outBuf));
+
+		TimePkt *reply = (TimePkt*)(outBuf + sizeof(ControlPkt));
+		reply->pktType = TIME_PKT_REPLY;
+		reply->receiveTime = rxTime;
+
+		struct sockaddr_in dest_addr;
+		memset(&dest_addr, 0, sizeof(dest_addr));
+		dest_addr.sin_family = AF_INET;
+		dest_addr.sin_addr   = src->sin_addr;
+		dest_addr.sin_port   = htons(FPP_CTRL_PORT);
+
+		pthread_mutex_lock(&m_socketLock);
+		reply->transmitTime = GetMonotonicTime();
+		sendto(m_receiveSock, outBuf, sizeof(outBuf), MSG_DONTWAIT,
+			(struct sockaddr*)&dest_addr, sizeof(dest_addr));
+		pthread_mutex_unlock(&m_socketLock);
+	} else if ((tpkt->pktType == TIME_PKT_REPLY) && (getFPPmode() == REMOTE_MODE)) {
+		long long t1 = tpkt->originTime;
+		long long t2 = tpkt->receiveTime;
+		long long t3 = tpkt->transmitTime;
+		long long t4 = rxTime;
+
+		MultiSyncClockSample sample;
+		sample.localTime = t4;
+		sample.offset    = ((t2 - t1) + (t3 - t4)) / 2;
+		sample.delay     = (t4 - t1) - (t3 - t2);
+
+		if ((t1 > t4) || (sample.delay < 0) || (sample.delay > CLOCK_MAX_DELAY)) {
+			LogDebug(VB_SYNC, "Ignoring time reply with delay %lldus\n", sample.delay);
+			return;
+		}
+
+		pthread_mutex_lock(&m_clockLock);
+		m_timeReplies++;
+		if (m_clockSamples.size() < CLOCK_SAMPLE_COUNT) {
+			m_clockSamples.push_back(sample);
+		} else {
+			m_clockSamples[m_clockSampleIdx] = sample;
+		}
+		m_clockSampleIdx = (m_clockSampleIdx + 1) % CLOCK_SAMPLE_COUNT;
+		UpdateClockEstimate();
+		pthread_mutex_unlock(&m_clockLock);
+	}
+}
+
+/*
+ * Pick the offset from the recent sample with the lowest round trip, it
+ * has the least queuing error.  Drift is the slope of the offset over
+ * the good samples.  Called with m_clockLock held.
+ */
+void MultiSync::UpdateClockEstimate(void)
+{
+	int count = m_clockSamples.size();
+	if (count < CLOCK_MIN_SAMPLES)
+		return;
+
+	// newest CLOCK_FILTER_COUNT samples, m_clockSampleIdx is the oldest once full
+	int best = -1;
+	for (int i = 0; i < std::min(count, CLOCK_FILTER_COUNT); i++) {
+		int idx = (m_clockSampleIdx - 1 - i + CLOCK_SAMPLE_COUNT) % CLOCK_SAMPLE_COUNT;
+		if (idx >= count)
+			continue;
+		if ((best < 0) || (m_clockSamples[idx].delay < m_clockSamples[best].delay))
+			best = idx;
+	}
+
+	long long minDelay = m_clockSamples[best].delay;
+	for (auto &s : m_clockSamples)
+		minDelay = std::min(minDelay, s.delay);
+
+	double sumX = 0.0, sumY = 0.0, sumXX = 0.0, sumXY = 0.0;
+	long long firstTime = m_clockSamples[best].localTime;
+	long long minTime = firstTime, maxTime = firstTime;
+	int n = 0;
+	for (auto &s : m_clockSamples) {
+		if (s.delay > ((minDelay * 2) + 1000))
+			continue;
+		double x = s.localTime - firstTime;
+		double y = s.offset - m_clockSamples[best].offset;
+		sumX += x;
+		sumY += y;
+		sumXX += x * x;
+		sumXY += x * y;
+		minTime = std::min(minTime, s.localTime);
+		maxTime = std::max(maxTime, s.localTime);
+		n++;
+	}
+
+	if ((n >= CLOCK_MIN_SAMPLES) && ((maxTime - minTime) >= CLOCK_MIN_DRIFT_SPAN)) {
+		double d = (n * sumXX) - (sumX * sumX);
+		if (d > 0.0) {
+			double drift = (((n * sumXY) - (sumX * sumY)) / d) * 1000000.0;
+			m_clockDrift = std::max(-CLOCK_MAX_DRIFT_PPM, std::min(CLOCK_MAX_DRIFT_PPM, drift));
+		}
+	}
+
+	if (!m_clockValid)
+		LogDebug(VB_SYNC, "Master clock offset %lldus, round trip %lldus\n",
+			m_clockSamples[best].offset, m_clockSamples[best].delay);
+
+	m_clockOffset = m_clockSamples[best].offset;
+	m_clockOffsetTime = m_clockSamples[best].localTime;
+	m_clockDelay = m_clockSamples[best].delay;
+	m_clockValid = true;
+}
+
+/*
+ * Master clock minus our clock at localTime
+ */
+bool MultiSync::GetMasterClockOffset(long long localTime, long long &offset, double &driftPPM)
+{
+	pthread_mutex_lock(&m_clockLock);
+	bool valid = m_clockValid;
+	if (valid) {
+		offset = m_clockOffset + (long long)(m_clockDrift * (localTime - m_clockOffsetTime) / 1000000.0);
+		driftPPM = m_clockDrift;
+	}
+	pthread_mutex_unlock(&m_clockLock);
+
+	return valid;
+}
+
+void MultiSync::GetClockStats(Json::Value &result)
+{
+	pthread_mutex_lock(&m_clockLock);
+	result["valid"] = m_clockValid;
+	result["offsetUS"] = (Json::Int64)m_clockOffset;
+	result["roundTripUS"] = (Json::Int64)m_clockDelay;
+	result["driftPPM"] = m_clockDrift;
+	result["samples"] = (int)m_clockSamples.size();
+	result["requests"] = (Json::UInt64)m_timeRequests;
+	result["replies"] = (Json::UInt64)m_timeReplies;
+	pthread_mutex_unlock(&m_clockLock);
+}
+
+/*
+ * Monotonic time a packet arrived, from the kernel timestamp if we have one
+ */
+long long MultiSync::GetReceiveTime(struct msghdr *msg)
+{
+	long long now = GetMonotonicTime();
+
+	for (struct cmsghdr *cmsg = CMSG_FIRSTHDR(msg); cmsg != NULL; cmsg = CMSG_NXTHDR(msg, cmsg)) {
+		if ((cmsg->cmsg_level == SOL_SOCKET) && (cmsg->cmsg_type == SCM_TIMESTAMPNS)) {
+			struct timespec rx;
+			struct timespec realNow;
+			memcpy(&rx, CMSG_DATA(cmsg), sizeof(rx));
+			clock_gettime(CLOCK_REALTIME, &realNow);
+
+			long long age = (realNow.tv_sec - rx.tv_sec) * 1000000LL
+				+ (realNow.tv_nsec - rx.tv_nsec) / 1000;
+			if ((age >= 0) && (age < 1000000))
+				return now - age;
+			break;
+		}
+	}
+
+	return now;
+}
+
 /*
  *
  */
@@ -44,6 +44,7 @@
 #define CTRL_PKT_EVENT  2
 #define CTRL_PKT_BLANK  3
 #define CTRL_PKT_PING   4
+#define CTRL_PKT_TIME   5
 
 typedef struct __attribute__((packed)) {
 	char     fppd[4];        // 'FPPD'
@@ -62,6 +63,7 @@ typedef struct {
 #define SYNC_PKT_START 0
 #define SYNC_PKT_STOP  1
 #define SYNC_PKT_SYNC  2
+#define SYNC_PKT_OPEN  3 // sequence will be started next, remotes open it early
 
 #define SYNC_FILE_SEQ   0
 #define SYNC_FILE_MEDIA 1
@@ -75,6 +77,34 @@ typedef struct __attribute__((packed)) {
 	                         // (data may continue past this header)
 } SyncPkt;
 
+// Sequence sync packets from newer masters carry this after the filename's
+// NULL.  Older remotes only look at the filename so they ignore it.
+#define SYNC_TIME_VERSION 1
+
+typedef struct __attribute__((packed)) {
+	uint8_t  version;        // SYNC_TIME_VERSION
+	uint64_t sendTime;       // Master monotonic time (us) frameNumber started
+	uint32_t frameTime;      // Master frame time in us
+} SyncTimePkt;
+
+#define TIME_PKT_REQUEST 0
+#define TIME_PKT_REPLY   1
+
+// Round trip clock offset measurement between a remote and its master,
+// all times are monotonic microseconds of the system that stamped them
+typedef struct __attribute__((packed)) {
+	uint8_t  pktType;        // Time Packet Type
+	uint64_t originTime;     // Remote time the request was sent
+	uint64_t receiveTime;    // Master time the request was received
+	uint64_t transmitTime;   // Master time the reply was sent
+} TimePkt;
+
+typedef struct {
+	long long localTime;     // Remote time the reply was received
+	long long offset;        // Master clock minus remote clock
+	long long delay;         // Round trip network delay
+} MultiSyncClockSample;
+
 
 typedef enum systemType {
 	kSysTypeUnknown                      = 0x00,
@@ -150,6 +180,7 @@ class MultiSync {
 
 	void SendSeqSyncStartPacket(const char *filename);
 	void SendSeqSyncStopPacket(const char *filename);
+	void SendSeqOpenPacket(const char *filename);
 	void SendSeqSyncPacket(const char *filename, int frames, float seconds);
 	void ShutdownSync(void);
 
@@ -160,6 +191,9 @@ class MultiSync {
 	void SendEventPacket(const char *eventID);
 	void SendBlankingDataPacket(void);
 
+	bool GetMasterClockOffset(long long localTime, long long &offset, double &driftPPM);
+	void GetClockStats(Json::Value &result);
+
   private:
     void PingSingleRemote(int sysIdx);
     int CreatePingPacket(MultiSyncSystem &sys, char* outBuf, int discover);
@@ -180,18 +214,31 @@ class MultiSync {
 
 	void InitControlPacket(ControlPkt *pkt);
 
+	void StartSyncSendThread(void);
+	void StopSyncSendThread(void);
+	void CancelPendingSeqSync(void);
+	static void *RunSyncSendThread(void *data);
+	void BuildSeqSyncTemplates(const std::string &filename);
+	void SendSeqSyncTemplates(int frames, float seconds, long long sendTime);
+
 	int  OpenReceiveSocket(void);
 
+	void PrepareSyncedSequence(char *filename);
 	void StartSyncedSequence(char *filename);
 	void StopSyncedSequence(char *filename);
 	void SyncSyncedSequence(char *filename, int frameNumber,
-		float secondsElapsed);
+		float secondsElapsed, long long frameTime);
 
 	void StartSyncedMedia(char *filename);
 	void StopSyncedMedia(char *filename);
 	void SyncSyncedMedia(char *filename, int frameNumber, float secondsElapsed);
 
-	void ProcessSyncPacket(ControlPkt *pkt, int len);
+	void ProcessSyncPacket(ControlPkt *pkt, int len, struct sockaddr_in *src);
+	void ProcessTimePacket(ControlPkt *pkt, int len, struct sockaddr_in *src, long long rxTime);
+	void SendTimeRequest(struct sockaddr_in *master);
+	long long GetLocalFrameTime(ControlPkt *pkt, SyncPkt *spkt, struct sockaddr_in *src);
+	void UpdateClockEstimate(void);
+	long long GetReceiveTime(struct msghdr *msg);
 	void ProcessCommandPacket(ControlPkt *pkt, int len);
 	void ProcessEventPacket(ControlPkt *pkt, int len);
 	void ProcessPingPacket(ControlPkt *pkt, int len);
@@ -220,6 +267,36 @@ class MultiSync {
     
 	float  m_remoteOffset;
 
+	// remote side estimate of the master's clock
+	pthread_mutex_t     m_clockLock;
+	std::vector<MultiSyncClockSample> m_clockSamples;
+	int                 m_clockSampleIdx;
+	bool                m_clockValid;
+	long long           m_clockOffset;
+	long long           m_clockOffsetTime;
+	long long           m_clockDelay;
+	double              m_clockDrift;
+	long long           m_lastTimeRequest;
+	unsigned long       m_timeRequests;
+	unsigned long       m_timeReplies;
+
+	// master side sequence sync, the output thread hands the frame over
+	// and this thread patches the prebuilt packets and sends them
+	pthread_t           m_syncThread;
+	bool                m_syncThreadRunning;
+	pthread_mutex_t     m_syncLock;
+	pthread_cond_t      m_syncCond;
+	bool                m_syncPending;
+	bool                m_syncSending;
+	std::string         m_syncFilename;
+	int                 m_syncFrame;
+	float               m_syncSeconds;
+	long long           m_syncTime;
+
+	std::string         m_syncTemplateFile;
+	std::vector<char>   m_syncTemplate;
+	std::string         m_syncCSVPrefix;
+
     struct iovec m_destIovec;
     std::vector<struct mmsghdr> m_destMsgs;
 	std::vector<struct sockaddr_in> m_destAddr;
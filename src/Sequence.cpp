@@ -37,6 +37,8 @@
 #include <unistd.h>
 #include <inttypes.h>
 
+#include <algorithm>
+
 #include "E131.h"
 #include "channeloutputthread.h"
 #include "common.h"
@@ -75,6 +77,17 @@ Sequence::Sequence()
     m_seqLastControlMinor(0),
     m_remoteBlankCount(0),
     m_readThread(nullptr),
+    m_prepareGeneration(0),
+    m_prepareThreads(0),
+    m_preparedFile(nullptr),
+    m_preparedFrameSize(0),
+    m_preparedFrameCount(0),
+    m_frameBufferSize(0),
+    m_frameBufferCount(0),
+    m_frameBufferStart(0),
+    m_frameBufferHead(0),
+    m_frameBufferTail(0),
+    m_lastFramePlayed(-1),
     m_lastFrameRead(-1),
     m_doneRead(false),
     m_shuttingDown(false),
@@ -94,20 +107,50 @@ Sequence::~Sequence()
         m_readThread->join();
         delete m_readThread;
     }
+    {
+        std::unique_lock<std::mutex> lock(m_preparedLock);
+        m_prepareGeneration++;
+        m_prepareDone.wait(lock, [this] { return m_prepareThreads == 0; });
+    }
+    DiscardPreparedFile();
     clearCaches();
     if (m_seqFile) {
         delete m_seqFile;
     }
 }
+//must be called with m_sequenceLock and readFileLock held
 void Sequence::clearCaches() {
-    while (!frameCache.empty()) {
-        delete frameCache.front();
-        frameCache.pop_front();
+    m_frameBufferStart = m_frameBufferHead;
+    m_frameBufferTail = m_frameBufferStart;
+}
+
+//must be called with m_sequenceLock and readFileLock held.  The buffers are
+//only reallocated if a larger sequence needs more space than is there.
+void Sequence::setupFrameBuffers(uint32_t frameSize) {
+    if (frameSize < 1) {
+        frameSize = 1;
     }
-    while (!pastFrameCache.empty()) {
-        delete pastFrameCache.front();
-        pastFrameCache.pop_front();
+    int count = getSettingInt("sequenceCacheFrames");
+    if (count <= 0) {
+        count = SEQUENCE_CACHE_MAX_SIZE / frameSize;
+        if (count < SEQUENCE_CACHE_MIN_FRAMECOUNT) {
+            count = SEQUENCE_CACHE_MIN_FRAMECOUNT;
+        } else if (count > SEQUENCE_CACHE_FRAMECOUNT) {
+            count = SEQUENCE_CACHE_FRAMECOUNT;
+        }
     }
+    count += SEQUENCE_PAST_FRAMECOUNT;
+
+    //keep each frame aligned for the memcpy's
+    m_frameBufferSize = (frameSize + 63) & ~63;
+    m_frameBufferCount = count;
+    m_frameBuffers.resize((size_t)m_frameBufferSize * m_frameBufferCount);
+    m_frameBufferFrames.resize(m_frameBufferCount);
+    m_frameBufferStart = 0;
+    m_frameBufferHead = 0;
+    m_frameBufferTail = 0;
+
+    LogDebug(VB_SEQUENCE, "Using %d frame buffers of %d bytes\n", m_frameBufferCount, m_frameBufferSize);
 }
 
 
@@ -124,47 +167,195 @@ void Sequence::ReadFramesLoop() {
         if (m_shuttingDown) {
             return;
         }
-        int cacheSize = frameCache.size();
-        if (frameCache.size() < SEQUENCE_CACHE_FRAMECOUNT && m_seqStarting < 2 && m_seqFile && !m_doneRead) {
-            uint64_t frame = m_lastFrameRead + 1;
-            if (frame < m_seqFile->getNumFrames()) {
-                lock.unlock();
-                
-                std::unique_lock<std::mutex> readlock(readFileLock);
-                FSEQFile *file = m_seqFile;
-                FSEQFile::FrameData *fd = nullptr;
-                if (m_doneRead || file == nullptr) {
-                    //memset(fd->data, 0, maxChanToRead);
-                } else {
-                    fd = m_seqFile->getFrame(frame);
-                }
-                readlock.unlock();
-                
-                lock.lock();
-                if (fd) {
-                    if (m_lastFrameRead == (frame - 1)) {
-                        m_lastFrameRead = frame;
-                        frameCache.push_back(fd);
-
-                        lock.unlock();
-                        frameLoadedSignal.notify_all();
-                        std::this_thread::sleep_for(5ms);
-                        lock.lock();
-                    } else {
-                        //a skip is in progress, we don't need this frame anymore
-                        delete fd;
+        bool loaded = false;
+        bool cacheFull = true;
+        if (m_seqStarting < 2 && m_seqFile && !m_doneRead) {
+            lock.unlock();
+
+            std::unique_lock<std::mutex> readlock(readFileLock);
+            //the cache may have been cleared or the file closed while waiting for the lock
+            FSEQFile *file = m_seqFile;
+            uint32_t head = m_frameBufferHead;
+            if (!m_doneRead && file && m_frameBufferCount
+                && (head - m_frameBufferTail) < (m_frameBufferCount - SEQUENCE_PAST_FRAMECOUNT)) {
+                cacheFull = false;
+                int frame = m_lastFrameRead + 1;
+                if (frame < file->getNumFrames()) {
+                    uint8_t *buffer = getFrameBuffer(head);
+                    if (!file->readFrameData(frame, buffer)) {
+                        memset(buffer, 0, m_frameBufferSize);
                     }
+                    int expected = frame - 1;
+                    if (m_lastFrameRead.compare_exchange_strong(expected, frame)) {
+                        m_frameBufferFrames[head % m_frameBufferCount] = frame;
+                        m_frameBufferHead = head + 1;
+                        loaded = true;
+                    }
+                    //otherwise a skip is in progress, we don't need this frame anymore
+                } else {
+                    m_doneRead = true;
+                    loaded = true;
                 }
-            } else {
-                frameLoadedSignal.notify_all();
-                m_doneRead = true;
             }
-        } else {
+            readlock.unlock();
+
+            //the lock makes sure the output thread is either waiting for the
+            //signal or will see the new frame
+            lock.lock();
+        }
+        if (loaded) {
+            lock.unlock();
+            frameLoadedSignal.notify_all();
+            std::this_thread::sleep_for(5ms);
+            lock.lock();
+        } else if (cacheFull) {
             frameLoadSignal.wait_for(lock, 25ms);
         }
     }
 }
 
+/*
+ * Open a sequence in the background and decode its first frames so a
+ * following OpenSequenceFile() for the same file can start immediately.
+ * Used on remotes when the master announces the next playlist entry.
+ */
+void Sequence::PrepareSequenceFile(const char *filename) {
+    if (!filename || !filename[0]) {
+        return;
+    }
+
+    std::unique_lock<std::mutex> lock(m_preparedLock);
+    if ((m_preparingFilename == filename) || (m_preparedFilename == filename)) {
+        return;
+    }
+
+    // cancel anything still being read for another file, it will notice
+    // before its next frame and clean up after itself
+    m_prepareGeneration++;
+    m_preparingFilename = "";
+    if (m_preparedFile) {
+        delete m_preparedFile;
+        m_preparedFile = nullptr;
+    }
+    m_preparedFilename = "";
+    m_preparedFrames.clear();
+    m_preparedFrameCount = 0;
+
+    std::string path = getSequenceDirectory();
+    path += "/";
+    path += filename;
+
+    char tmpFilename[2048];
+    strcpy(tmpFilename, path.c_str());
+    if (getFPPmode() == REMOTE_MODE)
+        CheckForHostSpecificFile(getSetting("HostName"), tmpFilename);
+
+    if (!FileExists(tmpFilename)) {
+        LogDebug(VB_SEQUENCE, "Not preparing %s, file does not exist\n", tmpFilename);
+        return;
+    }
+
+    LogDebug(VB_SEQUENCE, "Preparing sequence %s\n", filename);
+    m_preparingFilename = filename;
+    m_prepareThreads++;
+    std::thread(&Sequence::PrepareSequenceFileThread, this, std::string(filename),
+                std::string(tmpFilename), (unsigned int)m_prepareGeneration).detach();
+}
+
+void Sequence::PrepareSequenceFileThread(std::string filename, std::string path, unsigned int generation) {
+    FSEQFile *seqFile = FSEQFile::openFSEQFile(path);
+    std::vector<uint8_t> frames;
+    uint32_t frameSize = 0;
+    int count = 0;
+
+    if (seqFile && (m_prepareGeneration == generation)) {
+        int readAheadBlocks = getSettingInt("fseqReadAheadBlocks");
+        if (!readAheadBlocks)
+            readAheadBlocks = 1;
+        seqFile->setReadAhead(readAheadBlocks, readAheadBlocks);
+        seqFile->prepareRead(GetOutputRanges());
+
+        // the same number of frames the read thread would have queued
+        frameSize = seqFile->getFrameDataSize();
+        count = getSettingInt("sequenceCacheFrames");
+        if (count <= 0) {
+            count = SEQUENCE_CACHE_MAX_SIZE / (frameSize ? frameSize : 1);
+            if (count < SEQUENCE_CACHE_MIN_FRAMECOUNT) {
+                count = SEQUENCE_CACHE_MIN_FRAMECOUNT;
+            } else if (count > SEQUENCE_CACHE_FRAMECOUNT) {
+                count = SEQUENCE_CACHE_FRAMECOUNT;
+            }
+        }
+        if (count > seqFile->getNumFrames()) {
+            count = seqFile->getNumFrames();
+        }
+
+        frames.resize((size_t)frameSize * count);
+        for (int x = 0; x < count; x++) {
+            if ((m_prepareGeneration != generation)
+                || !seqFile->readFrameData(x, &frames[(size_t)x * frameSize])) {
+                count = x;
+                break;
+            }
+        }
+    }
+
+    std::unique_lock<std::mutex> lock(m_preparedLock);
+    if (seqFile && (m_prepareGeneration == generation)) {
+        m_preparingFilename = "";
+        m_preparedFilename = filename;
+        m_preparedFile = seqFile;
+        m_preparedFrames.swap(frames);
+        m_preparedFrameSize = frameSize;
+        m_preparedFrameCount = count;
+        seqFile = nullptr;
+        LogDebug(VB_SEQUENCE, "Prepared sequence %s with %d frames read\n", filename.c_str(), count);
+    } else if (m_prepareGeneration == generation) {
+        m_preparingFilename = "";
+    }
+    m_prepareThreads--;
+    m_prepareDone.notify_all();
+    // the Sequence may be destroyed once this is released
+    lock.unlock();
+
+    // superseded or cancelled while we were reading
+    delete seqFile;
+}
+
+//returns the prepared file if it matches, the first frames stay in
+//m_preparedFrames until DiscardPreparedFile() is called
+FSEQFile *Sequence::TakePreparedFile(const char *filename) {
+    std::unique_lock<std::mutex> lock(m_preparedLock);
+    if (m_preparingFilename == filename) {
+        // still reading, don't hold up the start waiting on it
+        LogDebug(VB_SEQUENCE, "Sequence %s is still being prepared, opening it directly\n", filename);
+        m_prepareGeneration++;
+        m_preparingFilename = "";
+        return nullptr;
+    }
+
+    if (!m_preparedFile || (m_preparedFilename != filename)) {
+        return nullptr;
+    }
+
+    FSEQFile *seqFile = m_preparedFile;
+    m_preparedFile = nullptr;
+    m_preparedFilename = "";
+    return seqFile;
+}
+
+void Sequence::DiscardPreparedFile() {
+    std::unique_lock<std::mutex> lock(m_preparedLock);
+    if (m_preparedFile) {
+        delete m_preparedFile;
+        m_preparedFile = nullptr;
+    }
+    m_preparedFilename = "";
+    m_preparedFrames.clear();
+    m_preparedFrames.shrink_to_fit();
+    m_preparedFrameCount = 0;
+}
+
 int Sequence::OpenSequenceFile(const char *filename, int startFrame, int startSecond) {
     LogDebug(VB_SEQUENCE, "OpenSequenceFile(%s, %d, %d)\n", filename, startFrame, startSecond);
 
@@ -187,10 +378,11 @@ int Sequence::OpenSequenceFile(const char *filename, int startFrame, int startSe
         m_lastFrameRead = startFrame - 1;
     }
 
-    std::unique_lock<std::mutex> lock(frameCacheLock);
+    std::unique_lock<std::mutex> readLock(readFileLock);
     clearCaches();
-    lock.unlock();
-    
+    readLock.unlock();
+    m_lastFramePlayed = -1;
+
     m_seqPaused   = 0;
     m_seqDuration = 0;
     m_seqSecondsElapsed = 0;
@@ -222,7 +414,14 @@ int Sequence::OpenSequenceFile(const char *filename, int startFrame, int startSe
     }
     
     m_seqFile = nullptr;
-    FSEQFile *seqFile = FSEQFile::openFSEQFile(tmpFilename);
+    FSEQFile *seqFile = TakePreparedFile(filename);
+    bool prepared = seqFile != nullptr;
+    if (prepared) {
+        LogDebug(VB_SEQUENCE, "Using prepared sequence file %s\n", tmpFilename);
+    } else {
+        DiscardPreparedFile();
+        seqFile = FSEQFile::openFSEQFile(tmpFilename);
+    }
     if (seqFile == NULL) {
         LogErr(VB_SEQUENCE, "Error opening sequence file: %s. FSEQFile::openFSEQFile returned NULL\n",
             tmpFilename);
@@ -249,7 +448,34 @@ int Sequence::OpenSequenceFile(const char *filename, int startFrame, int startSe
         if (m_lastFrameRead < -1) m_lastFrameRead = -1;
     }
 
-    seqFile->prepareRead(GetOutputRanges());
+    if (!prepared) {
+        int readAheadBlocks = getSettingInt("fseqReadAheadBlocks");
+        if (!readAheadBlocks)
+            readAheadBlocks = 1;
+        seqFile->setReadAhead(readAheadBlocks, readAheadBlocks);
+
+        seqFile->prepareRead(GetOutputRanges());
+    }
+    readLock.lock();
+    setupFrameBuffers(seqFile->getFrameDataSize());
+    if (prepared) {
+        // seed the cache with the frames that were read ahead of time
+        std::unique_lock<std::mutex> lock(m_preparedLock);
+        uint32_t frameSize = std::min(m_preparedFrameSize, m_frameBufferSize);
+        int frame = m_lastFrameRead + 1;
+        while ((frame < m_preparedFrameCount)
+               && ((m_frameBufferHead - m_frameBufferTail) < (m_frameBufferCount - SEQUENCE_PAST_FRAMECOUNT))) {
+            uint32_t head = m_frameBufferHead;
+            memcpy(getFrameBuffer(head), &m_preparedFrames[(size_t)frame * m_preparedFrameSize], frameSize);
+            m_frameBufferFrames[head % m_frameBufferCount] = frame;
+            m_frameBufferHead = head + 1;
+            m_lastFrameRead = frame;
+            frame++;
+        }
+        lock.unlock();
+        DiscardPreparedFile();
+    }
+    readLock.unlock();
     // Calculate duration
     m_seqMSRemaining = seqFile->getNumFrames() * seqFile->getStepTime();
     m_seqDuration = m_seqMSRemaining;
@@ -286,32 +512,72 @@ int Sequence::SeekSequenceFile(int frameNumber) {
         LogErr(VB_SEQUENCE, "No sequence is running\n");
         return 0;
     }
-    seqLock.unlock();
-    
-    std::unique_lock<std::mutex> lock(frameCacheLock);
-    while (!pastFrameCache.empty()
-        && frameNumber >= pastFrameCache.back()->frame) {
-        //Going backwords but frame is cached, we'll push the old frames
-        frameCache.push_front(pastFrameCache.back());
-        pastFrameCache.pop_back();
-    }
-    while (!frameCache.empty() && frameCache.front()->frame < frameNumber) {
-        delete frameCache.front();
-        frameCache.pop_front();
+
+    std::unique_lock<std::mutex> readLock(readFileLock);
+    //if the frame is still cached, either ahead of or behind the
+    //current frame, just move to it
+    uint32_t head = m_frameBufferHead;
+    uint32_t available = head - m_frameBufferStart;
+    if (available > (m_frameBufferCount - 1)) {
+        available = m_frameBufferCount - 1;
     }
-    if (!frameCache.empty() && frameNumber < frameCache.front()->frame) {
-        clearCaches();
+    for (uint32_t idx = head - available; idx != head; idx++) {
+        if (m_frameBufferFrames[idx % m_frameBufferCount] == frameNumber) {
+            LogDebug(VB_SEQUENCE, "Seeking to cached frame %d\n", frameNumber);
+            m_frameBufferTail = idx;
+            readLock.unlock();
+            frameLoadSignal.notify_all();
+            return 1;
+        }
     }
+
     LogDebug(VB_SEQUENCE, "Seeking to %d.   Last read is %d\n", frameNumber, (int)m_lastFrameRead);
-    if (frameCache.empty()) {
-        m_lastFrameRead = frameNumber - 1;
-        frameLoadSignal.notify_all();
-    }
-    lock.unlock();
+    clearCaches();
+    m_lastFrameRead = frameNumber - 1;
+    m_doneRead = false;
+    readLock.unlock();
     frameLoadSignal.notify_all();
+    return 1;
 }
 
 
+void Sequence::GetDecodeStats(Json::Value &result) {
+    std::vector<FSEQFile::BlockDecodeStats> stats;
+
+    std::unique_lock<std::mutex> readLock(readFileLock);
+    if (m_seqFile) {
+        result["sequence"] = m_seqFilename;
+        result["stepTime"] = m_seqFile->getStepTime();
+        m_seqFile->getBlockDecodeStats(stats);
+
+        Json::Value cache;
+        cache["frameCount"] = m_frameBufferCount;
+        cache["frameSize"] = m_frameBufferSize;
+        cache["framesAhead"] = m_frameBufferHead - m_frameBufferTail;
+        result["frameCache"] = cache;
+    }
+    readLock.unlock();
+
+    Json::Value blocks(Json::arrayValue);
+    int idx = 0;
+    for (auto &s : stats) {
+        Json::Value block;
+        block["block"] = idx++;
+        block["firstFrame"] = s.firstFrame;
+        block["numFrames"] = s.numFrames;
+        block["compressedSize"] = (Json::UInt64)s.compressedSize;
+        block["decodeCount"] = s.decodeCount;
+        block["prefetchCount"] = s.prefetchCount;
+        block["stallCount"] = s.stallCount;
+        block["lastDecodeTimeUS"] = (Json::UInt64)s.lastDecodeTime;
+        block["maxDecodeTimeUS"] = (Json::UInt64)s.maxDecodeTime;
+        block["avgDecodeTimeUS"] = (Json::UInt64)(s.decodeCount ? s.totalDecodeTime / s.decodeCount : 0);
+        block["stallTimeUS"] = (Json::UInt64)s.stallTime;
+        blocks.append(block);
+    }
+    result["blocks"] = blocks;
+}
+
 char *Sequence::CurrentSequenceFilename(void) {
     return m_seqFilename;
 }
@@ -356,11 +622,15 @@ void Sequence::SingleStepSequenceBack(void) {
     m_seqSingleStepBack = 1;
 }
 
-void Sequence::ReadSequenceData(bool forceFirstFrame) {
+/*
+ * Load the next frame into m_seqData, returns the frame number loaded
+ * or -1 if no new frame was loaded
+ */
+int Sequence::ReadSequenceData(bool forceFirstFrame) {
     LogExcess(VB_SEQUENCE, "ReadSequenceData()\n");
     std::unique_lock<std::recursive_mutex> seqLock(m_sequenceLock);
     if (!forceFirstFrame && m_seqStarting) {
-        return;
+        return -1;
     }
 
     if ((IsSequenceRunning()) && (m_seqPaused)) {
@@ -368,54 +638,36 @@ void Sequence::ReadSequenceData(bool forceFirstFrame) {
             m_seqSingleStep = 0;
         } else if (m_seqSingleStepBack) {
             m_seqSingleStepBack = 0;
-            std::unique_lock<std::mutex> lock(frameCacheLock);
-            if (!pastFrameCache.empty()) {
-                frameCache.push_front(pastFrameCache.back());
-                pastFrameCache.pop_back();
-            } else if (frameCache.empty()) {
-                m_lastFrameRead = -1;
-                frameLoadSignal.notify_all();
-            } else {
-                int f = frameCache.front()->frame - 1;
-                m_lastFrameRead = f - 1;
-                if (m_lastFrameRead < -1) {
-                    m_lastFrameRead = -1;
-                }
-                clearCaches();
-                frameLoadSignal.notify_all();
-            }
+            SeekSequenceFile(m_lastFramePlayed > 0 ? m_lastFramePlayed - 1 : 0);
         } else {
-            return;
+            return -1;
         }
     }
 
     if (forceFirstFrame || IsSequenceRunning()) {
         m_remoteBlankCount = 0;
 
-        std::unique_lock<std::mutex> lock(frameCacheLock);
-        if (frameCache.empty() && !m_doneRead) {
+        uint32_t tail = m_frameBufferTail;
+        if (m_frameBufferHead == tail && !m_doneRead) {
             //wait up to the step time, if we don't have the frame, bail
-            frameLoadedSignal.wait_for(lock, std::chrono::milliseconds(m_seqStepTime - 1));
+            std::unique_lock<std::mutex> lock(frameCacheLock);
+            frameLoadedSignal.wait_for(lock, std::chrono::milliseconds(m_seqStepTime - 1),
+                                       [this, tail] { return m_frameBufferHead != tail || m_doneRead; });
         }
-        if (!frameCache.empty()) {
-            FSEQFile::FrameData *data = frameCache.front();
-            frameCache.pop_front();
-            if (pastFrameCache.size() > 5) {
-                delete pastFrameCache.front();
-                pastFrameCache.pop_front();
-            }
-            pastFrameCache.push_back(data);
-            lock.unlock();
+        if (m_frameBufferHead != tail) {
+            int frame = m_frameBufferFrames[tail % m_frameBufferCount];
+            m_seqFile->unpackFrameData(getFrameBuffer(tail), (uint8_t*)m_seqData);
+            m_frameBufferTail = tail + 1;
             frameLoadSignal.notify_all();
-            
-            data->readFrame((uint8_t*)m_seqData);
-            SetChannelOutputFrameNumber(data->frame);
-            m_seqSecondsElapsed = data->frame * m_seqStepTime;
+
+            m_lastFramePlayed = frame;
+            SetChannelOutputFrameNumber(frame);
+            m_seqSecondsElapsed = frame * m_seqStepTime;
             m_seqSecondsElapsed /= 1000;
             m_seqSecondsRemaining = m_seqDuration - m_seqSecondsElapsed;
             m_dataProcessed = false;
+            return frame;
         } else if (m_doneRead) {
-            lock.unlock();
             m_seqSecondsElapsed = m_seqDuration;
             m_seqSecondsRemaining = m_seqDuration - m_seqSecondsElapsed;
             CloseSequenceFile();
@@ -423,13 +675,12 @@ void Sequence::ReadSequenceData(bool forceFirstFrame) {
             if (m_lastFrameRead > 0) {
                 //we'll have the read thread discard the frame
                 m_lastFrameRead++;
-                if (!pastFrameCache.empty()) {
+                if (tail != m_frameBufferStart) {
                     //and copy the last frame data
-                    pastFrameCache.back()->readFrame((uint8_t*)m_seqData);
+                    m_seqFile->unpackFrameData(getFrameBuffer(tail - 1), (uint8_t*)m_seqData);
                     m_dataProcessed = false;
                 }
             }
-            lock.unlock();
             frameLoadSignal.notify_all();
         }
     } else {
@@ -447,9 +698,10 @@ void Sequence::ReadSequenceData(bool forceFirstFrame) {
             }
         }
     }
+    return -1;
 }
 
-void Sequence::ProcessSequenceData(int ms, int checkControlChannels) {
+void Sequence::ProcessSequenceData(int ms, int checkControlChannels, bool prepareOutputs) {
     if (IsEffectRunning())
         OverlayEffects(m_seqData);
 
@@ -486,7 +738,10 @@ void Sequence::ProcessSequenceData(int ms, int checkControlChannels) {
     if (channelTester->Testing())
         channelTester->OverlayTestData(m_seqData);
     
-    PrepareChannelData(m_seqData);
+    if (prepareOutputs)
+        PrepareChannelData(m_seqData);
+    else
+        ProcessChannelData(m_seqData);
     m_dataProcessed = true;
 }
 
@@ -521,17 +776,14 @@ void Sequence::CloseSequenceFile(void) {
     std::unique_lock<std::recursive_mutex> seqLock(m_sequenceLock);
 
     std::unique_lock<std::mutex> readLock(readFileLock);
+    clearCaches();
+    m_doneRead = true;
+    m_lastFrameRead = -1;
     if (m_seqFile) {
         delete m_seqFile;
         m_seqFile = nullptr;
     }
     readLock.unlock();
-    
-    std::unique_lock<std::mutex> lock(frameCacheLock);
-    clearCaches();
-    m_doneRead = true;
-    m_lastFrameRead = -1;
-    lock.unlock();
     frameLoadedSignal.notify_all();
     
     m_seqFilename[0] = '\0';
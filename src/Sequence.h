@@ -32,10 +32,12 @@
 
 #include <mutex>
 #include <thread>
-#include <list>
+#include <vector>
 #include <atomic>
 #include <condition_variable>
 
+#include <jsoncpp/json/json.h>
+
 #include "fseq/FSEQFile.h"
 
 
@@ -43,7 +45,15 @@
 #define FPPD_MAX_CHANNELS 1048580
 #define DATA_DUMP_SIZE    28
 
-#define SEQUENCE_CACHE_FRAMECOUNT 20
+// Frames read ahead of the one being played.  Unless overridden by the
+// sequenceCacheFrames setting, as many frames as fit in SEQUENCE_CACHE_MAX_SIZE
+// are cached, but never fewer than SEQUENCE_CACHE_MIN_FRAMECOUNT or more
+// than SEQUENCE_CACHE_FRAMECOUNT.
+#define SEQUENCE_CACHE_FRAMECOUNT     20
+#define SEQUENCE_CACHE_MIN_FRAMECOUNT 8
+#define SEQUENCE_CACHE_MAX_SIZE       (8 * 1024 * 1024)
+// Frames already played that are kept for seeking/stepping backwards
+#define SEQUENCE_PAST_FRAMECOUNT      6
 
 class Sequence {
   public:
@@ -53,9 +63,9 @@ class Sequence {
 	int   IsSequenceRunning(void);
 	int   IsSequenceRunning(char *filename);
 	int   OpenSequenceFile(const char *filename, int startFrame = 0, int startSecond = -1);
-	void  ProcessSequenceData(int ms, int checkControlChannels = 1);
+	void  ProcessSequenceData(int ms, int checkControlChannels = 1, bool prepareOutputs = true);
 	int   SeekSequenceFile(int frameNumber);
-	void  ReadSequenceData(bool forceFirstFrame = false);
+	int   ReadSequenceData(bool forceFirstFrame = false);
 	void  SendSequenceData(void);
 	void  SendBlankingData(void);
 	void  CloseIfOpen(char *filename);
@@ -65,6 +75,8 @@ class Sequence {
 	void  SingleStepSequenceBack(void);
 	int   SequenceIsPaused(void);
     bool  isDataProcessed() const { return m_dataProcessed; }
+    void  GetDecodeStats(Json::Value &result);
+    void  PrepareSequenceFile(const char *filename);
 
 	int           m_seqDuration;
 	int           m_seqSecondsElapsed;
@@ -98,10 +110,47 @@ class Sequence {
     volatile bool m_doneRead;
     volatile bool m_shuttingDown;
     std::thread *m_readThread;
-    std::list<FSEQFile::FrameData*> frameCache;
-    std::list<FSEQFile::FrameData*> pastFrameCache;
+
+    // Ring of preallocated frame buffers.  The read thread fills the buffer
+    // at m_frameBufferHead and the output thread plays the one at
+    // m_frameBufferTail; each index is only advanced by its own thread so
+    // normal playback needs no locks.  Anything that moves the indexes
+    // backwards (seeks, clearing the cache) holds both m_sequenceLock and
+    // readFileLock.  The indexes are free running counters, the slot used
+    // is index % m_frameBufferCount.
+    void setupFrameBuffers(uint32_t frameSize);
+    uint8_t *getFrameBuffer(uint32_t idx) { return &m_frameBuffers[(idx % m_frameBufferCount) * m_frameBufferSize]; }
+    std::vector<uint8_t> m_frameBuffers;
+    std::vector<int> m_frameBufferFrames; //frame number in each slot
+    uint32_t m_frameBufferSize;
+    uint32_t m_frameBufferCount;
+    uint32_t m_frameBufferStart; //oldest index that is valid since the last clear
+    std::atomic_uint m_frameBufferHead;
+    std::atomic_uint m_frameBufferTail;
+    int m_lastFramePlayed;
+
     void clearCaches();
-    std::mutex frameCacheLock;
+
+    // Sequence opened and its first frames read ahead of time by
+    // PrepareSequenceFile() so a remote can start the next sequence
+    // without waiting on the disk when the master's start packet arrives.
+    // Workers are detached, bumping m_prepareGeneration cancels any that
+    // are still reading.
+    void PrepareSequenceFileThread(std::string filename, std::string path, unsigned int generation);
+    FSEQFile *TakePreparedFile(const char *filename);
+    void DiscardPreparedFile();
+    std::mutex m_preparedLock;
+    std::condition_variable m_prepareDone;
+    std::atomic_uint m_prepareGeneration;
+    int m_prepareThreads;
+    std::string m_preparingFilename;
+    std::string m_preparedFilename;
+    FSEQFile *m_preparedFile;
+    std::vector<uint8_t> m_preparedFrames;
+    uint32_t m_preparedFrameSize;
+    int m_preparedFrameCount;
+
+    std::mutex frameCacheLock; //only used to wait on the signals
     std::mutex readFileLock; //lock for just the stuff needed to read from the file (m_seqFile variable)
     std::condition_variable frameLoadSignal;
     std::condition_variable frameLoadedSignal;
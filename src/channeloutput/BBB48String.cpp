@@ -517,22 +517,9 @@ void BBB48StringOutput::PrepData(unsigned char *channelData)
 #endif
     uint8_t * out = m_curData;
 
-    PixelString *ps = NULL;
-    uint8_t *c = NULL;
-    int inCh;
-
-    int numStrings = m_numStrings;
-
     for (int s = 0; s < m_strings.size(); s++) {
-        ps = m_strings[s];
-        c = out + ps->m_portNumber;
-        inCh = 0;
-        
-        for (int p = 0; p < ps->m_outputChannels; p++) {
-            uint8_t *brightness = ps->m_brightnessMaps[p];
-            *c = brightness[channelData[ps->m_outputMap[inCh++]]];
-            c += numStrings;
-        }
+        PixelString *ps = m_strings[s];
+        ps->Remap(channelData, out + ps->m_portNumber, m_numStrings);
     }
 }
 int BBB48StringOutput::SendData(unsigned char *channelData)
@@ -29,6 +29,7 @@
 
 
 #include "BBBMatrix.h"
+#include "BitTranspose.h"
 #include "BBBUtils.h"
 #include "common.h"
 #include "log.h"
@@ -276,6 +277,7 @@ BBBMatrix::BBBMatrix(unsigned int startChannel, unsigned int channelCount)
 	m_panelMatrix(nullptr),
     m_outputs(0),
     m_outputFrame(nullptr),
+    m_bitStage(nullptr),
     m_longestChain(0),
     m_panelWidth(32),
     m_panelHeight(16),
@@ -296,6 +298,7 @@ BBBMatrix::~BBBMatrix()
 {
     LogDebug(VB_CHANNELOUT, "BBBMatrix::~BBBMatrix()\n");
     if (m_outputFrame) delete [] m_outputFrame;
+    if (m_bitStage) delete [] m_bitStage;
     if (m_pru) delete m_pru;
     if (m_pruCopy) delete m_pruCopy;
     if (m_handler) delete m_handler;
@@ -461,7 +464,8 @@ int BBBMatrix::Init(Json::Value config)
     }
     
     m_rowSize = m_longestChain * m_panelWidth * 3;
-    m_outputFrame = new uint8_t[m_outputs * m_longestChain * m_panelHeight * m_panelWidth * 3];
+    m_outputFrame = new uint8_t[m_outputs * m_longestChain * m_panelHeight * m_panelWidth * 3]();
+    m_bitStage = new uint8_t[m_outputs * m_longestChain * m_panelHeight * m_panelWidth * 3];
 
     std::vector<std::string> compileArgs;
     
@@ -723,66 +727,49 @@ void BBBMatrix::PrepData(unsigned char *channelData)
     size_t rowLen = m_panelWidth * m_longestChain * m_outputs * 3 * 2 * m_panelHeight / (m_panelScan * 2);
     rowLen /= 8;
     
-    memset(m_outputFrame, 0, m_outputs * m_longestChain * m_panelHeight * m_panelWidth * 3);
+    // Gather the gamma corrected values into m_bitStage with the 8 pixels
+    // that share an output byte next to each other, then split each group
+    // of 8 into its bit planes in one go.
+    size_t chainLen = m_panelWidth/8 * m_outputs * 3 * 2 * m_panelHeight / (m_panelScan * 2);
+    memset(m_bitStage, 0, m_outputs * m_longestChain * m_panelHeight * m_panelWidth * 3);
     for (int output = 0; output < m_outputs; output++) {
         int panelsOnOutput = m_panelMatrix->m_outputPanels[output].size();
         
         for (int i = 0; i < panelsOnOutput; i++) {
             int panel = m_panelMatrix->m_outputPanels[output][i];
             int chain = m_panelMatrix->m_panels[panel].chain;
+            const int *pixelMap = &m_panelMatrix->m_panels[panel].pixelMap[0];
             
             for (int y = 0; y < (m_panelHeight / 2); y++) {
-                int yw1 = y * m_panelWidth * 3;
-                int yw2 = (y + (m_panelHeight / 2)) * m_panelWidth * 3;
+                const int *map1 = pixelMap + y * m_panelWidth * 3;
+                const int *map2 = pixelMap + (y + (m_panelHeight / 2)) * m_panelWidth * 3;
 
-                
                 int yOut = y;
                 m_handler->mapRow(yOut);
-                int offset = yOut * rowLen * m_colorDepth + output * 2 * 3
-                    + (m_longestChain - chain - 1) * m_panelWidth/8 * m_outputs * 3 * 2 * m_panelHeight / (m_panelScan * 2);
+                uint8_t *row = m_bitStage + (yOut * rowLen + output * 2 * 3
+                    + (m_longestChain - chain - 1) * chainLen) * 8;
                 
                 for (int x = 0; x < m_panelWidth; ++x) {
-                    uint8_t r1 = gammaCurve[channelData[m_panelMatrix->m_panels[panel].pixelMap[yw1 + x*3]]];
-                    uint8_t g1 = gammaCurve[channelData[m_panelMatrix->m_panels[panel].pixelMap[yw1 + x*3 + 1]]];
-                    uint8_t b1 = gammaCurve[channelData[m_panelMatrix->m_panels[panel].pixelMap[yw1 + x*3 + 2]]];
-                    
-                    uint8_t r2 = gammaCurve[channelData[m_panelMatrix->m_panels[panel].pixelMap[yw2 + x*3]]];
-                    uint8_t g2 = gammaCurve[channelData[m_panelMatrix->m_panels[panel].pixelMap[yw2 + x*3 + 1]]];
-                    uint8_t b2 = gammaCurve[channelData[m_panelMatrix->m_panels[panel].pixelMap[yw2 + x*3 + 2]]];
-
-                    
                     int xOut = x;
                     m_handler->mapCol(y, xOut);
-                    int bitPos = 1 << (xOut % 8);
-                    int xOff = xOut / 8 * (m_outputs * 2 * 3);
-                    
-                    for (int bit = 8; bit > (8-m_colorDepth); ) {
-                        --bit;
-                        uint8_t mask = 1 << bit;
-                        if (r1 & mask) {
-                            m_outputFrame[offset + xOff] |= bitPos;
-                        }
-                        if (g1 & mask) {
-                            m_outputFrame[offset + xOff + 1] |= bitPos;
-                        }
-                        if (b1 & mask) {
-                            m_outputFrame[offset + xOff + 2] |= bitPos;
-                        }
-                        if (r2 & mask) {
-                            m_outputFrame[offset + xOff + 3] |= bitPos;
-                        }
-                        if (g2 & mask) {
-                            m_outputFrame[offset + xOff + 4] |= bitPos;
-                        }
-                        if (b2 & mask) {
-                            m_outputFrame[offset + xOff + 5] |= bitPos;
-                        }
-                        xOff += rowLen;
-                    }
+                    uint8_t *c = row + (xOut / 8 * (m_outputs * 2 * 3)) * 8 + (xOut % 8);
+
+                    c[0]  = gammaCurve[channelData[map1[x*3]]];
+                    c[8]  = gammaCurve[channelData[map1[x*3 + 1]]];
+                    c[16] = gammaCurve[channelData[map1[x*3 + 2]]];
+                    c[24] = gammaCurve[channelData[map2[x*3]]];
+                    c[32] = gammaCurve[channelData[map2[x*3 + 1]]];
+                    c[40] = gammaCurve[channelData[map2[x*3 + 2]]];
                 }
             }
         }
     }
+
+    for (int y = 0; y < m_panelScan; y++) {
+        BitPlaneTranspose(m_bitStage + y * rowLen * 8,
+                          m_outputFrame + y * rowLen * m_colorDepth,
+                          rowLen, rowLen, m_colorDepth);
+    }
 }
 int BBBMatrix::SendData(unsigned char *channelData)
 {
@@ -87,6 +87,7 @@ class BBBMatrix : public ChannelOutputBase {
     FPPColorOrder m_colorOrder;
 
     uint8_t      *m_outputFrame;
+    uint8_t      *m_bitStage;     // gamma corrected values, 8 per output byte
     int          m_panels;
     int          m_rows;
     int          m_width;
@@ -0,0 +1,40 @@
+/*
+ *   Bit plane helpers for Falcon Player (FPP)
+ *
+ *   Copyright (C) 2013-2018 the Falcon Player Developers
+ *      Initial development by:
+ *      - David Pitts (dpitts)
+ *      - Tony Mace (MyKroFt)
+ *      - Mathew Mrosko (Materdaddy)
+ *      - Chris Pinkham (CaptainMurdoch)
+ *      For additional credits and developers, see credits.php.
+ *
+ *   The Falcon Player (FPP) is free software; you can redistribute it
+ *   and/or modify it under the terms of the GNU General Public License
+ *   as published by the Free Software Foundation; either version 2 of
+ *   the License, or (at your option) any later version.
+ *
+ *   This program is distributed in the hope that it will be useful,
+ *   but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *   GNU General Public License for more details.
+ *
+ *   You should have received a copy of the GNU General Public License
+ *   along with this program; if not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef _BITTRANSPOSE_H
+#define _BITTRANSPOSE_H
+
+#include <stdint.h>
+
+// Convert groups of 8 bytes into bit planes for bit-banged outputs.
+//
+// For each of the 'groups' 8 byte groups at 'in', 'planes' bytes are
+// written to out[group + plane * planeStride].  Plane 0 holds the MSB of
+// each input byte, plane 1 the next bit, etc., with input byte k of the
+// group in bit k of the plane byte.
+void BitPlaneTranspose(const uint8_t *in, uint8_t *out, int groups,
+                       int planeStride, int planes);
+
+#endif /* _BITTRANSPOSE_H */
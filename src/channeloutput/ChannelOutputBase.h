@@ -26,6 +26,7 @@
 #ifndef _CHANNELOUTPUTBASE_H
 #define _CHANNELOUTPUTBASE_H
 
+#include <functional>
 #include <string>
 #include <vector>
 
@@ -53,6 +54,13 @@ class ChannelOutputBase {
 
 
     virtual void  GetRequiredChannelRange(int &min, int & max) = 0;
+    // outputs driving several disjoint blocks of channels can report
+    // each block separately so only those channels are read
+    virtual void  GetRequiredChannelRanges(const std::function<void(int, int)> &addRange) {
+        int min, max;
+        GetRequiredChannelRange(min, max);
+        addRange(min, max);
+    }
   private:
 	int   Init(void);
 
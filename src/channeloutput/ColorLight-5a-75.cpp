@@ -77,6 +77,8 @@
 #include <unistd.h>
 #include <cmath>
 
+#include <algorithm>
+
 #include "common.h"
 #include "ColorLight-5a-75.h"
 #include "log.h"
@@ -210,7 +212,9 @@ int ColorLight5a75Output::Init(Json::Value config)
 
 	m_channelCount = m_width * m_height * 3;
 
-	m_outputFrame = new char[m_outputs * m_longestChain * m_panelHeight * m_panelWidth * 3];
+	m_outputFrame = new char[m_outputs * m_longestChain * m_panelHeight * m_panelWidth * 3]();
+
+	m_panelMatrix->BuildGatherMap(m_outputs, m_longestChain * m_panelWidth, 0, false);
 
 	m_matrix = new Matrix(m_startChannel, m_width, m_height);
 
@@ -314,7 +318,8 @@ int ColorLight5a75Output::Init(Json::Value config)
 	m_sock_addr.sll_halen = ETH_ALEN;
 	memcpy(m_sock_addr.sll_addr, m_eh->ether_dhost, 6);
 
-	m_rowData = m_data + 7;
+	BuildPackets();
+	m_txRing.Init(m_fd, m_sock_addr, CL5A75_BUFFER_SIZE, m_msgs.size());
 
 	return ChannelOutputBase::Init(config);
 }
@@ -338,69 +343,34 @@ void ColorLight5a75Output::GetRequiredChannelRange(int &min, int & max) {
  */
 void ColorLight5a75Output::PrepData(unsigned char *channelData)
 {
-	unsigned char *r = NULL;
-	unsigned char *g = NULL;
-	unsigned char *b = NULL;
-	unsigned char *s = NULL;
-	unsigned char *dst = NULL;
-	int pw3 = m_panelWidth * 3;
-
 	channelData += m_startChannel; // FIXME, this function gets offset 0
 
-	for (int output = 0; output < m_outputs; output++) {
-		int panelsOnOutput = m_panelMatrix->m_outputPanels[output].size();
-
-		for (int i = 0; i < panelsOnOutput; i++) {
-			int panel = m_panelMatrix->m_outputPanels[output][i];
-			int chain = (panelsOnOutput - 1) - m_panelMatrix->m_panels[panel].chain;
-			chain = m_panelMatrix->m_panels[panel].chain;
-
-			for (int y = 0; y < m_panelHeight; y++) {
-				int px = chain * m_panelWidth;
-				int yw = y * m_panelWidth * 3;
-
-				dst = (unsigned char*)(m_outputFrame + (((((output * m_panelHeight) + y) * m_panelWidth * m_longestChain) + px) * 3));
-
-				for (int x = 0; x < pw3; x += 3)
-				{
-					*(dst++) = m_gammaCurve[channelData[m_panelMatrix->m_panels[panel].pixelMap[yw + x]]];
-					*(dst++) = m_gammaCurve[channelData[m_panelMatrix->m_panels[panel].pixelMap[yw + x + 1]]];
-					*(dst++) = m_gammaCurve[channelData[m_panelMatrix->m_panels[panel].pixelMap[yw + x + 2]]];
-
-					px++;
-				}
-			}
-		}
-	}
+	m_panelMatrix->Gather(channelData, (unsigned char *)m_outputFrame, m_gammaCurve);
 }
 
 /*
- *
+ * Build the packet list for a frame: the 0x0101 and 0x0AFF packets
+ * followed by the row data split into packets of up to 497 pixels.
  */
-int ColorLight5a75Output::SendData(unsigned char *channelData)
+void ColorLight5a75Output::BuildPackets(void)
 {
-	LogExcess(VB_CHANNELOUT, "ColorLight5a75Output::SendData(%p)\n", channelData);
-
-	if (sendto(m_fd, m_buffer_0101, m_buffer_0101_len, 0, (struct sockaddr*)&m_sock_addr, sizeof(struct sockaddr_ll)) < 0) {
-		LogErr(VB_CHANNELOUT, "Error sending 0x0101 packet: %s\n", strerror(errno));
-		return 0;
-	}
-
-	if (sendto(m_fd, m_buffer_0AFF, m_buffer_0AFF_len, 0, (struct sockaddr*)&m_sock_addr, sizeof(struct sockaddr_ll)) < 0) {
-		LogErr(VB_CHANNELOUT, "Error sending 0x0AFF packet: %s\n", strerror(errno));
-		return 0;
-	}
-
-	char *rowPtr = (char *)m_outputFrame;
-	int row = 0;
-	int offset = 0;
-	int pixelOffset = 0;
-	int maxPixelsPerPacket = 497;
-	int maxBytesPerPacket = maxPixelsPerPacket * 3;
-	int bytesInPacket = 0;
-	int pixelsInPacket = 0;
-	int pktSize = 0;
-	for (row = 0; row < m_rows; row++) {
+	int packetsPerRow = (m_rowSize + (CL5A75_MAX_ROW_PIXELS * 3) - 1) / (CL5A75_MAX_ROW_PIXELS * 3);
+	int rowPackets = m_rows * packetsPerRow;
+
+	m_rowHeaders.resize(rowPackets * CL5A75_ROW_HEADER_SIZE);
+	m_iovecs.clear();
+	m_iovecs.reserve(2 + rowPackets * 2);
+
+	struct iovec iov;
+	iov.iov_base = m_buffer_0101;
+	iov.iov_len = m_buffer_0101_len;
+	m_iovecs.push_back(iov);
+	iov.iov_base = m_buffer_0AFF;
+	iov.iov_len = m_buffer_0AFF_len;
+	m_iovecs.push_back(iov);
+
+	char *header = &m_rowHeaders[0];
+	for (int row = 0; row < m_rows; row++) {
 		if (row < 256) {
 			m_eh->ether_type = htons(0x5500);
 			m_data[0] = row;
@@ -412,34 +382,54 @@ int ColorLight5a75Output::SendData(unsigned char *channelData)
 		m_data[5] = 0x08; // ?? still not sure what this value is
 		m_data[6] = 0x80; // ?? still not sure what this value is
 
-		offset = 0;
+		int offset = 0;
 		while (offset < m_rowSize) {
-			if ((offset + maxBytesPerPacket) > m_rowSize)
-				bytesInPacket = m_rowSize - offset;
-			else
-				bytesInPacket = maxBytesPerPacket;
-
-			memcpy(m_rowData, rowPtr + offset, bytesInPacket);
-
-			pixelOffset = offset / 3;
-			pixelsInPacket = bytesInPacket / 3;
+			int bytesInPacket = std::min(m_rowSize - offset, CL5A75_MAX_ROW_PIXELS * 3);
+			int pixelOffset = offset / 3;
+			int pixelsInPacket = bytesInPacket / 3;
 
 			m_data[1] = pixelOffset >> 8;      // Pixel Offset MSB
 			m_data[2] = pixelOffset & 0xFF;    // Pixel Offset LSB
 			m_data[3] = pixelsInPacket >> 8;   // Pixels In Packet MSB
 			m_data[4] = pixelsInPacket & 0xFF; // Pixels In Packet LSB
 
-			offset += bytesInPacket;
+			memcpy(header, m_buffer, CL5A75_ROW_HEADER_SIZE);
 
-			pktSize = sizeof(struct ether_header) + 7 + bytesInPacket;
+			iov.iov_base = header;
+			iov.iov_len = CL5A75_ROW_HEADER_SIZE;
+			m_iovecs.push_back(iov);
+			iov.iov_base = m_outputFrame + (row * m_rowSize) + offset;
+			iov.iov_len = bytesInPacket;
+			m_iovecs.push_back(iov);
 
-			if (sendto(m_fd, m_buffer, pktSize, 0, (struct sockaddr*)&m_sock_addr, sizeof(struct sockaddr_ll)) < 0) {
-				LogErr(VB_CHANNELOUT, "Error sending row data packet: %s\n", strerror(errno));
-				return 0;
-			}
+			header += CL5A75_ROW_HEADER_SIZE;
+			offset += bytesInPacket;
 		}
+	}
+
+	m_msgs.resize(2 + rowPackets);
+	memset(&m_msgs[0], 0, sizeof(struct mmsghdr) * m_msgs.size());
+	for (int i = 0, v = 0; i < m_msgs.size(); i++) {
+		m_msgs[i].msg_hdr.msg_name = &m_sock_addr;
+		m_msgs[i].msg_hdr.msg_namelen = sizeof(struct sockaddr_ll);
+		m_msgs[i].msg_hdr.msg_iov = &m_iovecs[v];
+		m_msgs[i].msg_hdr.msg_iovlen = (i < 2) ? 1 : 2;
+		v += m_msgs[i].msg_hdr.msg_iovlen;
+	}
+
+	LogDebug(VB_CHANNELOUT, "ColorLight output using %d packets per frame\n", (int)m_msgs.size());
+}
 
-		rowPtr += m_rowSize;
+/*
+ *
+ */
+int ColorLight5a75Output::SendData(unsigned char *channelData)
+{
+	LogExcess(VB_CHANNELOUT, "ColorLight5a75Output::SendData(%p)\n", channelData);
+
+	if (m_txRing.Send(m_msgs) < 0) {
+		LogErr(VB_CHANNELOUT, "Error sending ColorLight packets: %s\n", strerror(errno));
+		return 0;
 	}
 
 	return m_channelCount;
@@ -29,14 +29,19 @@
 #include <arpa/inet.h>
 #include <linux/if_packet.h>
 #include <net/if.h>
+#include <sys/socket.h>
 #include <string>
+#include <vector>
 
 #include "ChannelOutputBase.h"
 #include "ColorOrder.h"
 #include "Matrix.h"
+#include "PacketTxRing.h"
 #include "PanelMatrix.h"
 
 #define CL5A75_BUFFER_SIZE  1536
+#define CL5A75_ROW_HEADER_SIZE     (sizeof(struct ether_header) + 7)
+#define CL5A75_MAX_ROW_PIXELS      497
 
 class ColorLight5a75Output : public ChannelOutputBase {
   public:
@@ -55,6 +60,7 @@ class ColorLight5a75Output : public ChannelOutputBase {
 
   private:
 	void SetHostMACs(void *data);
+	void BuildPackets(void);
 
 	int          m_width;
 	int          m_height;
@@ -72,9 +78,15 @@ class ColorLight5a75Output : public ChannelOutputBase {
 	
 	char  m_buffer[CL5A75_BUFFER_SIZE];
 	char *m_data;
-	char *m_rowData;
 	int   m_rowSize;
 
+	// Every packet of a frame, sent in one go through m_txRing.  The row
+	// packets point at a prebuilt header and directly into m_outputFrame.
+	std::vector<char>           m_rowHeaders;
+	std::vector<struct iovec>   m_iovecs;
+	std::vector<struct mmsghdr> m_msgs;
+	PacketTxRing                m_txRing;
+
 	struct ifreq          m_if_idx;
 	struct ifreq          m_if_mac;
 	struct ether_header  *m_eh;
@@ -39,6 +39,7 @@ public:
     virtual void PrepareData(unsigned char *channelData);
     virtual void CreateMessages(std::vector<struct mmsghdr> &ipMsgs);
     virtual void DumpConfig();
+    virtual bool HasPushMessage() { return true; }
     
     char          sequenceNumber;
     
@@ -72,7 +72,8 @@ const unsigned char E131header[] = {
 
 
 E131OutputData::E131OutputData(const Json::Value &config)
-: UDPOutputData(config), E131sequenceNumber(1), universeCount(1) {
+: UDPOutputData(config), E131sequenceNumber(1), universeCount(1),
+  syncUniverse(0), syncSequenceNumber(1) {
     memset((char *) &e131Address, 0, sizeof(sockaddr_in));
     e131Address.sin_family = AF_INET;
     e131Address.sin_port = htons(E131_DEST_PORT);
@@ -85,6 +86,12 @@ E131OutputData::E131OutputData(const Json::Value &config)
     if (universeCount < 1) {
         universeCount = 1;
     }
+    syncUniverse = getSettingInt("E131SyncUniverse");
+    if ((syncUniverse < 0) || (syncUniverse > 63999)) {
+        LogErr(VB_CHANNELOUT, "Invalid E1.31 sync universe %d, universes will not be synchronized\n",
+               syncUniverse);
+        syncUniverse = 0;
+    }
     switch (type) {
         case 0: // Multicast
             ipAddress = "";
@@ -133,6 +140,8 @@ E131OutputData::E131OutputData(const Json::Value &config)
         
         int uni = universe + x;
         e131Buffer[E131_PRIORITY_INDEX] = priority;
+        e131Buffer[E131_SYNC_ADDRESS_INDEX] = (char)(syncUniverse/256);
+        e131Buffer[E131_SYNC_ADDRESS_INDEX+1] = (char)(syncUniverse%256);
         e131Buffer[E131_UNIVERSE_INDEX] = (char)(uni/256);
         e131Buffer[E131_UNIVERSE_INDEX+1] = (char)(uni%256);
         
@@ -163,6 +172,40 @@ E131OutputData::E131OutputData(const Json::Value &config)
         e131Iovecs[x * 2 + 1].iov_base = nullptr;
         e131Iovecs[x * 2 + 1].iov_len = channelCount;
     }
+
+    // Synchronization packet, sent after all of the frame's data so the
+    // receivers latch every universe at the same time
+    memset(e131SyncPacket, 0, E131_SYNC_PACKET_LENGTH);
+    memset((char *) &e131SyncAddress, 0, sizeof(sockaddr_in));
+    if (syncUniverse) {
+        // preamble, ACN packet identifier and CID match the data packets
+        memcpy(e131SyncPacket, E131header, E131_FRAMING_COUNT_INDEX);
+
+        int count = E131_SYNC_PACKET_LENGTH - 16;
+        e131SyncPacket[E131_RLP_COUNT_INDEX] = (count/256)+0x70;
+        e131SyncPacket[E131_RLP_COUNT_INDEX+1] = count%256;
+        e131SyncPacket[E131_VECTOR_INDEX] = VECTOR_ROOT_E131_EXTENDED;
+
+        count = E131_SYNC_PACKET_LENGTH - 38;
+        e131SyncPacket[E131_FRAMING_COUNT_INDEX] = (count/256)+0x70;
+        e131SyncPacket[E131_FRAMING_COUNT_INDEX+1] = count%256;
+        e131SyncPacket[E131_EXTENDED_PACKET_TYPE_INDEX] = VECTOR_E131_EXTENDED_SYNCHRONIZATION;
+
+        e131SyncPacket[E131_SYNC_UNIVERSE_INDEX] = (char)(syncUniverse/256);
+        e131SyncPacket[E131_SYNC_UNIVERSE_INDEX+1] = (char)(syncUniverse%256);
+
+        e131SyncAddress.sin_family = AF_INET;
+        e131SyncAddress.sin_port = htons(E131_DEST_PORT);
+        if (type == E131_TYPE_MULTICAST) {
+            char sAddress[32];
+            sprintf(sAddress, "239.255.%d.%d", syncUniverse/256, syncUniverse%256);
+            e131SyncAddress.sin_addr.s_addr = inet_addr(sAddress);
+        } else {
+            e131SyncAddress.sin_addr = e131Address.sin_addr;
+        }
+    }
+    e131SyncIovec.iov_base = e131SyncPacket;
+    e131SyncIovec.iov_len = E131_SYNC_PACKET_LENGTH;
 }
 
 E131OutputData::~E131OutputData() {
@@ -183,6 +226,7 @@ void E131OutputData::PrepareData(unsigned char *channelData) {
             e131Iovecs[x * 2 + 1].iov_base = (void*)cur;
             cur += channelCount;
         }
+        e131SyncPacket[E131_SYNC_SEQUENCE_INDEX] = syncSequenceNumber++;
     }
     E131sequenceNumber++;
 }
@@ -201,13 +245,37 @@ void E131OutputData::CreateMessages(std::vector<struct mmsghdr> &ipMsgs) {
         }
     }
 }
+void E131OutputData::AddPostDataMessages(std::vector<struct mmsghdr> &bMsgs) {
+    if (valid && active && syncUniverse) {
+        for (auto &msg : bMsgs) {
+            struct sockaddr_in *addr = (struct sockaddr_in *)msg.msg_hdr.msg_name;
+            if ((msg.msg_hdr.msg_iovlen == 1)
+                && (msg.msg_hdr.msg_iov[0].iov_len == E131_SYNC_PACKET_LENGTH)
+                && (addr->sin_port == e131SyncAddress.sin_port)
+                && (addr->sin_addr.s_addr == e131SyncAddress.sin_addr.s_addr)) {
+                //another universe already syncs this destination
+                return;
+            }
+        }
+
+        struct mmsghdr msg;
+        memset(&msg, 0, sizeof(msg));
+
+        msg.msg_hdr.msg_name = &e131SyncAddress;
+        msg.msg_hdr.msg_namelen = sizeof(sockaddr_in);
+        msg.msg_hdr.msg_iov = &e131SyncIovec;
+        msg.msg_hdr.msg_iovlen = 1;
+        msg.msg_len = E131_SYNC_PACKET_LENGTH;
+        bMsgs.push_back(msg);
+    }
+}
 void E131OutputData::GetRequiredChannelRange(int &min, int & max) {
     min = startChannel - 1;
     max = startChannel + (channelCount * universeCount) - 1;
 }
 
 void E131OutputData::DumpConfig() {
-    LogDebug(VB_CHANNELOUT, "E1.31 Universe: %s   %d:%d:%d:%d:%d:%d  %s\n",
+    LogDebug(VB_CHANNELOUT, "E1.31 Universe: %s   %d:%d:%d:%d:%d:%d:%d  %s\n",
              description.c_str(),
              active,
              universe,
@@ -215,5 +283,6 @@ void E131OutputData::DumpConfig() {
              channelCount,
              type,
              universeCount,
+             syncUniverse,
              ipAddress.c_str());
 }
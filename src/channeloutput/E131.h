@@ -41,6 +41,7 @@ public:
     virtual bool IsPingable();
     virtual void PrepareData(unsigned char *channelData);
     virtual void CreateMessages(std::vector<struct mmsghdr> &ipMsgs);
+    virtual void AddPostDataMessages(std::vector<struct mmsghdr> &bMsgs);
     virtual void DumpConfig();
     virtual void GetRequiredChannelRange(int &min, int & max);
 
@@ -53,6 +54,13 @@ public:
     sockaddr_in   e131Address;
     std::vector<struct iovec>  e131Iovecs;
     std::vector<unsigned char *> e131Headers;
+
+    // E1.31 synchronization, 0 if universes latch as they arrive
+    int           syncUniverse;
+    char          syncSequenceNumber;
+    sockaddr_in   e131SyncAddress;
+    unsigned char e131SyncPacket[E131_SYNC_PACKET_LENGTH];
+    struct iovec  e131SyncIovec;
 };
 
 #endif
@@ -40,6 +40,7 @@
 #define LOR_INTENSITY_SIZE 6
 #define LOR_HEARTBEAT_SIZE 5
 #define LOR_MAX_CHANNELS   3840
+#define LOR_MAX_FRAME_SIZE (LOR_MAX_CHANNELS * LOR_INTENSITY_SIZE + LOR_HEARTBEAT_SIZE)
 
 /////////////////////////////////////////////////////////////////////////////
 
@@ -47,6 +48,7 @@ typedef struct lorPrivData {
 	char          filename[1024];
 	int           fd;
 	int           speed;
+	SerialWriter *writer;
     int           controllerOffset;
 	int           maxIntensity;
 	long long     lastHeartbeat;
@@ -54,6 +56,7 @@ typedef struct lorPrivData {
 	unsigned char intensityData[LOR_INTENSITY_SIZE];
 	unsigned char heartbeatData[LOR_HEARTBEAT_SIZE];
 	char          lastValue[LOR_MAX_CHANNELS];
+	unsigned char frame[LOR_MAX_FRAME_SIZE];
 } LORPrivData;
 
 /////////////////////////////////////////////////////////////////////////////
@@ -172,6 +175,19 @@ int LOR_Open(const char *configStr, void **privDataPtr) {
 		return 0;
 	}
 
+	// Only changed channels are sent so nothing may be dropped, queue in
+	// order and allow a frame of backlog before SendData starts failing.
+	privData->writer = SerialWriterCreate(privData->fd, privData->speed, "8N1",
+		LOR_MAX_FRAME_SIZE * 2, SERIAL_WRITER_APPEND | SERIAL_WRITER_RATE_LIMIT);
+	if (!privData->writer)
+	{
+		LogErr(VB_CHANNELOUT, "Error creating serial writer for %s\n",
+			privData->filename);
+		SerialClose(privData->fd);
+		free(privData);
+		return 0;
+	}
+
 	privData->maxIntensity = 255;
 	LOR_SetupIntensityMap(privData);
 
@@ -204,6 +220,9 @@ int LOR_Close(void *data) {
 	LORPrivData *privData = (LORPrivData*)data;
 	LOR_Dump(privData);
 
+	SerialWriterDestroy(privData->writer);
+	privData->writer = NULL;
+
 	SerialClose(privData->fd);
 	privData->fd = -1;
 }
@@ -234,21 +253,20 @@ int LOR_IsActive(void *data) {
 }
 
 /*
- *
+ * Append a heartbeat to the frame if one is due, returns bytes added
  */
-void LOR_SendHeartbeat(LORPrivData *privData)
+int LOR_AddHeartbeat(LORPrivData *privData, unsigned char *buf)
 {
 	long long now = GetTime();
 
 	// Only send a heartbeat every 300ms
 	if (privData->lastHeartbeat > (now - 300000))
-		return;
+		return 0;
 
-	if (privData->fd > 0)
-	{
-		write(privData->fd, privData->heartbeatData, LOR_HEARTBEAT_SIZE);
-		privData->lastHeartbeat = now;
-	}
+	memcpy(buf, privData->heartbeatData, LOR_HEARTBEAT_SIZE);
+	privData->lastHeartbeat = now;
+
+	return LOR_HEARTBEAT_SIZE;
 }
 
 /*
@@ -269,6 +287,7 @@ int LOR_SendData(void *data, const char *channelData, int channelCount)
 	}
 
 	int i = 0;
+	int len = 0;
 	for (i = 0; i < channelCount; i++)
 	{
 		if (privData->lastValue[i] != channelData[i])
@@ -281,13 +300,32 @@ int LOR_SendData(void *data, const char *channelData, int channelCount)
 			privData->intensityData[3] = privData->intensityMap[channelData[i]];
 			privData->intensityData[4] = 0x80 | (i % 16);
 
-			write(privData->fd, privData->intensityData, LOR_INTENSITY_SIZE);
-
-			privData->lastValue[i] = channelData[i];
+			memcpy(privData->frame + len, privData->intensityData, LOR_INTENSITY_SIZE);
+			len += LOR_INTENSITY_SIZE;
 		}
 	}
 
-	LOR_SendHeartbeat(privData);
+	len += LOR_AddHeartbeat(privData, privData->frame + len);
+
+	if (!len)
+		return 1;
+
+	struct iovec iov;
+	iov.iov_base = privData->frame;
+	iov.iov_len = len;
+
+	// If the port is backed up leave lastValue alone so the changes
+	// are picked up again on the next frame
+	if (SerialWriterQueue(privData->writer, &iov, 1) < 0)
+	{
+		LogExcess(VB_CHANNELOUT, "LOR port busy, deferring %d bytes\n", len);
+		privData->lastHeartbeat = 0;
+		return 0;
+	}
+
+	memcpy(privData->lastValue, channelData, channelCount);
+
+	return 1;
 }
 
 /*
@@ -222,11 +222,20 @@ int LinsnRV9Output::Init(Json::Value config)
 
 	// Calculate max frame size and allocate
 	m_outputFrameSize = m_formatCodes[m_formatIndex].width * m_formatCodes[m_formatIndex].height * 3 + m_formatCodes[m_formatIndex].dataOffset;
-	m_outputFrame = new char[m_outputFrameSize];
 
 	// Calculate the minimum number of packets to send the height we need
 	m_framePackets = ((m_height * m_formatCodes[m_formatIndex].width + m_formatCodes[m_formatIndex].dataOffset) / 480) + 1;
 
+	// The data packets are sent straight from the frame, make sure the
+	// last one doesn't run off the end
+	if (m_outputFrameSize < ((m_framePackets - 1) * LINSNRV9_DATA_SIZE))
+		m_outputFrameSize = (m_framePackets - 1) * LINSNRV9_DATA_SIZE;
+
+	m_outputFrame = new char[m_outputFrameSize]();
+
+	m_panelMatrix->BuildGatherMap(m_outputs, m_formatCodes[m_formatIndex].width,
+		m_formatCodes[m_formatIndex].dataOffset, true);
+
 	m_matrix = new Matrix(m_startChannel, m_width, m_height);
 
 	if (config.isMember("subMatrices"))
@@ -353,6 +362,9 @@ int LinsnRV9Output::Init(Json::Value config)
 	// FIXME, this should use the MAC received during discovery
 	SetHostMACs(m_buffer);
 
+	BuildPackets();
+	m_txRing.Init(m_fd, m_sock_addr, LINSNRV9_BUFFER_SIZE, m_msgs.size());
+
 	return ChannelOutputBase::Init(config);
 }
 
@@ -376,52 +388,17 @@ void LinsnRV9Output::GetRequiredChannelRange(int &min, int & max) {
  */
 void LinsnRV9Output::PrepData(unsigned char *channelData)
 {
-	unsigned char *r = NULL;
-	unsigned char *g = NULL;
-	unsigned char *b = NULL;
-	unsigned char *s = NULL;
-	unsigned char *dst = NULL;
-	int pw3 = m_panelWidth * 3;
-
 	channelData += m_startChannel; // FIXME, this function gets offset 0
 
-	for (int output = 0; output < m_outputs; output++)
-	{
-		int panelsOnOutput = m_panelMatrix->m_outputPanels[output].size();
-
-		for (int i = 0; i < panelsOnOutput; i++)
-		{
-			int panel = m_panelMatrix->m_outputPanels[output][i];
-			int chain = (panelsOnOutput - 1) - m_panelMatrix->m_panels[panel].chain;
-
-			for (int y = 0; y < m_panelHeight; y++)
-			{
-				int px = chain * m_panelWidth;
-				int yw = y * m_panelWidth * 3;
-
-				dst = (unsigned char*)(m_outputFrame + (((((output * m_panelHeight) + y) * m_formatCodes[m_formatIndex].width) + px) * 3) + m_formatCodes[m_formatIndex].dataOffset);
-
-				for (int x = 0; x < pw3; x += 3)
-				{
-					*(dst++) = m_gammaCurve[channelData[m_panelMatrix->m_panels[panel].pixelMap[yw + x]]];
-					*(dst++) = m_gammaCurve[channelData[m_panelMatrix->m_panels[panel].pixelMap[yw + x + 1]]];
-					*(dst++) = m_gammaCurve[channelData[m_panelMatrix->m_panels[panel].pixelMap[yw + x + 2]]];
-
-					px++;
-				}
-			}
-		}
-	}
+	m_panelMatrix->Gather(channelData, (unsigned char *)m_outputFrame, m_gammaCurve);
 }
 
 /*
- *
+ * Build the packet list for a frame.  The first packet carries the format
+ * code and no data, the rest carry a frame number and 1440 data bytes.
  */
-int LinsnRV9Output::SendData(unsigned char *channelData)
+void LinsnRV9Output::BuildPackets(void)
 {
-	LogExcess(VB_CHANNELOUT, "LinsnRV9Output::SendData(%p)\n", channelData);
-
-	SetHostMACs(m_buffer);
 	memset(m_data, 0, LINSNRV9_DATA_SIZE);
 
 	// Clear the frame number
@@ -439,30 +416,59 @@ int LinsnRV9Output::SendData(unsigned char *channelData)
 
 	m_buffer[45] = m_formatCodes[m_formatIndex].code;
 
-	if (sendto(m_fd, m_buffer, LINSNRV9_BUFFER_SIZE, 0, (struct sockaddr*)&m_sock_addr, sizeof(struct sockaddr_ll)) < 0) {
-		LogErr(VB_CHANNELOUT, "Error sending row data packet: %s\n", strerror(errno));
-		return 0;
-	}
+	m_firstPacket.assign(m_buffer, m_buffer + LINSNRV9_BUFFER_SIZE);
+
+	int dataPackets = m_framePackets - 1;
+	m_packetHeaders.resize(dataPackets * LINSNRV9_PACKET_HEADER_SIZE);
+	m_iovecs.clear();
+	m_iovecs.reserve(1 + dataPackets * 2);
 
-	int row = 0;
-	int frameNumber = 1;
-	int bytesSent = 0;
-	int framesSent = 0;
+	struct iovec iov;
+	iov.iov_base = &m_firstPacket[0];
+	iov.iov_len = LINSNRV9_BUFFER_SIZE;
+	m_iovecs.push_back(iov);
 
 	memset(m_header, 0, LINSNRV9_HEADER_SIZE);
-	while (frameNumber < m_framePackets) {
+	char *header = &m_packetHeaders[0];
+	for (int frameNumber = 1; frameNumber < m_framePackets; frameNumber++)
+	{
 		m_buffer[14] = (unsigned char)(frameNumber & 0x00FF);
 		m_buffer[15] = (unsigned char)(frameNumber >> 8);
 
-		memcpy(m_data, m_outputFrame + bytesSent, LINSNRV9_DATA_SIZE);
+		memcpy(header, m_buffer, LINSNRV9_PACKET_HEADER_SIZE);
 
-		if (sendto(m_fd, m_buffer, LINSNRV9_BUFFER_SIZE, 0, (struct sockaddr*)&m_sock_addr, sizeof(struct sockaddr_ll)) < 0) {
-			LogErr(VB_CHANNELOUT, "Error sending row data packet: %s\n", strerror(errno));
-			return 0;
-		}
+		iov.iov_base = header;
+		iov.iov_len = LINSNRV9_PACKET_HEADER_SIZE;
+		m_iovecs.push_back(iov);
+		iov.iov_base = m_outputFrame + ((frameNumber - 1) * LINSNRV9_DATA_SIZE);
+		iov.iov_len = LINSNRV9_DATA_SIZE;
+		m_iovecs.push_back(iov);
 
-		bytesSent += LINSNRV9_DATA_SIZE;
-		frameNumber++;
+		header += LINSNRV9_PACKET_HEADER_SIZE;
+	}
+
+	m_msgs.resize(1 + dataPackets);
+	memset(&m_msgs[0], 0, sizeof(struct mmsghdr) * m_msgs.size());
+	for (int i = 0, v = 0; i < m_msgs.size(); i++)
+	{
+		m_msgs[i].msg_hdr.msg_name = &m_sock_addr;
+		m_msgs[i].msg_hdr.msg_namelen = sizeof(struct sockaddr_ll);
+		m_msgs[i].msg_hdr.msg_iov = &m_iovecs[v];
+		m_msgs[i].msg_hdr.msg_iovlen = i ? 2 : 1;
+		v += m_msgs[i].msg_hdr.msg_iovlen;
+	}
+}
+
+/*
+ *
+ */
+int LinsnRV9Output::SendData(unsigned char *channelData)
+{
+	LogExcess(VB_CHANNELOUT, "LinsnRV9Output::SendData(%p)\n", channelData);
+
+	if (m_txRing.Send(m_msgs) < 0) {
+		LogErr(VB_CHANNELOUT, "Error sending row data packet: %s\n", strerror(errno));
+		return 0;
 	}
 
 	return m_channelCount;
@@ -35,11 +35,13 @@
 #include "ChannelOutputBase.h"
 #include "ColorOrder.h"
 #include "Matrix.h"
+#include "PacketTxRing.h"
 #include "PanelMatrix.h"
 
 #define LINSNRV9_BUFFER_SIZE  1486
 #define LINSNRV9_HEADER_SIZE  32
 #define LINSNRV9_DATA_SIZE    1440
+#define LINSNRV9_PACKET_HEADER_SIZE (sizeof(struct ether_header) + LINSNRV9_HEADER_SIZE)
 
 class LinsnRV9Output : public ChannelOutputBase {
   public:
@@ -62,6 +64,7 @@ class LinsnRV9Output : public ChannelOutputBase {
 	void GetSrcMAC(void);
 	void SetHostMACs(void *data);
 	void SetDiscoveryMACs(void *data);
+	void BuildPackets(void);
 
 	int          m_width;
 	int          m_height;
@@ -79,6 +82,14 @@ class LinsnRV9Output : public ChannelOutputBase {
 	int   m_framePackets;
 	int   m_frameNumber;
 
+	// Every packet of a frame, sent in one go through m_txRing.  The data
+	// packets point at a prebuilt header and directly into m_outputFrame.
+	std::vector<char>           m_firstPacket;
+	std::vector<char>           m_packetHeaders;
+	std::vector<struct iovec>   m_iovecs;
+	std::vector<struct mmsghdr> m_msgs;
+	PacketTxRing                m_txRing;
+
 	struct ifreq          m_if_idx;
 	struct ifreq          m_if_mac;
 	struct ether_header  *m_eh;
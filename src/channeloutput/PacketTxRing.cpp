@@ -0,0 +1,206 @@
+/*
+ *   Raw packet TX ring for Falcon Player (FPP)
+ *
+ *   Copyright (C) 2013-2018 the Falcon Player Developers
+ *      Initial development by:
+ *      - David Pitts (dpitts)
+ *      - Tony Mace (MyKroFt)
+ *      - Mathew Mrosko (Materdaddy)
+ *      - Chris Pinkham (CaptainMurdoch)
+ *      For additional credits and developers, see credits.php.
+ *
+ *   The Falcon Player (FPP) is free software; you can redistribute it
+ *   and/or modify it under the terms of the GNU General Public License
+ *   as published by the Free Software Foundation; either version 2 of
+ *   the License, or (at your option) any later version.
+ *
+ *   This program is distributed in the hope that it will be useful,
+ *   but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *   GNU General Public License for more details.
+ *
+ *   You should have received a copy of the GNU General Public License
+ *   along with this program; if not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include <errno.h>
+#include <poll.h>
+#include <string.h>
+#include <sys/mman.h>
+#include <unistd.h>
+
+#include "log.h"
+#include "PacketTxRing.h"
+
+// Packet data starts after the aligned tpacket2_hdr in each ring frame
+#define TXRING_DATA_OFFSET  TPACKET_ALIGN(sizeof(struct tpacket2_hdr))
+
+PacketTxRing::PacketTxRing()
+  : m_sock(-1),
+	m_ring(NULL),
+	m_ringSize(0),
+	m_frameSize(0),
+	m_frameCount(0),
+	m_frameIndex(0)
+{
+	memset(&m_addr, 0, sizeof(m_addr));
+}
+
+PacketTxRing::~PacketTxRing()
+{
+	Close();
+}
+
+/*
+ *
+ */
+bool PacketTxRing::Init(int sock, const struct sockaddr_ll &addr, int maxPacketSize, int frameCount)
+{
+	Close();
+
+	m_sock = sock;
+	m_addr = addr;
+
+	int version = TPACKET_V2;
+	if (setsockopt(sock, SOL_PACKET, PACKET_VERSION, &version, sizeof(version)) < 0) {
+		LogWarn(VB_CHANNELOUT, "Unable to use TPACKET_V2, falling back to sendmmsg: %s\n", strerror(errno));
+		return false;
+	}
+
+	// round the frames up to a power of two so they pack evenly into pages
+	int frameSize = TPACKET_ALIGNMENT;
+	while (frameSize < ((int)TXRING_DATA_OFFSET + maxPacketSize))
+		frameSize <<= 1;
+
+	int blockSize = getpagesize();
+	while (blockSize < frameSize)
+		blockSize <<= 1;
+
+	int framesPerBlock = blockSize / frameSize;
+	int blockCount = (frameCount + framesPerBlock - 1) / framesPerBlock;
+
+	struct tpacket_req req;
+	memset(&req, 0, sizeof(req));
+	req.tp_block_size = blockSize;
+	req.tp_block_nr = blockCount;
+	req.tp_frame_size = frameSize;
+	req.tp_frame_nr = blockCount * framesPerBlock;
+
+	if (setsockopt(sock, SOL_PACKET, PACKET_TX_RING, &req, sizeof(req)) < 0) {
+		LogWarn(VB_CHANNELOUT, "Unable to create PACKET_TX_RING, falling back to sendmmsg: %s\n", strerror(errno));
+		return false;
+	}
+
+	m_ringSize = (size_t)blockSize * blockCount;
+	void *ring = mmap(NULL, m_ringSize, PROT_READ | PROT_WRITE, MAP_SHARED, sock, 0);
+	if (ring == MAP_FAILED) {
+		LogWarn(VB_CHANNELOUT, "Unable to map PACKET_TX_RING, falling back to sendmmsg: %s\n", strerror(errno));
+		m_ringSize = 0;
+		return false;
+	}
+
+	m_ring = (uint8_t *)ring;
+	m_frameSize = frameSize;
+	m_frameCount = req.tp_frame_nr;
+	m_frameIndex = 0;
+
+	LogDebug(VB_CHANNELOUT, "Mapped PACKET_TX_RING with %d frames of %d bytes\n", m_frameCount, m_frameSize);
+
+	return true;
+}
+
+void PacketTxRing::Close(void)
+{
+	if (m_ring) {
+		munmap(m_ring, m_ringSize);
+		m_ring = NULL;
+	}
+	m_ringSize = 0;
+	m_frameCount = 0;
+	m_frameIndex = 0;
+}
+
+/*
+ *
+ */
+int PacketTxRing::Send(std::vector<struct mmsghdr> &msgs)
+{
+	if (m_ring)
+		return SendRing(msgs);
+
+	return SendMessages(msgs);
+}
+
+int PacketTxRing::SendMessages(std::vector<struct mmsghdr> &msgs)
+{
+	int msgCount = msgs.size();
+	int sent = 0;
+	while (sent < msgCount) {
+		int oc = sendmmsg(m_sock, &msgs[sent], msgCount - sent, 0);
+		if (oc < 0)
+			return -1;
+
+		sent += oc;
+	}
+
+	return sent;
+}
+
+// Kick the kernel to transmit everything queued in the ring and wait for it
+int PacketTxRing::Flush(void)
+{
+	return sendto(m_sock, NULL, 0, 0, (struct sockaddr*)&m_addr, sizeof(m_addr));
+}
+
+int PacketTxRing::SendRing(std::vector<struct mmsghdr> &msgs)
+{
+	int queued = 0;
+
+	for (auto &msg : msgs) {
+		struct tpacket2_hdr *hdr = (struct tpacket2_hdr *)(m_ring + (size_t)m_frameIndex * m_frameSize);
+
+		if (hdr->tp_status != TP_STATUS_AVAILABLE) {
+			// ring is full, send what we have and wait for the frame
+			if ((Flush() < 0) && (errno != EAGAIN))
+				return -1;
+
+			struct pollfd pfd;
+			pfd.fd = m_sock;
+			pfd.events = POLLOUT;
+			pfd.revents = 0;
+			while ((hdr->tp_status != TP_STATUS_AVAILABLE) && (hdr->tp_status & TP_STATUS_WRONG_FORMAT) == 0) {
+				if (poll(&pfd, 1, 100) <= 0)
+					return -1;
+			}
+
+			if (hdr->tp_status & TP_STATUS_WRONG_FORMAT) {
+				LogErr(VB_CHANNELOUT, "PACKET_TX_RING rejected a packet\n");
+				hdr->tp_status = TP_STATUS_AVAILABLE;
+			}
+		}
+
+		uint8_t *data = (uint8_t *)hdr + TXRING_DATA_OFFSET;
+		size_t maxLen = m_frameSize - TXRING_DATA_OFFSET;
+		size_t len = 0;
+		for (size_t i = 0; i < msg.msg_hdr.msg_iovlen; i++) {
+			struct iovec *iov = &msg.msg_hdr.msg_iov[i];
+			if ((len + iov->iov_len) > maxLen)
+				return -1;
+
+			memcpy(data + len, iov->iov_base, iov->iov_len);
+			len += iov->iov_len;
+		}
+
+		hdr->tp_len = len;
+		__sync_synchronize();
+		hdr->tp_status = TP_STATUS_SEND_REQUEST;
+
+		m_frameIndex = (m_frameIndex + 1) % m_frameCount;
+		queued++;
+	}
+
+	if (Flush() < 0)
+		return -1;
+
+	return queued;
+}
@@ -0,0 +1,68 @@
+/*
+ *   Raw packet TX ring for Falcon Player (FPP)
+ *
+ *   Copyright (C) 2013-2018 the Falcon Player Developers
+ *      Initial development by:
+ *      - David Pitts (dpitts)
+ *      - Tony Mace (MyKroFt)
+ *      - Mathew Mrosko (Materdaddy)
+ *      - Chris Pinkham (CaptainMurdoch)
+ *      For additional credits and developers, see credits.php.
+ *
+ *   The Falcon Player (FPP) is free software; you can redistribute it
+ *   and/or modify it under the terms of the GNU General Public License
+ *   as published by the Free Software Foundation; either version 2 of
+ *   the License, or (at your option) any later version.
+ *
+ *   This program is distributed in the hope that it will be useful,
+ *   but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *   GNU General Public License for more details.
+ *
+ *   You should have received a copy of the GNU General Public License
+ *   along with this program; if not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef _PACKETTXRING_H
+#define _PACKETTXRING_H
+
+#include <linux/if_packet.h>
+#include <sys/socket.h>
+#include <stddef.h>
+#include <stdint.h>
+
+#include <vector>
+
+// Sends a frame's worth of packets on an AF_PACKET socket.  If a
+// PACKET_TX_RING could be mapped the packets are copied into the ring and
+// flushed with a single send(), otherwise they go out with sendmmsg().
+class PacketTxRing {
+  public:
+	PacketTxRing();
+	~PacketTxRing();
+
+	// Map a ring with room for frameCount packets of up to maxPacketSize
+	// bytes on sock.  Returns false (and leaves sendmmsg in use) on failure.
+	bool Init(int sock, const struct sockaddr_ll &addr, int maxPacketSize, int frameCount);
+	void Close(void);
+
+	bool IsMapped(void) { return m_ring != NULL; }
+
+	// Returns the number of packets sent or -1 on error
+	int  Send(std::vector<struct mmsghdr> &msgs);
+
+  private:
+	int  SendRing(std::vector<struct mmsghdr> &msgs);
+	int  SendMessages(std::vector<struct mmsghdr> &msgs);
+	int  Flush(void);
+
+	int                 m_sock;
+	struct sockaddr_ll  m_addr;
+	uint8_t            *m_ring;
+	size_t              m_ringSize;
+	int                 m_frameSize;
+	int                 m_frameCount;
+	int                 m_frameIndex;
+};
+
+#endif /* _PACKETTXRING_H */
@@ -26,6 +26,8 @@
 #include <stdlib.h>
 #include <sys/types.h>
 
+#include <algorithm>
+
 #include "common.h"
 #include "log.h"
 #include "PanelMatrix.h"
@@ -247,3 +249,75 @@ int PanelMatrix::CalculateMaps(void)
 	return 1;
 }
 
+/*
+ *
+ */
+void PanelMatrix::BuildGatherMap(int outputs, int rowWidth, int dataOffset, bool reverseChain)
+{
+	int rowBytes = m_panelWidth * 3;
+	std::vector<std::pair<uint32_t, const int*>> rows;
+
+	for (int output = 0; output < outputs && output < MAX_MATRIX_OUTPUTS; output++)
+	{
+		int panelsOnOutput = m_outputPanels[output].size();
+
+		for (int i = 0; i < panelsOnOutput; i++)
+		{
+			int panel = m_outputPanels[output][i];
+			int chain = m_panels[panel].chain;
+			if (reverseChain)
+				chain = (panelsOnOutput - 1) - chain;
+
+			if ((chain < 0) || (m_panels[panel].pixelMap.size() < (m_panelHeight * rowBytes)))
+				continue;
+
+			for (int y = 0; y < m_panelHeight; y++)
+			{
+				uint32_t dst = ((((output * m_panelHeight) + y) * rowWidth) + (chain * m_panelWidth)) * 3 + dataOffset;
+				rows.push_back(std::make_pair(dst, &m_panels[panel].pixelMap[y * rowBytes]));
+			}
+		}
+	}
+
+	std::stable_sort(rows.begin(), rows.end(),
+		[](const std::pair<uint32_t, const int*> &a, const std::pair<uint32_t, const int*> &b) { return a.first < b.first; });
+
+	m_gatherSpans.clear();
+	m_gatherMap.clear();
+	m_gatherMap.reserve(rows.size() * rowBytes);
+	for (auto &r : rows)
+	{
+		if (!m_gatherSpans.empty() &&
+			((m_gatherSpans.back().dstOffset + m_gatherSpans.back().count) == r.first))
+		{
+			m_gatherSpans.back().count += rowBytes;
+		}
+		else
+		{
+			PanelGatherSpan span;
+			span.dstOffset = r.first;
+			span.count = rowBytes;
+			span.mapOffset = m_gatherMap.size();
+			m_gatherSpans.push_back(span);
+		}
+		m_gatherMap.insert(m_gatherMap.end(), r.second, r.second + rowBytes);
+	}
+
+	LogDebug(VB_CHANNELOUT, "PanelMatrix gather map: %d channels in %d spans\n",
+		(int)m_gatherMap.size(), (int)m_gatherSpans.size());
+}
+
+/*
+ *
+ */
+void PanelMatrix::Gather(const unsigned char *channelData, unsigned char *dst, const uint8_t *gamma) const
+{
+	for (auto &span : m_gatherSpans)
+	{
+		unsigned char *d = dst + span.dstOffset;
+		const uint32_t *map = &m_gatherMap[span.mapOffset];
+
+		for (uint32_t x = 0; x < span.count; x++)
+			d[x] = gamma[channelData[map[x]]];
+	}
+}
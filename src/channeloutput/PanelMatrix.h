@@ -26,6 +26,7 @@
 #ifndef _PANELMATRIX_H
 #define _PANELMATRIX_H
 
+#include <stdint.h>
 #include <string>
 #include <vector>
 
@@ -49,6 +50,13 @@ typedef struct ledPanel {
 	std::vector<int> pixelMap;
 } LEDPanel;
 
+// A run of bytes in an output frame filled from consecutive m_gatherMap entries
+typedef struct panelGatherSpan {
+	uint32_t dstOffset;
+	uint32_t count;
+	uint32_t mapOffset;
+} PanelGatherSpan;
+
 class PanelMatrix {
   public:
 	PanelMatrix(int panelWidth, int panelHeight, int invertedData = 0);
@@ -63,6 +71,13 @@ class PanelMatrix {
 	int  Height(void)     { return m_height; }
 	int  PanelCount(void) { return m_panelCount; }
 
+	// Flatten the panel pixel maps into the order the channels appear in a
+	// frame made of one row of chained panels per output row.  rowWidth is
+	// the frame width in pixels, dataOffset the bytes before the first row.
+	// With reverseChain the last panel on an output comes first.
+	void BuildGatherMap(int outputs, int rowWidth, int dataOffset, bool reverseChain);
+	void Gather(const unsigned char *channelData, unsigned char *dst, const uint8_t *gamma) const;
+
 	// Map of output channels to full matrix channels
 	std::vector<int> m_outputPixelMap[MAX_MATRIX_OUTPUTS];
 
@@ -75,6 +90,9 @@ class PanelMatrix {
 
 	int CalculateMaps(void);
 
+	std::vector<PanelGatherSpan> m_gatherSpans;
+	std::vector<uint32_t>        m_gatherMap;
+
 	int  m_width;
 	int  m_height;
 	int  m_outputCount;
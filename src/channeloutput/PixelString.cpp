@@ -24,6 +24,8 @@
  */
 
 #include <stdlib.h>
+#include <string.h>
+#include <algorithm>
 #include <cmath>
 
 #include "common.h"
@@ -47,7 +49,8 @@ PixelString::PixelString()
   : m_portNumber(0),
 	m_channelOffset(0),
     m_inputChannels(0),
-	m_outputChannels(0)
+	m_outputChannels(0),
+	m_remapIndexBase(0)
 {
 }
 
@@ -159,9 +162,6 @@ int PixelString::Init(Json::Value config)
 		m_outputMap[i] = FPPD_MAX_CHANNELS - 2;
 
 	int offset = 0;
-	int mapIndex = 0;
-
-	m_brightnessMaps = (uint8_t **)calloc(1, sizeof(uint8_t*) * m_outputChannels);
 
 	for (int i = 0; i < m_virtualStrings.size(); i++)
 	{
@@ -169,14 +169,178 @@ int PixelString::Init(Json::Value config)
 
 		SetupMap(offset, m_virtualStrings[i]);
 		offset += m_virtualStrings[i].pixelCount * m_virtualStrings[i].channelsPerNode();
-
-		for (int j = 0; j < ((m_virtualStrings[i].nullNodes*3) + (m_virtualStrings[i].pixelCount*m_virtualStrings[i].channelsPerNode())); j++)
-			m_brightnessMaps[mapIndex++] = m_virtualStrings[i].brightnessMap;
 	}
 
+	BuildRemapPlan();
+
 	return 1;
 }
 
+/*
+ * Compile m_outputMap and the virtual string brightness maps into runs so
+ * PrepData doesn't need a map pointer and an index per output channel.
+ * Identical brightness maps are shared and an identity map is dropped.
+ */
+void PixelString::BuildRemapPlan(void)
+{
+	std::vector<uint16_t> channelMaps(m_outputChannels, PIXELSTRING_NO_BRIGHTNESS_MAP);
+
+	m_remapMaps.clear();
+	int offset = 0;
+	for (int i = 0; i < m_virtualStrings.size(); i++)
+	{
+		VirtualString &vs = m_virtualStrings[i];
+
+		bool identity = true;
+		for (int x = 0; x < 256 && identity; x++)
+			identity = vs.brightnessMap[x] == x;
+
+		uint16_t mapIdx = PIXELSTRING_NO_BRIGHTNESS_MAP;
+		if (!identity)
+		{
+			for (mapIdx = 0; mapIdx < m_remapMaps.size(); mapIdx++)
+			{
+				if (!memcmp(m_remapMaps[mapIdx], vs.brightnessMap, 256))
+					break;
+			}
+			if (mapIdx == m_remapMaps.size())
+				m_remapMaps.push_back(vs.brightnessMap);
+		}
+
+		int count = (vs.nullNodes * 3) + (vs.pixelCount * vs.channelsPerNode());
+		for (int j = 0; (j < count) && (offset < m_outputChannels); j++)
+			channelMaps[offset++] = mapIdx;
+	}
+
+	// runs shorter than this aren't worth a segment of their own
+	const int minRun = 8;
+
+	m_remapSegments.clear();
+	m_remapIndex.clear();
+	m_remapIndex16.clear();
+	m_remapIndexBase = 0;
+	int o = 0;
+	while (o < m_outputChannels)
+	{
+		int run = 1;
+		while (((o + run) < m_outputChannels)
+			&& (m_outputMap[o + run] == (m_outputMap[o] + run))
+			&& (channelMaps[o + run] == channelMaps[o]))
+			run++;
+
+		PixelStringRemapSegment *seg = m_remapSegments.empty() ? NULL : &m_remapSegments.back();
+		if (run >= minRun)
+		{
+			PixelStringRemapSegment newSeg;
+			newSeg.outputOffset = o;
+			newSeg.count = run;
+			newSeg.inputChannel = m_outputMap[o];
+			newSeg.brightnessMap = channelMaps[o];
+			newSeg.contiguous = true;
+			m_remapSegments.push_back(newSeg);
+		}
+		else
+		{
+			for (int x = 0; x < run; x++)
+			{
+				if (!seg || seg->contiguous || (seg->brightnessMap != channelMaps[o + x]))
+				{
+					PixelStringRemapSegment newSeg;
+					newSeg.outputOffset = o + x;
+					newSeg.count = 0;
+					newSeg.inputChannel = m_remapIndex.size();
+					newSeg.brightnessMap = channelMaps[o + x];
+					newSeg.contiguous = false;
+					m_remapSegments.push_back(newSeg);
+					seg = &m_remapSegments.back();
+				}
+				m_remapIndex.push_back(m_outputMap[o + x]);
+				seg->count++;
+			}
+		}
+		o += run;
+	}
+
+	// use the compact index when the channels fit, halves the index reads
+	if (!m_remapIndex.empty())
+	{
+		uint32_t lo = *std::min_element(m_remapIndex.begin(), m_remapIndex.end());
+		uint32_t hi = *std::max_element(m_remapIndex.begin(), m_remapIndex.end());
+		if ((hi - lo) <= 0xFFFF)
+		{
+			m_remapIndexBase = lo;
+			m_remapIndex16.reserve(m_remapIndex.size());
+			for (auto ch : m_remapIndex)
+				m_remapIndex16.push_back(ch - lo);
+			std::vector<uint32_t>().swap(m_remapIndex);
+		}
+	}
+
+	LogDebug(VB_CHANNELOUT, "PixelString port %d: %d channels in %d remap segments, %d brightness maps, %d bit index\n",
+		m_portNumber, m_outputChannels, (int)m_remapSegments.size(), (int)m_remapMaps.size(),
+		m_remapIndex.empty() ? 16 : 32);
+}
+
+/*
+ * Copy the listed input channels, through the brightness map if given
+ */
+template <typename T>
+static inline void RemapIndexed(const uint8_t *channelData, const T *idx,
+	uint32_t count, const uint8_t *map, uint8_t *o, int stride)
+{
+	if (map)
+	{
+		for (uint32_t x = 0; x < count; x++, o += stride)
+			*o = map[channelData[idx[x]]];
+	}
+	else
+	{
+		for (uint32_t x = 0; x < count; x++, o += stride)
+			*o = channelData[idx[x]];
+	}
+}
+
+/*
+ *
+ */
+void PixelString::Remap(const uint8_t *channelData, uint8_t *out, int stride) const
+{
+	for (auto &seg : m_remapSegments)
+	{
+		uint8_t *o = out + (size_t)seg.outputOffset * stride;
+		const uint8_t *map = (seg.brightnessMap == PIXELSTRING_NO_BRIGHTNESS_MAP)
+			? NULL : m_remapMaps[seg.brightnessMap];
+
+		if (seg.contiguous)
+		{
+			const uint8_t *in = channelData + seg.inputChannel;
+			if (map)
+			{
+				for (uint32_t x = 0; x < seg.count; x++, o += stride)
+					*o = map[in[x]];
+			}
+			else if (stride == 1)
+			{
+				memcpy(o, in, seg.count);
+			}
+			else
+			{
+				for (uint32_t x = 0; x < seg.count; x++, o += stride)
+					*o = in[x];
+			}
+		}
+		else
+		{
+			if (m_remapIndex.empty())
+				RemapIndexed(channelData + m_remapIndexBase, &m_remapIndex16[seg.inputChannel],
+					seg.count, map, o, stride);
+			else
+				RemapIndexed(channelData, &m_remapIndex[seg.inputChannel],
+					seg.count, map, o, stride);
+		}
+	}
+}
+
 
 void PixelString::SetupMap(int vsOffset, VirtualString vs)
 {
@@ -55,6 +55,20 @@ public:
     int            whiteOffset;
 };
 
+#define PIXELSTRING_NO_BRIGHTNESS_MAP 0xFFFF
+
+// One step of a PixelString's compiled remap plan.  Contiguous segments
+// read count channels starting at inputChannel, the others read the input
+// channels listed in the remap index starting at inputChannel.
+class PixelStringRemapSegment {
+public:
+	uint32_t       outputOffset;
+	uint32_t       count;
+	uint32_t       inputChannel;
+	uint16_t       brightnessMap; // index into m_remapMaps
+	bool           contiguous;
+};
+
 class PixelString {
   public:
 	PixelString();
@@ -63,6 +77,10 @@ class PixelString {
 	int  Init(Json::Value config);
 	void DumpConfig(void);
 
+	// Write m_outputChannels bytes in output order, stride bytes apart,
+	// with the brightness/gamma maps applied.
+	void Remap(const uint8_t *channelData, uint8_t *out, int stride = 1) const;
+
 	int               m_portNumber;
 	int               m_channelOffset;
 	int               m_inputChannels;
@@ -71,12 +89,23 @@ class PixelString {
 	std::vector<VirtualString>  m_virtualStrings;
 
 	std::vector<int>  m_outputMap;
-	uint8_t         **m_brightnessMaps;
+
   private:
+	void BuildRemapPlan(void);
+
 	void SetupMap(int vsOffset, VirtualString vs);
 	void FlipPixels(int offset1, int offset2, int chanCount);
 	void DumpMap(const char *msg);
 
+	std::vector<PixelStringRemapSegment> m_remapSegments;
+	// Input channels for the non-contiguous segments.  When they all lie
+	// within 64K channels of m_remapIndexBase they are kept as 16 bit
+	// offsets from it, otherwise as 32 bit channel numbers.
+	std::vector<uint16_t>                m_remapIndex16;
+	std::vector<uint32_t>                m_remapIndex;
+	uint32_t                             m_remapIndexBase;
+	std::vector<const uint8_t*>          m_remapMaps;
+
 };
 
 #endif /* _PIXELSTRING_H */
@@ -54,6 +54,7 @@ typedef struct triksCPrivData {
 
 	char filename[1024];
 	int  fd;
+	SerialWriter *writer;
 	int  width;
 	int  height;
 	int  panels;
@@ -272,6 +273,19 @@ int TriksC_Open(const char *configStr, void **privDataPtr) {
 		return 0;
 	}
 
+	privData->writer = SerialWriterCreate(privData->fd, 57600, "8N1",
+		sizeof(privData->outBuf),
+		SERIAL_WRITER_LATEST_FRAME | SERIAL_WRITER_RATE_LIMIT);
+	if (!privData->writer)
+	{
+		LogErr(VB_CHANNELOUT, "Error creating serial writer for %s\n",
+			privData->filename);
+
+		SerialClose(privData->fd);
+		free(privData);
+		return 0;
+	}
+
 	pthread_mutex_init(&privData->bufLock, NULL);
 	pthread_mutex_init(&privData->sendLock, NULL);
 	pthread_cond_init(&privData->sendCond, NULL);
@@ -321,6 +335,9 @@ int TriksC_Close(void *data) {
 	pthread_mutex_destroy(&privData->sendLock);
 	pthread_cond_destroy(&privData->sendCond);
 
+	SerialWriterDestroy(privData->writer);
+	privData->writer = NULL;
+
 	SerialClose(privData->fd);
 	privData->fd = -1;
 }
@@ -543,11 +560,17 @@ void ProcessInputBuffer(TriksCPrivData *privData)
 	if (LogMaskIsSet(VB_CHANNELDATA) && LogLevelIsSet(LOG_EXCESSIVE))
 		DumpEncodedBuffer(privData);
 
+	struct iovec iov[TRIKSC_MAX_PANELS];
 	int p = 0;
 	for (p = 0; p < privData->panels; p++)
 	{
-		write(privData->fd, privData->outBuf[p], privData->outputBytes[p]);
+		iov[p].iov_base = privData->outBuf[p];
+		iov[p].iov_len = privData->outputBytes[p];
 	}
+
+	if (SerialWriterQueue(privData->writer, iov, privData->panels) < 0)
+		LogErr(VB_CHANNELOUT, "Triks-C frame for %d panels does not fit the serial writer buffer\n",
+			privData->panels);
 }
 
 /*
@@ -17,7 +17,9 @@
  *   You should have received a copy of the GNU General Public License
  *   along with this program; if not, see <http://www.gnu.org/licenses/>.
  */
+#include <algorithm>
 #include <chrono>
+#include <map>
 #include <set>
 #include <errno.h>
 #include <string.h>
@@ -28,8 +30,15 @@
 #include <stdlib.h>
 #include <unistd.h>
 #include <ifaddrs.h>
+#include <net/if.h>
+#include <pthread.h>
+#include <sched.h>
+#include <netdb.h>
+#include <poll.h>
+#include <time.h>
 
 #include "UDPOutput.h"
+#include "channeloutputthread.h"
 #include "log.h"
 #include "ping.h"
 
@@ -40,6 +49,31 @@
 #include "DDP.h"
 #include "ArtNet.h"
 
+// Seconds between routine controller probes
+#define CONTROLLER_PROBE_INTERVAL   10
+// Milliseconds to wait for the replies to a round of probes
+#define CONTROLLER_PROBE_TIMEOUT    1000
+// Consecutive unanswered probes before a controller is dropped
+#define CONTROLLER_PROBE_MAX_MISSED 2
+
+// Unchanged frames still sent after the data stops changing, E1.31
+// asks for three packets of the final data before suppressing
+#define UDP_CHANGE_REPEATS          2
+// Default keep-alive for unchanged universes in ms
+#define UDP_DEFAULT_KEEPALIVE       1000
+
+// Outputs with fewer messages than this are never paced, larger ones
+// are split into at most UDP_PACING_MAX_SLICES sendmmsg() calls
+#define UDP_PACING_MIN_BATCH        32
+#define UDP_PACING_MAX_SLICES       8
+
+// Sharded sending, each shard's send buffer holds this many frames of
+// its messages, within the min/max
+#define UDP_MAX_SEND_SHARDS         8
+#define UDP_SNDBUF_FRAMES           4
+#define UDP_MIN_SNDBUF              (256 * 1024)
+#define UDP_MAX_SNDBUF              (8 * 1024 * 1024)
+
 
 UDPOutputData::UDPOutputData(const Json::Value &config)
 :  valid(true) {
@@ -52,15 +86,42 @@ UDPOutputData::UDPOutputData(const Json::Value &config)
 UDPOutputData::~UDPOutputData() {
 }
 
+ControllerHealth::ControllerHealth(const std::string &h)
+  : host(h), resolved(false), reachable(true), missed(0),
+    pending(false), pendingSeq(0),
+    sent(0), received(0), lastRTT(0), minRTT(0), maxRTT(0), totalRTT(0)
+{
+    memset(&address, 0, sizeof(address));
+    memset(&sentTime, 0, sizeof(sentTime));
+}
+
+UDPSendShard::UDPSendShard(int i)
+  : index(i), sendSocket(-1), cpu(-1), sendBufferSize(0), thread(nullptr),
+    outputCount(0), sendErrno(0),
+    lastSendTime(0), maxSendTime(0), totalSendTime(0), frames(0)
+{
+}
+
+UDPOutput *UDPOutput::INSTANCE = nullptr;
 
 
 UDPOutput::UDPOutput(unsigned int startChannel, unsigned int channelCount)
-    : pingThread(nullptr), rebuildOutputLists(false)
+    : pacing(0), shardFrame(0), shardsBusy(0), runShards(false),
+    changeDetection(false), keepAliveInterval(UDP_DEFAULT_KEEPALIVE),
+    statsStart(0), windowSent(0), windowSkipped(0),
+    packetsSent(0), packetsSkipped(0), sentPerSecond(0), savedPerSecond(0),
+    newMsgListsReady(false), pingSocket(-1), pingId(0), pingSeq(0),
+    monitorThread(nullptr), runMonitor(false), probeRequested(false)
 {
     sendSocket = -1;
+    INSTANCE = this;
 }
 UDPOutput::~UDPOutput() {
-    runDisabledPings = false;
+    StopHealthMonitor();
+    StopSendShards();
+    if (INSTANCE == this) {
+        INSTANCE = nullptr;
+    }
     for (auto a : outputs) {
         delete a;
     }
@@ -124,14 +185,55 @@ int UDPOutput::Init(Json::Value config) {
     }
     
     
+    changeDetection = getSettingInt("UDPChangeDetection") ? true : false;
+    if (changeDetection) {
+        keepAliveInterval = getSettingInt("UDPKeepAliveInterval");
+        if (keepAliveInterval <= 0) {
+            keepAliveInterval = UDP_DEFAULT_KEEPALIVE;
+        }
+        LogDebug(VB_CHANNELOUT, "UDP change detection enabled, keep-alive %dms\n",
+                 keepAliveInterval);
+    }
+
+    pacing = getSettingInt("UDPPacing");
+    if ((pacing < 0) || (pacing > 90)) {
+        pacing = 0;
+    }
+
     InitNetwork();
-    PingControllers();
+
+    int shardCount = getSettingInt("UDPSendThreads");
+    if (shardCount > 1) {
+        InitSendShards(std::min(shardCount, UDP_MAX_SEND_SHARDS));
+    }
+
+    InitControllerHealth();
+    ProbeControllers();
+    UpdateOutputValidity();
+    RebuildOutputMessageLists();
+
+    if ((pingSocket >= 0) && !controllers.empty()) {
+        runMonitor = true;
+        monitorThread = new std::thread(&UDPOutput::RunHealthMonitor, this);
+    }
     return ChannelOutputBase::Init(config);
 }
 int  UDPOutput::Close() {
+    StopHealthMonitor();
+    StopSendShards();
     return ChannelOutputBase::Close();
 }
 void UDPOutput::PrepData(unsigned char *channelData) {
+    if (newMsgListsReady) {
+        // pick up the lists the health monitor built for us
+        std::unique_lock<std::mutex> lck(msgListMutex);
+        udpMsgs.swap(pendingUdpMsgs);
+        broadcastMsgs.swap(pendingBroadcastMsgs);
+        udpTracking.swap(pendingUdpTracking);
+        broadcastTracking.swap(pendingBroadcastTracking);
+        udpMsgShards.swap(pendingUdpMsgShards);
+        newMsgListsReady = false;
+    }
     if (enabled) {
         for (auto a : outputs) {
             a->PrepareData(channelData);
@@ -153,175 +255,781 @@ void  UDPOutput::GetRequiredChannelRange(int &min, int & max) {
     }
 }
 
+void UDPOutput::GetRequiredChannelRanges(const std::function<void(int, int)> &addRange) {
+    if (enabled) {
+        for (auto a : outputs) {
+            if (a->active) {
+                int mi, mx;
+                a->GetRequiredChannelRange(mi, mx);
+                addRange(mi, mx);
+            }
+        }
+    }
+}
+
+int UDPOutput::SendMessages(int socket, struct mmsghdr *msgs, int msgCount) {
+    int oc = sendmmsg(socket, msgs, msgCount, 0);
+    int outputCount = oc;
+    while (oc > 0 && outputCount != msgCount) {
+        oc = sendmmsg(socket, &msgs[outputCount], msgCount - outputCount, 0);
+        if (oc >= 0) {
+            outputCount += oc;
+        }
+    }
+    return outputCount;
+}
+
 int UDPOutput::SendMessages(int socket, std::vector<struct mmsghdr> &sendmsgs) {
     errno = 0;
-    struct mmsghdr *msgs = &sendmsgs[0];
     int msgCount = sendmsgs.size();
     if (msgCount == 0) {
         return 0;
     }
-    
-    int oc = sendmmsg(socket, msgs, msgCount, 0);
-    int outputCount = oc;
-    while (oc > 0 && outputCount != msgCount) {
-        int oc = sendmmsg(sendSocket, &msgs[outputCount], msgCount - outputCount, 0);
-        if (oc >= 0) {
+    return SendMessages(socket, &sendmsgs[0], msgCount);
+}
+
+int UDPOutput::SendPacedMessages(int socket, std::vector<struct mmsghdr> &sendmsgs) {
+    errno = 0;
+    int msgCount = sendmsgs.size();
+    if (msgCount == 0) {
+        return 0;
+    }
+    struct mmsghdr *msgs = &sendmsgs[0];
+    if (!pacing || (msgCount <= UDP_PACING_MIN_BATCH)) {
+        return SendMessages(socket, msgs, msgCount);
+    }
+
+    // Spread the messages over part of the frame time so a few hundred
+    // universes don't hit the switch as a single burst
+    int slices = (msgCount + UDP_PACING_MIN_BATCH - 1) / UDP_PACING_MIN_BATCH;
+    if (slices > UDP_PACING_MAX_SLICES) {
+        slices = UDP_PACING_MAX_SLICES;
+    }
+    long long budget = (long long)GetChannelOutputFrameTime() * pacing / 100;
+
+    struct timespec start;
+    clock_gettime(CLOCK_MONOTONIC, &start);
+
+    int outputCount = 0;
+    for (int slice = 0; slice < slices; slice++) {
+        int end = (int)((long long)msgCount * (slice + 1) / slices);
+        int oc = SendMessages(socket, &msgs[outputCount], end - outputCount);
+        if (oc > 0) {
             outputCount += oc;
         }
+        if (outputCount != end) {
+            break;
+        }
+
+        if (slice < (slices - 1)) {
+            long long offset = budget * (slice + 1) / slices;
+            struct timespec next = start;
+            next.tv_sec += offset / 1000000;
+            next.tv_nsec += (offset % 1000000) * 1000;
+            if (next.tv_nsec >= 1000000000) {
+                next.tv_sec++;
+                next.tv_nsec -= 1000000000;
+            }
+            clock_nanosleep(CLOCK_MONOTONIC, TIMER_ABSTIME, &next, nullptr);
+        }
     }
     return outputCount;
 }
 
+
 int UDPOutput::SendData(unsigned char *channelData) {
-    if (rebuildOutputLists) {
-        RebuildOutputMessageLists();
-    }
-    
     if ((udpMsgs.size() == 0 && broadcastMsgs.size() == 0) || !enabled) {
         return 0;
     }
+    long long now = 0;
+    std::vector<struct mmsghdr> *sendMsgs = &udpMsgs;
+    if (changeDetection) {
+        now = GetTime() / 1000;
+        if (sendShards.empty()) {
+            SelectChangedMessages(udpMsgs, udpTracking, changedUdpMsgs, now);
+            sendMsgs = &changedUdpMsgs;
+        }
+    }
+
     std::chrono::high_resolution_clock clock;
     auto t1 = clock.now();
-    int outputCount = SendMessages(sendSocket, udpMsgs);
+    int outputCount;
+    int msgCount;
+    int sendErrno;
+    if (sendShards.empty()) {
+        outputCount = SendPacedMessages(sendSocket, *sendMsgs);
+        msgCount = sendMsgs->size();
+        sendErrno = errno;
+    } else {
+        outputCount = SendShardedMessages(now, msgCount, sendErrno);
+    }
     auto t2 = clock.now();
     long diff = std::chrono::duration_cast<std::chrono::milliseconds>(t2 - t1).count();
-    if ((outputCount != udpMsgs.size()) || (diff > 100)) {
+    if (pacing) {
+        // don't count the time spent deliberately spacing out the messages
+        diff -= (long long)GetChannelOutputFrameTime() * pacing / 100000;
+    }
+
+    if (changeDetection) {
+        long long elapsed = now - statsStart;
+        if (elapsed >= 1000) {
+            if (statsStart) {
+                sentPerSecond = windowSent * 1000LL / elapsed;
+                savedPerSecond = windowSkipped * 1000LL / elapsed;
+            }
+            packetsSent += windowSent;
+            packetsSkipped += windowSkipped;
+            windowSent = 0;
+            windowSkipped = 0;
+            statsStart = now;
+        }
+    }
+
+    if ((outputCount != msgCount) || (diff > 100)) {
         //failed to send all messages or it took more than 100ms to send them
         LogErr(VB_CHANNELOUT, "sendmmsg() failed for UDP output (output count: %d/%d   time: %u ms) with error: %d   %s\n",
-               outputCount, udpMsgs.size(), diff,
-               errno,
-               strerror(errno));
-        
-        //we'll ping the controllers and rebuild the valid message list, this could take time
-        
-        PingControllers();
+               outputCount, msgCount, diff,
+               sendErrno,
+               strerror(sendErrno));
+
+        if (changeDetection) {
+            //don't know what made it out, resend everything next frame
+            for (auto &t : udpTracking) {
+                t.lastSent = 0;
+            }
+        }
+
+        //let the health monitor find out which controllers went away, it
+        //will hand us new message lists if anything changed
+        RequestControllerProbe();
         return 0;
     }
-    outputCount = SendMessages(broadcastSocket, broadcastMsgs);
-    
+
+    // only mark the broadcast/sync messages as sent once they can go out
+    std::vector<struct mmsghdr> *sendBroadcastMsgs = &broadcastMsgs;
+    if (changeDetection) {
+        SelectChangedMessages(broadcastMsgs, broadcastTracking, changedBroadcastMsgs, now);
+        sendBroadcastMsgs = &changedBroadcastMsgs;
+    }
+    outputCount = SendMessages(broadcastSocket, *sendBroadcastMsgs);
+
     return 1;
 }
 
-void DoPingThread(UDPOutput *output) {
-    output->BackgroundThreadPing();
+int UDPOutput::SendShardedMessages(long long now, int &msgCount, int &sendErrno) {
+    for (auto s : sendShards) {
+        s->msgs.clear();
+    }
+
+    int pushNeeded = -1;
+    msgCount = 0;
+    for (int x = 0; x < udpMsgs.size(); x++) {
+        if (changeDetection && !MessageChanged(udpMsgs, udpTracking, x, now, pushNeeded)) {
+            continue;
+        }
+        sendShards[udpMsgShards[x]]->msgs.push_back(udpMsgs[x]);
+        msgCount++;
+    }
+
+    // hand the frame to the shard threads and wait for all of them
+    std::unique_lock<std::mutex> lck(shardMutex);
+    shardFrame++;
+    shardsBusy = sendShards.size();
+    shardStartCond.notify_all();
+    shardDoneCond.wait(lck, [this] { return shardsBusy == 0; });
+
+    int outputCount = 0;
+    sendErrno = 0;
+    for (auto s : sendShards) {
+        outputCount += s->outputCount;
+        if (s->outputCount != s->msgs.size()) {
+            sendErrno = s->sendErrno;
+        }
+    }
+    return outputCount;
 }
-void UDPOutput::BackgroundThreadPing() {
-    while (runDisabledPings) {
-        std::this_thread::sleep_for (std::chrono::seconds(10));
-        bool newValid = false;
-        
-        std::map<std::string, int> done;
-
-        std::unique_lock<std::mutex> lck (invalidOutputsMutex);
-        for (auto a : invalidOutputs) {
-            if (!a->valid) {
-                std::string host = a->ipAddress;
-                if (done[host] == 0) {
-                    int p = ping(host);
-                    if (p <= 0) {
-                        p = -1;
-                    }
-                    done[host] = p;
-                    if (p > 0) {
-                        LogWarn(VB_CHANNELOUT, "Can ping host %s, re-adding to outputs\n",
-                                host.c_str());
-                    }
-                }
-                a->valid = done[host] > 0;
-            }
-            if (a->valid) {
-                newValid = true;
-            }
+
+bool UDPOutput::OpenSendSocket(int &sock, const char *interface) {
+    char localAddress[16];
+    memset(localAddress, 0, sizeof(localAddress));
+    GetInterfaceAddress(interface, localAddress, NULL, NULL);
+
+    sock = socket(AF_INET, SOCK_DGRAM, 0);
+    if (sock < 0) {
+        LogErr(VB_CHANNELOUT, "Error opening datagram socket: %s\n", strerror(errno));
+        return false;
+    }
+
+    /* Disable loopback so I do not receive my own datagrams. */
+    char loopch = 0;
+    if (setsockopt(sock, IPPROTO_IP, IP_MULTICAST_LOOP, (char *)&loopch, sizeof(loopch)) < 0) {
+        LogErr(VB_CHANNELOUT, "Error setting IP_MULTICAST_LOOP error\n");
+        close(sock);
+        sock = -1;
+        return false;
+    }
+
+    if (strcmp(interface, getE131interface())) {
+        // make sure the data really leaves through the requested interface
+        if (setsockopt(sock, SOL_SOCKET, SO_BINDTODEVICE, interface, strlen(interface)) < 0) {
+            LogWarn(VB_CHANNELOUT, "Error binding UDP socket to %s: %s\n",
+                    interface, strerror(errno));
         }
-        
-        if (newValid) {
-            //at least one output became valid, let main thread know to rebuild the
-            //output message maps
-            rebuildOutputLists = true;
+    }
+
+    struct sockaddr_in addr;
+    memset(&addr, 0, sizeof(struct sockaddr_in));
+    addr.sin_family = AF_INET;
+    addr.sin_port = ntohs(0);
+    addr.sin_addr.s_addr = inet_addr(localAddress);
+    if (bind(sock, (struct sockaddr *) &addr, sizeof(struct sockaddr_in)) == -1) {
+        LogErr(VB_CHANNELOUT, "Error in bind:errno=%d, %s\n", errno, strerror(errno));
+    }
+
+    return true;
+}
+
+void UDPOutput::InitSendShards(int count) {
+    std::vector<std::string> cpus = split(getSetting("UDPSendThreadCPUs"), ',');
+    std::vector<std::string> interfaces = split(getSetting("UDPSendInterfaces"), ',');
+
+    for (int i = 0; i < count; i++) {
+        UDPSendShard *shard = new UDPSendShard(i);
+        if ((i < cpus.size()) && !cpus[i].empty()) {
+            shard->cpu = atoi(cpus[i].c_str());
+        }
+        if (i < interfaces.size()) {
+            shard->interface = interfaces[i];
+        }
+
+        const char *interface = shard->interface.empty() ? getE131interface() : shard->interface.c_str();
+        if (!OpenSendSocket(shard->sendSocket, interface)) {
+            LogErr(VB_CHANNELOUT, "Could not create UDP send shard %d, sending from a single socket\n", i);
+            delete shard;
+            StopSendShards();
+            return;
         }
+        sendShards.push_back(shard);
     }
-    std::thread *t = pingThread;
-    pingThread = nullptr;
-    delete t;
+
+    runShards = true;
+    for (auto shard : sendShards) {
+        shard->thread = new std::thread(&UDPOutput::RunSendShard, this, shard);
+    }
+    LogDebug(VB_CHANNELOUT, "Sending UDP output from %d sockets/threads\n", count);
 }
-void UDPOutput::PingControllers() {
-    LogDebug(VB_CHANNELOUT, "Pinging controllers to see what is online\n");
 
-    std::map<std::string, int> done;
+void UDPOutput::StopSendShards() {
+    {
+        std::unique_lock<std::mutex> lck(shardMutex);
+        runShards = false;
+    }
+    shardStartCond.notify_all();
+
+    for (auto shard : sendShards) {
+        if (shard->thread) {
+            shard->thread->join();
+            delete shard->thread;
+        }
+        if (shard->sendSocket >= 0) {
+            close(shard->sendSocket);
+        }
+        delete shard;
+    }
+    sendShards.clear();
+}
+
+void UDPOutput::RunSendShard(UDPSendShard *shard) {
+    if (shard->cpu >= 0) {
+        cpu_set_t cpuset;
+        CPU_ZERO(&cpuset);
+        CPU_SET(shard->cpu, &cpuset);
+        if (pthread_setaffinity_np(pthread_self(), sizeof(cpu_set_t), &cpuset)) {
+            LogWarn(VB_CHANNELOUT, "Could not pin UDP send shard %d to CPU %d\n",
+                    shard->index, shard->cpu);
+        }
+    }
+
+    unsigned int frame = 0;
+    std::unique_lock<std::mutex> lck(shardMutex);
+    while (true) {
+        shardStartCond.wait(lck, [this, &frame] { return !runShards || (shardFrame != frame); });
+        if (!runShards) {
+            break;
+        }
+        frame = shardFrame;
+        lck.unlock();
+
+        long long start = GetTime();
+        int outputCount = SendPacedMessages(shard->sendSocket, shard->msgs);
+        shard->sendErrno = errno;
+        shard->outputCount = std::max(outputCount, 0);
+
+        unsigned int sendTime = GetTime() - start;
+        shard->lastSendTime = sendTime;
+        if (sendTime > shard->maxSendTime) {
+            shard->maxSendTime = sendTime;
+        }
+        shard->totalSendTime += sendTime;
+        shard->frames++;
+
+        lck.lock();
+        if (--shardsBusy == 0) {
+            shardDoneCond.notify_one();
+        }
+    }
+}
+
+void UDPOutput::PartitionMessages(std::vector<struct mmsghdr> &msgs, std::vector<int> &shards) {
+    shards.clear();
+    if (sendShards.empty()) {
+        return;
+    }
+
+    // group the messages by destination so each controller's packets
+    // stay in order on a single socket
+    std::map<uint64_t, int> destIndex;
+    std::vector<long long> destBytes;
+    std::vector<int> msgDest(msgs.size());
+    for (int x = 0; x < msgs.size(); x++) {
+        struct sockaddr_in *addr = (struct sockaddr_in *)msgs[x].msg_hdr.msg_name;
+        uint64_t key = ((uint64_t)addr->sin_addr.s_addr << 16) | addr->sin_port;
+        auto it = destIndex.find(key);
+        if (it == destIndex.end()) {
+            it = destIndex.insert(std::make_pair(key, (int)destBytes.size())).first;
+            destBytes.push_back(0);
+        }
+        msgDest[x] = it->second;
+        destBytes[it->second] += msgs[x].msg_len;
+    }
+
+    // biggest destinations first, each onto the least loaded shard
+    std::vector<int> order(destBytes.size());
+    for (int d = 0; d < order.size(); d++) {
+        order[d] = d;
+    }
+    std::stable_sort(order.begin(), order.end(),
+                     [&destBytes](int a, int b) { return destBytes[a] > destBytes[b]; });
+
+    std::vector<long long> shardBytes(sendShards.size());
+    std::vector<int> destShard(destBytes.size());
+    for (auto d : order) {
+        int best = std::min_element(shardBytes.begin(), shardBytes.end()) - shardBytes.begin();
+        destShard[d] = best;
+        shardBytes[best] += destBytes[d];
+    }
+
+    shards.resize(msgs.size());
+    for (int x = 0; x < msgs.size(); x++) {
+        shards[x] = destShard[msgDest[x]];
+    }
+
+    for (auto shard : sendShards) {
+        long long size = shardBytes[shard->index] * UDP_SNDBUF_FRAMES;
+        size = std::max(size, (long long)UDP_MIN_SNDBUF);
+        size = std::min(size, (long long)UDP_MAX_SNDBUF);
+        if (size != shard->sendBufferSize) {
+            int bufSize = size;
+            // SO_SNDBUFFORCE can go past wmem_max, fall back if not allowed
+            if ((setsockopt(shard->sendSocket, SOL_SOCKET, SO_SNDBUFFORCE, &bufSize, sizeof(bufSize)) < 0)
+                && (setsockopt(shard->sendSocket, SOL_SOCKET, SO_SNDBUF, &bufSize, sizeof(bufSize)) < 0)) {
+                LogWarn(VB_CHANNELOUT, "Could not set send buffer of UDP shard %d to %d bytes\n",
+                        shard->index, bufSize);
+            }
+            shard->sendBufferSize = bufSize;
+        }
+        LogDebug(VB_CHANNELOUT, "UDP send shard %d: %lld bytes per frame, %d byte send buffer\n",
+                 shard->index, shardBytes[shard->index], (int)shard->sendBufferSize);
+    }
+}
+
+void UDPOutput::InitControllerHealth() {
+    std::set<std::string> hosts;
     for (auto o : outputs) {
         if (o->IsPingable() && o->active) {
-            std::string host = o->ipAddress;
-            if (done[host] == 0) {
-                int p = ping(host);
-                if (p <= 0) {
-                    p = -1;
+            hosts.insert(o->ipAddress);
+        }
+    }
+    if (hosts.empty()) {
+        return;
+    }
+    for (auto &h : hosts) {
+        controllers.push_back(ControllerHealth(h));
+    }
+
+    pingSocket = OpenPingSocket();
+    if (pingSocket < 0) {
+        LogWarn(VB_CHANNELOUT, "Could not open ICMP socket (%s), controller health monitoring disabled\n",
+                strerror(errno));
+        return;
+    }
+    // ping() uses getpid() as its id, keep our replies separate from its
+    pingId = (getpid() + 1) & 0xFFFF;
+}
+
+void UDPOutput::ProbeRound() {
+    for (auto &c : controllers) {
+        if (!c.resolved) {
+            if (inet_aton(c.host.c_str(), &c.address)) {
+                c.resolved = true;
+            } else {
+                struct hostent *hp = gethostbyname(c.host.c_str());
+                if (hp && (hp->h_addrtype == AF_INET) && (hp->h_length == sizeof(c.address))) {
+                    memcpy(&c.address, hp->h_addr, sizeof(c.address));
+                    c.resolved = true;
                 }
-                done[host] = p;
+            }
+        }
+    }
+
+    int outstanding = 0;
+    struct timespec now;
+    clock_gettime(CLOCK_MONOTONIC, &now);
+    for (auto &c : controllers) {
+        c.pending = false;
+        if (c.resolved) {
+            c.pendingSeq = ++pingSeq;
+            c.sentTime = now;
+            if (SendPing(pingSocket, c.address, pingId, c.pendingSeq) == 0) {
+                c.pending = true;
+                outstanding++;
+                continue;
+            }
+        }
+        std::unique_lock<std::mutex> lck(healthMutex);
+        c.sent++;
+        c.missed++;
+    }
 
-                if (p > 0 && !o->valid) {
-                    LogWarn(VB_CHANNELOUT, "Could ping host %s, re-adding to outputs\n",
-                            host.c_str());
+    long long deadline = now.tv_sec * 1000LL + now.tv_nsec / 1000000 + CONTROLLER_PROBE_TIMEOUT;
+    while (outstanding) {
+        clock_gettime(CLOCK_MONOTONIC, &now);
+        long long remaining = deadline - (now.tv_sec * 1000LL + now.tv_nsec / 1000000);
+        if (remaining <= 0) {
+            break;
+        }
+
+        struct pollfd pfd;
+        pfd.fd = pingSocket;
+        pfd.events = POLLIN;
+        pfd.revents = 0;
+        if (poll(&pfd, 1, remaining) <= 0) {
+            continue;
+        }
+
+        struct in_addr from;
+        uint16_t seq;
+        while (ReceivePingReply(pingSocket, pingId, from, seq) > 0) {
+            clock_gettime(CLOCK_MONOTONIC, &now);
+            for (auto &c : controllers) {
+                if (c.pending && (c.pendingSeq == seq) && (c.address.s_addr == from.s_addr)) {
+                    unsigned int rtt = (now.tv_sec - c.sentTime.tv_sec) * 1000000
+                                     + (now.tv_nsec - c.sentTime.tv_nsec) / 1000;
+                    std::unique_lock<std::mutex> lck(healthMutex);
+                    c.pending = false;
+                    c.missed = 0;
+                    c.sent++;
+                    c.received++;
+                    c.lastRTT = rtt;
+                    c.totalRTT += rtt;
+                    if ((c.received == 1) || (rtt < c.minRTT)) {
+                        c.minRTT = rtt;
+                    }
+                    if (rtt > c.maxRTT) {
+                        c.maxRTT = rtt;
+                    }
+                    outstanding--;
+                    break;
                 }
             }
         }
     }
+
+    std::unique_lock<std::mutex> lck(healthMutex);
+    for (auto &c : controllers) {
+        if (c.pending) {
+            c.pending = false;
+            c.sent++;
+            c.missed++;
+        }
+    }
+}
+
+bool UDPOutput::ProbeControllers() {
+    if ((pingSocket < 0) || controllers.empty()) {
+        return false;
+    }
+
+    ProbeRound();
+
+    bool retry = false;
+    for (auto &c : controllers) {
+        if (c.missed && (c.missed < CONTROLLER_PROBE_MAX_MISSED)) {
+            retry = true;
+        }
+    }
+    if (retry) {
+        //give a second chance before completely marking invalid
+        ProbeRound();
+    }
+
+    bool changed = false;
+    std::unique_lock<std::mutex> lck(healthMutex);
+    for (auto &c : controllers) {
+        bool reachable = c.missed < CONTROLLER_PROBE_MAX_MISSED;
+        if (reachable != c.reachable) {
+            if (reachable) {
+                LogWarn(VB_CHANNELOUT, "Could ping host %s, re-adding to outputs\n",
+                        c.host.c_str());
+            } else {
+                LogWarn(VB_CHANNELOUT, "Could not ping host %s, removing from output\n",
+                        c.host.c_str());
+            }
+            c.reachable = reachable;
+            changed = true;
+        }
+    }
+    return changed;
+}
+
+bool UDPOutput::UpdateOutputValidity() {
+    bool changed = false;
     for (auto o : outputs) {
         if (o->IsPingable() && o->active) {
-            std::string host = o->ipAddress;
-            int p = done[host];
-            if (p == -1) {
-                //give a second chance before completely marking invalid
-                p = ping(host);
-                if (p <= 0) {
-                    p = -2;
-                }
-                done[host] = p;
-                
-                if (p < 0 && o->valid) {
-                    LogWarn(VB_CHANNELOUT, "Could not ping host %s, removing from output\n",
-                            host.c_str());
-                } else if (p > 0 && !o->valid) {
-                    LogWarn(VB_CHANNELOUT, "Could ping host %s, re-adding to outputs\n",
-                            host.c_str());
+            for (auto &c : controllers) {
+                if (c.host == o->ipAddress) {
+                    if (o->valid != c.reachable) {
+                        o->valid = c.reachable;
+                        changed = true;
+                    }
+                    break;
                 }
             }
-            o->valid = p > 0;
         }
     }
-    RebuildOutputMessageLists();
+    return changed;
 }
+
+void UDPOutput::RunHealthMonitor() {
+    auto lastProbe = std::chrono::steady_clock::now();
+    while (runMonitor) {
+        std::unique_lock<std::mutex> lck(monitorMutex);
+        monitorCond.wait_until(lck, lastProbe + std::chrono::seconds(CONTROLLER_PROBE_INTERVAL),
+                               [this] { return !runMonitor || probeRequested; });
+        if (runMonitor && probeRequested) {
+            // don't flood the network if sends keep failing
+            monitorCond.wait_until(lck, lastProbe + std::chrono::seconds(1),
+                                   [this] { return !runMonitor; });
+        }
+        lck.unlock();
+        if (!runMonitor) {
+            break;
+        }
+
+        probeRequested = false;
+        if (ProbeControllers() && UpdateOutputValidity()) {
+            RebuildOutputMessageLists();
+        }
+        lastProbe = std::chrono::steady_clock::now();
+    }
+}
+
+void UDPOutput::RequestControllerProbe() {
+    if (monitorThread) {
+        {
+            std::unique_lock<std::mutex> lck(monitorMutex);
+            probeRequested = true;
+        }
+        monitorCond.notify_one();
+    }
+}
+
+void UDPOutput::StopHealthMonitor() {
+    if (monitorThread) {
+        {
+            std::unique_lock<std::mutex> lck(monitorMutex);
+            runMonitor = false;
+        }
+        monitorCond.notify_one();
+        monitorThread->join();
+        delete monitorThread;
+        monitorThread = nullptr;
+    }
+    if (pingSocket >= 0) {
+        close(pingSocket);
+        pingSocket = -1;
+    }
+}
+
 void UDPOutput::RebuildOutputMessageLists() {
     LogDebug(VB_CHANNELOUT, "Rebuilding message lists\n");
 
-    rebuildOutputLists = false;
-    udpMsgs.clear();
-    broadcastMsgs.clear();
+    std::vector<struct mmsghdr> newUdpMsgs;
+    std::vector<struct mmsghdr> newBroadcastMsgs;
+    std::vector<UDPMessageTracking> newUdpTracking;
+    std::vector<UDPMessageTracking> newBroadcastTracking;
     for (auto a : outputs) {
         if (a->valid && a->active) {
-            a->CreateMessages(udpMsgs);
-            a->CreateBroadcastMessages(broadcastMsgs);
+            int udpStart = newUdpMsgs.size();
+            int broadcastStart = newBroadcastMsgs.size();
+            a->CreateMessages(newUdpMsgs);
+            a->CreateBroadcastMessages(newBroadcastMsgs);
+            if (changeDetection) {
+                AddMessageTracking(newUdpMsgs, udpStart, a->HasPushMessage(), newUdpTracking);
+                AddMessageTracking(newBroadcastMsgs, broadcastStart, a->HasPushMessage(), newBroadcastTracking);
+            }
         }
     }
     //add any sync packets or whatever that are needed
     for (auto a : outputs) {
         if (a->valid && a->active) {
-            a->AddPostDataMessages(broadcastMsgs);
+            int broadcastStart = newBroadcastMsgs.size();
+            a->AddPostDataMessages(newBroadcastMsgs);
+            if (changeDetection) {
+                AddMessageTracking(newBroadcastMsgs, broadcastStart, false, newBroadcastTracking);
+            }
         }
     }
-    std::unique_lock<std::mutex> lck (invalidOutputsMutex);
-    invalidOutputs.clear();
-    for (auto a : outputs) {
-        if (!a->valid && a->active && a->IsPingable()) {
-            //active, but not valid, likely lost the ping
-            //save it so we can try re-enabling
-            invalidOutputs.push_back(a);
+
+    std::vector<int> newUdpMsgShards;
+    PartitionMessages(newUdpMsgs, newUdpMsgShards);
+
+    // the output thread swaps these in at the start of its next frame
+    std::unique_lock<std::mutex> lck(msgListMutex);
+    pendingUdpMsgs.swap(newUdpMsgs);
+    pendingBroadcastMsgs.swap(newBroadcastMsgs);
+    pendingUdpTracking.swap(newUdpTracking);
+    pendingBroadcastTracking.swap(newBroadcastTracking);
+    pendingUdpMsgShards.swap(newUdpMsgShards);
+    newMsgListsReady = true;
+}
+
+void UDPOutput::AddMessageTracking(std::vector<struct mmsghdr> &msgs, int start,
+                                   bool push, std::vector<UDPMessageTracking> &tracking) {
+    int last = msgs.size() - 1;
+    for (int x = start; x <= last; x++) {
+        UDPMessageTracking t;
+        // only messages with a header + channel data iovec are tracked,
+        // anything else (sync packets) is sent every frame
+        if (msgs[x].msg_hdr.msg_iovlen == 2) {
+            t.lastData.resize(msgs[x].msg_hdr.msg_iov[1].iov_len);
+        }
+        if (push && (x < last)) {
+            t.pushIndex = last;
+        }
+        tracking.push_back(t);
+    }
+}
+
+bool UDPOutput::MessageChanged(std::vector<struct mmsghdr> &msgs,
+                               std::vector<UDPMessageTracking> &tracking,
+                               int x, long long now, int &pushNeeded) {
+    UDPMessageTracking &t = tracking[x];
+    bool send = true;
+    if (!t.lastData.empty()) {
+        struct iovec &data = msgs[x].msg_hdr.msg_iov[1];
+        if (memcmp(&t.lastData[0], data.iov_base, t.lastData.size())) {
+            memcpy(&t.lastData[0], data.iov_base, t.lastData.size());
+            t.repeats = UDP_CHANGE_REPEATS;
+        } else if (t.repeats) {
+            t.repeats--;
+        } else if ((x != pushNeeded) && ((now - t.lastSent) < keepAliveInterval)) {
+            send = false;
+        }
+    }
+
+    if (send) {
+        t.lastSent = now;
+        if (t.pushIndex > x) {
+            pushNeeded = t.pushIndex;
+        }
+        windowSent++;
+    } else {
+        windowSkipped++;
+    }
+    return send;
+}
+
+void UDPOutput::SelectChangedMessages(std::vector<struct mmsghdr> &msgs,
+                                      std::vector<UDPMessageTracking> &tracking,
+                                      std::vector<struct mmsghdr> &changed,
+                                      long long now) {
+    changed.clear();
+
+    int pushNeeded = -1;
+    for (int x = 0; x < msgs.size(); x++) {
+        if (MessageChanged(msgs, tracking, x, now, pushNeeded)) {
+            changed.push_back(msgs[x]);
         }
     }
+}
+
+void UDPOutput::GetChangeDetectionStats(Json::Value &result) {
+    Json::Value stats;
+
+    stats["enabled"] = changeDetection;
+    stats["keepAliveMS"] = keepAliveInterval;
+    stats["packetsSent"] = (Json::UInt64)packetsSent;
+    stats["packetsSkipped"] = (Json::UInt64)packetsSkipped;
+    stats["sentPerSecond"] = (Json::UInt)sentPerSecond;
+    stats["savedPerSecond"] = (Json::UInt)savedPerSecond;
+
+    result["changeDetection"] = stats;
+}
+
+void UDPOutput::GetShardStats(Json::Value &result) {
+    Json::Value shards(Json::arrayValue);
+
+    for (auto shard : sendShards) {
+        Json::Value s;
+        s["index"] = shard->index;
+        s["cpu"] = shard->cpu;
+        s["interface"] = shard->interface.empty() ? getE131interface() : shard->interface;
+        s["sendBufferSize"] = (int)shard->sendBufferSize;
+        s["frames"] = (Json::UInt)shard->frames;
+        s["lastSendUS"] = (Json::UInt)shard->lastSendTime;
+        s["maxSendUS"] = (Json::UInt)shard->maxSendTime;
+        s["avgSendUS"] = shard->frames ? (Json::UInt)(shard->totalSendTime / shard->frames) : 0;
+        shards.append(s);
+    }
+
+    result["shards"] = shards;
+}
+
+std::string UDPOutput::GetShardTimingSummary() {
+    std::string summary;
+
+    for (auto shard : sendShards) {
+        summary += summary.empty() ? ", Shards: " : "/";
+        summary += std::to_string((unsigned int)shard->lastSendTime);
+    }
+    if (!summary.empty()) {
+        summary += "us";
+    }
+    return summary;
+}
 
-    if (!invalidOutputs.empty() && pingThread == nullptr) {
-        runDisabledPings = true;
-        pingThread = new std::thread(DoPingThread, this);
+void UDPOutput::GetControllerHealth(Json::Value &result) {
+    Json::Value list(Json::arrayValue);
+
+    std::unique_lock<std::mutex> lck(healthMutex);
+    for (auto &c : controllers) {
+        Json::Value h;
+        h["host"] = c.host;
+        h["reachable"] = c.reachable;
+        h["missed"] = c.missed;
+        h["sent"] = c.sent;
+        h["received"] = c.received;
+        h["lossPercent"] = c.sent ? (double)(c.sent - c.received) * 100.0 / c.sent : 0.0;
+        h["lastRTTUS"] = c.lastRTT;
+        h["minRTTUS"] = c.minRTT;
+        h["maxRTTUS"] = c.maxRTT;
+        h["avgRTTUS"] = c.received ? (Json::UInt)(c.totalRTT / c.received) : 0;
+        list.append(h);
     }
+
+    result["monitoring"] = monitorThread != nullptr;
+    result["controllers"] = list;
 }
 void UDPOutput::DumpConfig() {
     ChannelOutputBase::DumpConfig();
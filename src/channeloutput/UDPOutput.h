@@ -26,8 +26,11 @@
 #include <string>
 #include <thread>
 #include <mutex>
+#include <atomic>
+#include <condition_variable>
 
 #include <sys/socket.h>
+#include <netinet/in.h>
 #include <jsoncpp/json/json.h>
 
 #include "ChannelOutputBase.h"
@@ -52,6 +55,10 @@ public:
     virtual void AddPostDataMessages(std::vector<struct mmsghdr> &bMsgs) {}
 
     virtual void DumpConfig() = 0;
+
+    // true if the last message created must be sent whenever any of the
+    // others are (DDP only displays data once the PUSH packet arrives)
+    virtual bool HasPushMessage() { return false; }
     
     virtual void GetRequiredChannelRange(int &min, int & max) {
         min = startChannel - 1;
@@ -64,7 +71,64 @@ public:
     int           channelCount;
     int           type;
     std::string   ipAddress;
-    bool          valid;
+    std::atomic<bool> valid;
+};
+
+// Last sent copy of a message's channel data for change detection
+class UDPMessageTracking {
+public:
+    UDPMessageTracking() : lastSent(0), repeats(0), pushIndex(-1) {}
+
+    std::vector<unsigned char> lastData;
+    long long        lastSent;    // ms, 0 if never sent
+    int              repeats;     // unchanged frames still to send after a change
+    int              pushIndex;   // message that must go out with this one
+};
+
+// One socket and thread of a sharded UDP output
+class UDPSendShard {
+public:
+    UDPSendShard(int i);
+
+    int              index;
+    int              sendSocket;
+    int              cpu;         // -1 to run on any CPU
+    std::string      interface;   // empty to use the E1.31 interface
+    std::atomic<int> sendBufferSize;
+    std::thread     *thread;
+
+    // filled in by the output thread, sent by the shard thread
+    std::vector<struct mmsghdr> msgs;
+    int              outputCount;
+    int              sendErrno;
+
+    std::atomic<unsigned int> lastSendTime;   // us
+    std::atomic<unsigned int> maxSendTime;
+    std::atomic<unsigned long long> totalSendTime;
+    std::atomic<unsigned int> frames;
+};
+
+// Reachability and round trip stats for a single pingable controller
+class ControllerHealth {
+public:
+    ControllerHealth(const std::string &h);
+
+    std::string      host;
+    struct in_addr   address;
+    bool             resolved;
+    bool             reachable;
+    int              missed;      // consecutive probes without a reply
+
+    bool             pending;
+    uint16_t         pendingSeq;
+    struct timespec  sentTime;
+
+    unsigned int     sent;
+    unsigned int     received;
+    unsigned int     lastRTT;     // all RTT values are in microseconds
+    unsigned int     minRTT;
+    unsigned int     maxRTT;
+    unsigned long long totalRTT;
 };
 
 
@@ -82,14 +146,43 @@ public:
     
     void DumpConfig(void);
 
-    void BackgroundThreadPing();
+    void RunHealthMonitor();
+    void GetControllerHealth(Json::Value &result);
+    void GetChangeDetectionStats(Json::Value &result);
+    void GetShardStats(Json::Value &result);
+    std::string GetShardTimingSummary();
+    void RunSendShard(UDPSendShard *shard);
 
     virtual void GetRequiredChannelRange(int &min, int & max);
+    virtual void GetRequiredChannelRanges(const std::function<void(int, int)> &addRange);
+
+    static UDPOutput *INSTANCE;
 private:
+    int SendMessages(int socket, struct mmsghdr *msgs, int msgCount);
     int SendMessages(int socket, std::vector<struct mmsghdr> &sendmsgs);
+    int SendPacedMessages(int socket, std::vector<struct mmsghdr> &sendmsgs);
+    int SendShardedMessages(long long now, int &msgCount, int &sendErrno);
+    bool OpenSendSocket(int &sock, const char *interface);
+    void InitSendShards(int count);
+    void StopSendShards();
+    void PartitionMessages(std::vector<struct mmsghdr> &msgs, std::vector<int> &shards);
     bool InitNetwork();
-    void PingControllers();
+    void InitControllerHealth();
+    void ProbeRound();
+    bool ProbeControllers();
+    bool UpdateOutputValidity();
     void RebuildOutputMessageLists();
+    void RequestControllerProbe();
+    void StopHealthMonitor();
+    void AddMessageTracking(std::vector<struct mmsghdr> &msgs, int start,
+                            bool push, std::vector<UDPMessageTracking> &tracking);
+    bool MessageChanged(std::vector<struct mmsghdr> &msgs,
+                        std::vector<UDPMessageTracking> &tracking,
+                        int x, long long now, int &pushNeeded);
+    void SelectChangedMessages(std::vector<struct mmsghdr> &msgs,
+                               std::vector<UDPMessageTracking> &tracking,
+                               std::vector<struct mmsghdr> &changed,
+                               long long now);
     
     int sendSocket;
     int broadcastSocket;
@@ -98,12 +191,58 @@ private:
     std::list<UDPOutputData*> outputs;
     std::vector<struct mmsghdr> udpMsgs;
     std::vector<struct mmsghdr> broadcastMsgs;
+
+    // Percentage of the frame time to spread the data messages over, 0
+    // sends them all at once
+    int  pacing;
+
+    // Sharded sending, udpMsgs are split by destination across several
+    // sockets each sent from its own thread
+    std::vector<UDPSendShard*> sendShards;
+    std::vector<int> udpMsgShards;
+    std::mutex shardMutex;
+    std::condition_variable shardStartCond;
+    std::condition_variable shardDoneCond;
+    unsigned int shardFrame;
+    int  shardsBusy;
+    bool runShards;
+
+    // Change detection, only send universes whose data changed plus a
+    // periodic keep-alive
+    bool changeDetection;
+    int  keepAliveInterval;
+    std::vector<UDPMessageTracking> udpTracking;
+    std::vector<UDPMessageTracking> broadcastTracking;
+    std::vector<struct mmsghdr> changedUdpMsgs;
+    std::vector<struct mmsghdr> changedBroadcastMsgs;
+    long long statsStart;
+    unsigned int windowSent;
+    unsigned int windowSkipped;
+    std::atomic<unsigned long long> packetsSent;
+    std::atomic<unsigned long long> packetsSkipped;
+    std::atomic<unsigned int> sentPerSecond;
+    std::atomic<unsigned int> savedPerSecond;
     
-    std::thread *pingThread;
-    volatile bool runDisabledPings;
-    volatile bool rebuildOutputLists;
-    std::mutex invalidOutputsMutex;
-    std::list<UDPOutputData*> invalidOutputs;
+    // Lists built by the health monitor, swapped in by the output thread
+    std::mutex msgListMutex;
+    std::atomic<bool> newMsgListsReady;
+    std::vector<struct mmsghdr> pendingUdpMsgs;
+    std::vector<struct mmsghdr> pendingBroadcastMsgs;
+    std::vector<UDPMessageTracking> pendingUdpTracking;
+    std::vector<UDPMessageTracking> pendingBroadcastTracking;
+    std::vector<int> pendingUdpMsgShards;
+
+    int pingSocket;
+    uint16_t pingId;
+    uint16_t pingSeq;
+    std::vector<ControllerHealth> controllers;
+    std::mutex healthMutex;
+
+    std::thread *monitorThread;
+    std::atomic<bool> runMonitor;
+    std::atomic<bool> probeRequested;
+    std::mutex monitorMutex;
+    std::condition_variable monitorCond;
 };
 
 #endif
@@ -42,6 +42,7 @@ typedef struct usbRenardPrivData {
 	char filename[1024];
 	char *outputData;
 	int  fd;
+	SerialWriter *writer;
 	int  maxChannels;
 	int  speed;
 	char parm[4];
@@ -50,6 +51,9 @@ typedef struct usbRenardPrivData {
 // Assume clocks are accurate to 1%, so insert a pad byte every 100 bytes.
 #define PAD_DISTANCE 100
 
+// Sync and command bytes, the channel data and a pad byte per PAD_DISTANCE
+#define RENARD_FRAME_SIZE(c) (2 + (c) + ((c) + PAD_DISTANCE - 1) / PAD_DISTANCE)
+
 /////////////////////////////////////////////////////////////////////////////
 
 /*
@@ -153,16 +157,33 @@ int USBRenard_Open(const char *configStr, void **privDataPtr) {
 		return 0;
 	}
 	
-	privData->outputData = (char *)malloc(USBRenard_MaxChannels(privData));
+	int frameSize = RENARD_FRAME_SIZE(USBRenard_MaxChannels(privData));
+
+	privData->outputData = (char *)malloc(frameSize);
 	if (privData->outputData == NULL)
 	{
 		LogErr(VB_CHANNELOUT, "Error %d allocating channel memory: %s\n",
 			errno, strerror(errno));
 
+		SerialClose(privData->fd);
+		free(privData);
+		return 0;
+	}
+	bzero(privData->outputData, frameSize);
+
+	privData->writer = SerialWriterCreate(privData->fd, privData->speed,
+		privData->parm, frameSize,
+		SERIAL_WRITER_LATEST_FRAME | SERIAL_WRITER_RATE_LIMIT);
+	if (!privData->writer)
+	{
+		LogErr(VB_CHANNELOUT, "Error creating serial writer for %s\n",
+			privData->filename);
+
+		SerialClose(privData->fd);
+		free(privData->outputData);
 		free(privData);
 		return 0;
 	}
-	bzero(privData->outputData, privData->maxChannels);
 
 	USBRenard_Dump(privData);
 
@@ -180,6 +201,9 @@ int USBRenard_Close(void *data) {
 	USBRenardPrivData *privData = (USBRenardPrivData*)data;
 	USBRenard_Dump(privData);
 
+	SerialWriterDestroy(privData->writer);
+	privData->writer = NULL;
+
 	SerialClose(privData->fd);
 	privData->fd = -1;
 }
@@ -219,54 +243,53 @@ int USBRenard_SendData(void *data, const char *channelData, int channelCount)
 
 	USBRenardPrivData *privData = (USBRenardPrivData*)data;
 
-	if (channelCount <= privData->maxChannels) {
-		bzero(privData->outputData, privData->maxChannels);
-	} else {
+	if (channelCount > privData->maxChannels) {
 		LogErr(VB_CHANNELOUT,
-			"USBRenard_SendData() tried to send %d bytes when max is 4096\n",
-			channelCount);
+			"USBRenard_SendData() tried to send %d bytes when max is %d\n",
+			channelCount, privData->maxChannels);
 		return 0;
 	}
 
-	memcpy(privData->outputData, channelData, channelCount);
+	// Build the whole packet so the writer thread can send it in one go
+	char *dptr = privData->outputData;
+
+	// Start of packet
+	*dptr++ = '\x7E';
+	*dptr++ = '\x80';
 
 	// Act like "Renard (modified)" and don't output special codes.  There are
 	// 3 we need to worry about.
 	// 0x7D - Pad Byte    - map to 0x7C
 	// 0x7E - Sync Byte   - map to 0x7C
 	// 0x7F - Escape Byte - map to 0x80
-	char *dptr = privData->outputData;
 	int i = 0;
-	for( i = 0; i < privData->maxChannels; i++ ) {
-		if (*dptr == '\x7D')
-			*dptr = '\x7C';
-		else if (*dptr == '\x7E')
-			*dptr = '\x7C';
-		else if (*dptr == '\x7F')
-			*dptr = '\x80';
-
-		dptr++;
+	for (i = 0; i < channelCount; i++) {
+		// Assume clocks are accurate to 1%, so insert a pad byte every 100 bytes.
+		if (!(i % PAD_DISTANCE))
+			*dptr++ = '\x7D';
+
+		if (channelData[i] == '\x7D')
+			*dptr++ = '\x7C';
+		else if (channelData[i] == '\x7E')
+			*dptr++ = '\x7C';
+		else if (channelData[i] == '\x7F')
+			*dptr++ = '\x80';
+		else
+			*dptr++ = channelData[i];
 	}
 
-	// Send start of packet byte
-	write(privData->fd, "\x7E\x80", 2);
+	struct iovec iov;
+	iov.iov_base = privData->outputData;
+	iov.iov_len = dptr - privData->outputData;
 
-	dptr = privData->outputData;
-
-	// Assume clocks are accurate to 1%, so insert a pad byte every 100 bytes.
-	for ( i = 0; i*PAD_DISTANCE < channelCount; i++ )
+	if (SerialWriterQueue(privData->writer, &iov, 1) < 0)
 	{
-		// Send our pad byte
-		write(privData->fd, "\x7D", 1);
-
-		// Send Renard Data (Only send the channels we're given, not max)
-		if ( (i+1)*PAD_DISTANCE > channelCount )
-			write(privData->fd, dptr, (channelCount - (i * PAD_DISTANCE)));
-		else
-			write(privData->fd, dptr, PAD_DISTANCE);
-
-		dptr += PAD_DISTANCE;
+		LogErr(VB_CHANNELOUT, "Renard frame of %d bytes does not fit the serial writer buffer\n",
+			(int)iov.iov_len);
+		return 0;
 	}
+
+	return 1;
 }
 
 /*
@@ -29,7 +29,9 @@
 #include <stdlib.h>
 #include <string.h>
 
+#include <algorithm>
 #include <fstream>
+#include <functional>
 #include <sstream>
 #include <string>
 
@@ -111,6 +113,60 @@ const std::vector<std::pair<uint32_t, uint32_t>> GetOutputRanges() {
     return outputRanges;
 }
 
+// ranges closer together than this are read as one to avoid
+// lots of tiny reads/copies per frame
+#define OUTPUT_RANGE_MERGE_GAP 64
+
+/*
+ * Convert the inclusive min/max channel ranges needed by the outputs and
+ * processors into a sorted list of disjoint start/count ranges to read
+ */
+static void SetOutputRanges(std::vector<std::pair<int, int>> &ranges) {
+    outputRanges.clear();
+
+    std::vector<std::pair<int, int>> aligned;
+    for (auto &r : ranges) {
+        int m1 = std::max(r.first, 0);
+        int m2 = std::min(r.second, FPPD_MAX_CHANNELS - 1);
+        if (m2 < m1) {
+            continue;
+        }
+        // having the reads be aligned to intervals of 8 can help performance so
+        // we'll expand the range a bit to align things better
+        //round minimum down to interval of 8
+        if (m1 > 0) {
+            m1--;
+        }
+        m1 &= 0xFFFFFFF8;
+        m2 += 8;
+        m2 &= 0xFFFFFFF8;
+        m2 -= 1;
+        aligned.push_back(std::pair<int, int>(m1, std::min(m2, FPPD_MAX_CHANNELS - 1)));
+    }
+    if (aligned.empty()) {
+        aligned.push_back(std::pair<int, int>(0, 7));
+    }
+    std::sort(aligned.begin(), aligned.end());
+
+    int start = aligned[0].first;
+    int end = aligned[0].second;
+    for (auto &r : aligned) {
+        if (r.first > (end + OUTPUT_RANGE_MERGE_GAP)) {
+            outputRanges.push_back(std::pair<uint32_t, uint32_t>(start, end - start + 1));
+            start = r.first;
+        }
+        end = std::max(end, r.second);
+    }
+    outputRanges.push_back(std::pair<uint32_t, uint32_t>(start, end - start + 1));
+
+    uint32_t total = 0;
+    for (auto &r : outputRanges) {
+        LogInfo(VB_CHANNELOUT, "Determined range needed %d - %d\n", r.first, r.first + r.second - 1);
+        total += r.second;
+    }
+    LogInfo(VB_CHANNELOUT, "%d channels needed in %d range(s)\n", total, (int)outputRanges.size());
+}
+
 
 /////////////////////////////////////////////////////////////////////////////
 
@@ -259,8 +315,10 @@ int InitializeChannelOutputs(void) {
 
 	// Reset index so we can start populating the outputs array
 	i = 0;
-    int maximumNeededChannel = 0;
-    int minimumNeededChannel = FPPD_MAX_CHANNELS;
+    std::vector<std::pair<int, int>> neededRanges;
+    std::function<void(int, int)> addRange = [&neededRanges](int m1, int m2) {
+        neededRanges.push_back(std::pair<int, int>(m1, m2));
+    };
 
 	if (FPDOutput.isConfigured())
 	{
@@ -275,8 +333,7 @@ int InitializeChannelOutputs(void) {
             LogInfo(VB_CHANNELOUT, "FPD:  Determined range needed %d - %d\n",
                     m1, m2);
             
-            minimumNeededChannel = std::min(minimumNeededChannel, m1);
-            maximumNeededChannel = std::max(maximumNeededChannel, m2);
+            addRange(m1, m2);
 
 			i++;
 			LogDebug(VB_CHANNELOUT, "Configured FPD Channel Output\n");
@@ -479,20 +536,18 @@ int InitializeChannelOutputs(void) {
                     int m2 = m1 + channelOutputs[i].channelCount - 1;
                     LogInfo(VB_CHANNELOUT, "%s %d:  Determined range needed %d - %d\n",
                             type.c_str(), i, m1, m2);
-                    minimumNeededChannel = std::min(minimumNeededChannel, m1);
-                    maximumNeededChannel = std::max(maximumNeededChannel, m2);
+                    addRange(m1, m2);
 					i++;
 				} else if ((channelOutputs[i].output) &&
 						   (((!csvConfig[0]) && (channelOutputs[i].output->Init(outputs[c]))) ||
 							((csvConfig[0]) && (channelOutputs[i].output->Init(csvConfig))))) {
                                
                                
-                    int m1, m2;
-                    channelOutputs[i].output->GetRequiredChannelRange(m1, m2);
-                    minimumNeededChannel = std::min(minimumNeededChannel, m1);
-                    maximumNeededChannel = std::max(maximumNeededChannel, m2);
-                    LogInfo(VB_CHANNELOUT, "%s %d:  Determined range needed %d - %d\n",
-                            type.c_str(), i, minimumNeededChannel, maximumNeededChannel);
+                    channelOutputs[i].output->GetRequiredChannelRanges([&](int m1, int m2) {
+                        LogInfo(VB_CHANNELOUT, "%s %d:  Determined range needed %d - %d\n",
+                                type.c_str(), i, m1, m2);
+                        addRange(m1, m2);
+                    });
 
                     i++;
 				} else {
@@ -510,27 +565,9 @@ int InitializeChannelOutputs(void) {
 	LogDebug(VB_CHANNELOUT, "%d Channel Outputs configured\n", channelOutputCount);
 
 	LoadOutputProcessors();
-    int m1, m2;
-    outputProcessors.GetRequiredChannelRange(m1, m2);
-    minimumNeededChannel = std::min(minimumNeededChannel, m1);
-    maximumNeededChannel = std::max(maximumNeededChannel, m2);
-    if (maximumNeededChannel < minimumNeededChannel) {
-        maximumNeededChannel = minimumNeededChannel = 0;
-    }
-    // having the reads be aligned to intervals of 8 can help performance so
-    // we'll expand the range a bit to align things better
-    //round minimum down to interval of 8
-    if (minimumNeededChannel > 0) {
-        minimumNeededChannel--;
-    }
-    minimumNeededChannel &= 0xFFFFFFF8;
-    maximumNeededChannel += 8;
-    maximumNeededChannel &= 0xFFFFFFF8;
-    maximumNeededChannel -= 1;
-    
-    outputRanges.push_back(std::pair<uint32_t, uint32_t>(minimumNeededChannel, maximumNeededChannel - minimumNeededChannel + 1));
+    outputProcessors.GetRequiredChannelRanges(addRange);
 
-    LogInfo(VB_CHANNELOUT, "Determined range needed %d - %d\n", minimumNeededChannel, maximumNeededChannel);
+    SetOutputRanges(neededRanges);
 
 	return 1;
 }
@@ -553,7 +590,25 @@ void ResetChannelOutputFrameNumber(void) {
 
 
 int PrepareChannelData(char *channelData) {
+    ProcessChannelData(channelData);
+    PrepareChannelOutputData(channelData);
+    return 0;
+}
+
+/*
+ * Run the output processors (remaps, brightness, etc) on the channel data
+ */
+int ProcessChannelData(char *channelData) {
     outputProcessors.ProcessData((unsigned char *)channelData);
+    return 0;
+}
+
+/*
+ * Let the outputs prepare the data they will send.  Outputs may keep
+ * pointers into channelData so the same buffer must be passed to
+ * SendChannelData.
+ */
+int PrepareChannelOutputData(char *channelData) {
     FPPChannelOutputInstance *inst;
     for (int i = 0; i < channelOutputCount; i++) {
         inst = &channelOutputs[i];
@@ -564,6 +619,19 @@ int PrepareChannelData(char *channelData) {
     return 0;
 }
 
+/*
+ * Copy the channels needed by the outputs from one buffer to another
+ */
+void CopyOutputRanges(char *dest, const char *src) {
+    if (outputRanges.empty()) {
+        memcpy(dest, src, FPPD_MAX_CHANNELS);
+        return;
+    }
+    for (auto &r : outputRanges) {
+        memcpy(dest + r.first, src + r.first, r.second);
+    }
+}
+
 /*
  *
  */
@@ -62,6 +62,9 @@ extern OutputProcessors outputProcessors;
 
 int  InitializeChannelOutputs(void);
 int  PrepareChannelData(char *channelData);
+int  ProcessChannelData(char *channelData);
+int  PrepareChannelOutputData(char *channelData);
+void CopyOutputRanges(char *dest, const char *src);
 int  SendChannelData(const char *channelData);
 int  CloseChannelOutputs(void);
 void SetChannelOutputFrameNumber(int frameNumber);
@@ -25,14 +25,20 @@
 
 #include <errno.h>
 #include <pthread.h>
+#include <sched.h>
 #include <signal.h>
 #include <stdio.h>
+#include <stdlib.h>
 #include <string.h>
 #include <sys/time.h>
+#include <time.h>
 #include <unistd.h>
 
+#include <atomic>
+
 #include "channeloutput.h"
 #include "common.h"
+#include "e131bridge.h"
 #include "effects.h"
 #include "fppd.h"
 #include "log.h"
@@ -40,6 +46,8 @@
 #include "PixelOverlay.h"
 #include "Sequence.h"
 #include "settings.h"
+#include "UDPOutput.h"
+#include "channeloutputthread.h"
 
 /* used by external sync code */
 int   RefreshRate = 20;
@@ -59,6 +67,45 @@ int       ThreadIsRunning = 0;
 pthread_mutex_t  outputThreadLock;
 pthread_cond_t   outputThreadCond;
 
+/* frame timing stats, histogram bucket upper bounds in microseconds */
+#define OUTPUT_TIMING_BUCKETS 10
+static const int outputTimingBucketLimits[OUTPUT_TIMING_BUCKETS - 1] = {
+    50, 100, 250, 500, 1000, 2000, 5000, 10000, 20000
+};
+static std::atomic_uint outputJitterHistogram[OUTPUT_TIMING_BUCKETS];
+static std::atomic_uint outputOverrunHistogram[OUTPUT_TIMING_BUCKETS];
+static std::atomic_uint outputTimingFrames(0);
+static std::atomic_uint outputTimingOverruns(0);
+static std::atomic_uint outputTimingResyncs(0);
+static std::atomic_int  outputTimingMaxJitter(0);
+static std::atomic_int  outputTimingMaxOverrun(0);
+static int outputThreadPriority = 0;
+static int outputThreadCPU = -1;
+
+/* pipelined output, the next frame is read and processed into one buffer
+ * on a second thread while the current frame is prepped and sent from the
+ * other buffer */
+static int              pipelineRunning = 0;
+static pthread_t        pipelineThreadID;
+static pthread_mutex_t  pipelineLock = PTHREAD_MUTEX_INITIALIZER;
+static pthread_cond_t   pipelineCond = PTHREAD_COND_INITIALIZER;
+static bool             pipelineBusy = false;
+static int              pipelineMS = 0;
+static int              pipelineCur = 0; //buffer being sent
+static char            *pipelineData[2] = { nullptr, nullptr };
+
+
+/* remote frame clock, when the output loop started its latest frame so
+ * timestamped sync packets can be compared against it */
+#define CLOCK_SLEW_FRAMES   16  // spread a correction over a sync interval
+#define CLOCK_MAX_SLEW_DIV  10  // never change the frame time by more than 10%
+static pthread_mutex_t  frameClockLock = PTHREAD_MUTEX_INITIALIZER;
+static int              frameClockNumber = 0;
+static long long        frameClockTime = 0;
+static std::atomic_uint clockSyncs(0);
+static std::atomic_uint clockJumps(0);
+static std::atomic_int  clockErrorUS(0);
+static std::atomic_int  clockSlewUS(0);
 
 /* prototypes for functions below */
 void CalculateNewChannelOutputDelayForFrame(int expectedFramesSent);
@@ -70,6 +117,13 @@ int ChannelOutputThreadIsRunning(void) {
 	return ThreadIsRunning;
 }
 
+/*
+ * Nominal time between output frames in microseconds
+ */
+int GetChannelOutputFrameTime(void) {
+	return DefaultLightDelay;
+}
+
 /*
  *
  */
@@ -93,6 +147,243 @@ void ForceChannelOutputNow(void) {
 
 
 
+/*
+ * Microsecond helpers for the CLOCK_MONOTONIC frame deadlines
+ */
+static void AddMicrosToTimespec(struct timespec &ts, long long us)
+{
+	ts.tv_sec += us / 1000000;
+	ts.tv_nsec += (us % 1000000) * 1000;
+	if (ts.tv_nsec >= 1000000000) {
+		ts.tv_sec += 1;
+		ts.tv_nsec -= 1000000000;
+	}
+}
+
+static long long MicrosBetween(const struct timespec &from, const struct timespec &to)
+{
+	return (to.tv_sec - from.tv_sec) * 1000000LL + (to.tv_nsec - from.tv_nsec) / 1000;
+}
+
+static void AddTimingSample(std::atomic_uint *histogram, std::atomic_int &maxValue, int us)
+{
+	int b = 0;
+	while ((b < (OUTPUT_TIMING_BUCKETS - 1)) && (us >= outputTimingBucketLimits[b]))
+		b++;
+	histogram[b]++;
+	if (us > maxValue)
+		maxValue = us;
+}
+
+static void ResetChannelOutputTimingStats(void)
+{
+	for (int b = 0; b < OUTPUT_TIMING_BUCKETS; b++) {
+		outputJitterHistogram[b] = 0;
+		outputOverrunHistogram[b] = 0;
+	}
+	outputTimingFrames = 0;
+	outputTimingOverruns = 0;
+	outputTimingResyncs = 0;
+	outputTimingMaxJitter = 0;
+	outputTimingMaxOverrun = 0;
+}
+
+/*
+ * Apply the optional realtime priority and CPU affinity settings to
+ * the calling (output) thread
+ */
+static void SetupChannelOutputThreadScheduling(void)
+{
+	outputThreadPriority = getSettingInt("outputThreadPriority");
+	if (outputThreadPriority > 0) {
+		struct sched_param param;
+		memset(&param, 0, sizeof(param));
+		param.sched_priority = std::min(outputThreadPriority, sched_get_priority_max(SCHED_FIFO));
+		int rc = pthread_setschedparam(pthread_self(), SCHED_FIFO, &param);
+		if (rc) {
+			LogWarn(VB_CHANNELOUT, "Could not set output thread to SCHED_FIFO priority %d: %s\n",
+				param.sched_priority, strerror(rc));
+			outputThreadPriority = 0;
+		} else {
+			LogDebug(VB_CHANNELOUT, "Output thread using SCHED_FIFO priority %d\n", param.sched_priority);
+		}
+	}
+
+	// blank means no affinity, CPU 0 is valid so don't use getSettingInt
+	const char *cpu = getSetting("outputThreadCPU");
+	outputThreadCPU = cpu[0] ? atoi(cpu) : -1;
+	if (outputThreadCPU >= 0) {
+		cpu_set_t cpuset;
+		CPU_ZERO(&cpuset);
+		CPU_SET(outputThreadCPU, &cpuset);
+		int rc = pthread_setaffinity_np(pthread_self(), sizeof(cpuset), &cpuset);
+		if (rc) {
+			LogWarn(VB_CHANNELOUT, "Could not pin output thread to CPU %d: %s\n",
+				outputThreadCPU, strerror(rc));
+			outputThreadCPU = -1;
+		} else {
+			LogDebug(VB_CHANNELOUT, "Output thread pinned to CPU %d\n", outputThreadCPU);
+		}
+	}
+}
+
+/*
+ * Background thread that processes the next frame while the output
+ * thread sends the current one
+ */
+static void *RunChannelOutputPipelineThread(void *data)
+{
+	(void)data;
+
+	// the scheduling priority is inherited from the output thread, but
+	// keep off of the output thread's CPU if it has been pinned
+	int cpus = sysconf(_SC_NPROCESSORS_ONLN);
+	if ((outputThreadCPU >= 0) && (cpus > 1)) {
+		cpu_set_t cpuset;
+		CPU_ZERO(&cpuset);
+		for (int c = 0; c < cpus; c++) {
+			if (c != outputThreadCPU)
+				CPU_SET(c, &cpuset);
+		}
+		pthread_setaffinity_np(pthread_self(), sizeof(cpuset), &cpuset);
+	}
+
+	pthread_mutex_lock(&pipelineLock);
+	while (pipelineRunning) {
+		if (!pipelineBusy) {
+			pthread_cond_wait(&pipelineCond, &pipelineLock);
+			continue;
+		}
+		int ms = pipelineMS;
+		char *dest = pipelineData[pipelineCur ^ 1];
+		pthread_mutex_unlock(&pipelineLock);
+
+		sequence->ProcessSequenceData(ms, 1, false);
+		CopyOutputRanges(dest, sequence->m_seqData);
+
+		pthread_mutex_lock(&pipelineLock);
+		pipelineBusy = false;
+		pthread_cond_broadcast(&pipelineCond);
+	}
+	pthread_mutex_unlock(&pipelineLock);
+
+	return NULL;
+}
+
+/*
+ * Hand the frame just read into the sequence data to the pipeline thread
+ */
+static void StartPipelineFrame(int ms)
+{
+	pthread_mutex_lock(&pipelineLock);
+	pipelineMS = ms;
+	pipelineBusy = true;
+	pthread_cond_broadcast(&pipelineCond);
+	pthread_mutex_unlock(&pipelineLock);
+}
+
+/*
+ * Wait for the pipeline thread to finish the frame it is working on and
+ * make it the frame to send
+ */
+static void WaitForPipelineFrame(void)
+{
+	pthread_mutex_lock(&pipelineLock);
+	if (pipelineBusy) {
+		while (pipelineBusy)
+			pthread_cond_wait(&pipelineCond, &pipelineLock);
+		pipelineCur ^= 1;
+	}
+	pthread_mutex_unlock(&pipelineLock);
+}
+
+static int StartChannelOutputPipeline(void)
+{
+	if ((getFPPmode() == BRIDGE_MODE) || !getSettingInt("outputPipeline"))
+		return 0;
+
+	if (!pipelineData[0]) {
+		pipelineData[0] = (char*)calloc(1, FPPD_MAX_CHANNELS);
+		pipelineData[1] = (char*)calloc(1, FPPD_MAX_CHANNELS);
+	}
+	pipelineCur = 0;
+	pipelineBusy = false;
+	pipelineRunning = 1;
+	if (pthread_create(&pipelineThreadID, NULL, &RunChannelOutputPipelineThread, NULL)) {
+		LogErr(VB_CHANNELOUT, "ERROR creating channel output pipeline thread, using serial output\n");
+		pipelineRunning = 0;
+		return 0;
+	}
+
+	LogDebug(VB_CHANNELOUT, "Using pipelined channel output\n");
+	return 1;
+}
+
+static void StopChannelOutputPipeline(void)
+{
+	WaitForPipelineFrame();
+
+	pthread_mutex_lock(&pipelineLock);
+	pipelineRunning = 0;
+	pthread_cond_broadcast(&pipelineCond);
+	pthread_mutex_unlock(&pipelineLock);
+
+	pthread_join(pipelineThreadID, NULL);
+}
+
+/*
+ * Report the output frame timing stats
+ */
+void GetChannelOutputTimingStats(Json::Value &result)
+{
+	Json::Value timing;
+	Json::Value jitter(Json::arrayValue);
+	Json::Value overrun(Json::arrayValue);
+
+	for (int b = 0; b < OUTPUT_TIMING_BUCKETS; b++) {
+		Json::Value jb;
+		Json::Value ob;
+		if (b < (OUTPUT_TIMING_BUCKETS - 1)) {
+			jb["lessThanUS"] = outputTimingBucketLimits[b];
+			ob["lessThanUS"] = outputTimingBucketLimits[b];
+		} else {
+			jb["lessThanUS"] = -1;
+			ob["lessThanUS"] = -1;
+		}
+		jb["count"] = (Json::UInt)outputJitterHistogram[b];
+		ob["count"] = (Json::UInt)outputOverrunHistogram[b];
+		jitter.append(jb);
+		overrun.append(ob);
+	}
+
+	timing["running"] = ChannelOutputThreadIsRunning() ? true : false;
+	timing["frameTimeUS"] = DefaultLightDelay;
+	timing["currentFrameTimeUS"] = LightDelay;
+	timing["priority"] = outputThreadPriority;
+	timing["cpu"] = outputThreadCPU;
+	timing["pipelined"] = pipelineRunning ? true : false;
+	timing["frames"] = (Json::UInt)outputTimingFrames;
+	timing["overruns"] = (Json::UInt)outputTimingOverruns;
+	timing["resyncs"] = (Json::UInt)outputTimingResyncs;
+	timing["maxJitterUS"] = (int)outputTimingMaxJitter;
+	timing["maxOverrunUS"] = (int)outputTimingMaxOverrun;
+	timing["jitter"] = jitter;
+	timing["overrun"] = overrun;
+
+	if (getFPPmode() == REMOTE_MODE) {
+		Json::Value clock;
+		if (multiSync)
+			multiSync->GetClockStats(clock);
+		clock["timedSyncs"] = (Json::UInt)clockSyncs;
+		clock["frameJumps"] = (Json::UInt)clockJumps;
+		clock["lastErrorUS"] = (int)clockErrorUS;
+		clock["slewUS"] = (int)clockSlewUS;
+		timing["masterClock"] = clock;
+	}
+
+	result["outputTiming"] = timing;
+}
+
 /*
  * Main loop in channel output thread
  */
@@ -105,13 +396,19 @@ void *RunChannelOutputThread(void *data)
 	long long sendTime;
 	long long readTime;
     long long processTime;
+	long long waitTime = 0;
 	int onceMore = 0;
-	struct timespec ts;
-    struct timeval tv;
+	int pipelined = 0;
+	struct timespec nextFrameTime;
+	struct timespec now;
 	int syncFrameCounter = 99; //set high so first frame sends sync immediately
 
 	LogDebug(VB_CHANNELOUT, "RunChannelOutputThread() starting\n");
 
+	ResetChannelOutputTimingStats();
+	SetupChannelOutputThreadScheduling();
+	pipelined = StartChannelOutputPipeline();
+
 	ThreadIsRunning = 1;
     StartOutputThreads();
 
@@ -136,9 +433,31 @@ void *RunChannelOutputThread(void *data)
 
     pthread_mutex_lock(&outputThreadLock);
 
+	// Frames are scheduled against absolute CLOCK_MONOTONIC deadlines so a
+	// late frame doesn't push back every following frame and wall clock
+	// changes (NTP, etc.) don't affect the output timing
+	clock_gettime(CLOCK_MONOTONIC, &nextFrameTime);
+
+	if (pipelined) {
+		if (!sequence->isDataProcessed())
+			sequence->ProcessSequenceData(1000.0 * channelOutputFrame / RefreshRate, 1, false);
+		CopyOutputRanges(pipelineData[pipelineCur], sequence->m_seqData);
+	}
+
 	while (RunThread) {
 		startTime = GetTime();
 
+		if (pipelined) {
+			WaitForPipelineFrame();
+			waitTime = GetTime();
+		}
+
+		// masters stamp their sync packets at this point in the loop
+		pthread_mutex_lock(&frameClockLock);
+		frameClockNumber = channelOutputFrame;
+		frameClockTime = GetMonotonicTime();
+		pthread_mutex_unlock(&frameClockLock);
+
 		if ((getFPPmode() == MASTER_MODE) &&
 			(sequence->IsSequenceRunning())) {
             // send sync every 16 frames except for every 4 frames for first 32
@@ -156,10 +475,18 @@ void *RunChannelOutputThread(void *data)
 		}
 
         if (OutputFrames) {
-            if (!sequence->isDataProcessed()) {
+            if (getFPPmode() == BRIDGE_MODE) {
+                // Pick up the newest complete frame from the bridge receive
+                // thread and process it right before sending so bridged
+                // data doesn't sit in the buffer for a frame
+                Bridge_LatchReceivedData(sequence->m_seqData);
+                sequence->ProcessSequenceData(1000.0 * channelOutputFrame / RefreshRate, 1);
+            } else if (!sequence->isDataProcessed()) {
                 //first time through or immediately after sequence load, the data might not be
                 //processed yet, need to do it
-                sequence->ProcessSequenceData(1000.0 * channelOutputFrame / RefreshRate, 1);
+                sequence->ProcessSequenceData(1000.0 * channelOutputFrame / RefreshRate, 1, !pipelined);
+                if (pipelined)
+                    CopyOutputRanges(pipelineData[pipelineCur], sequence->m_seqData);
             }
             if (getFPPmode() == REMOTE_MODE && !IsEffectRunning()) {
                 // Sleep about 1 seconds waiting for the master
@@ -169,23 +496,53 @@ void *RunChannelOutputThread(void *data)
                     loops++;
                 }
             }
-			sequence->SendSequenceData();
+            if (!pipelined)
+                sequence->SendSequenceData();
         }
 
-		sendTime = GetTime();
-
-        if (getFPPmode() != BRIDGE_MODE) {
+        if (pipelined) {
+            // Read the next frame and start processing it in the background
+            // before sending this one.  The send hasn't incremented the frame
+            // counter yet so account for that when skipping.
+            long long readStart = GetTime();
             if (FrameSkip) {
-                sequence->SeekSequenceFile(channelOutputFrame + FrameSkip + 1);
+                sequence->SeekSequenceFile(channelOutputFrame + FrameSkip + 2);
                 FrameSkip = 0;
             }
-            sequence->ReadSequenceData();
-        }
+            int frame = sequence->ReadSequenceData();
+            int nextFrame = (frame >= 0) ? frame : channelOutputFrame + (OutputFrames ? 1 : 0);
+            StartPipelineFrame(1000.0 * nextFrame / RefreshRate);
+            long long readEnd = GetTime();
+
+            if (OutputFrames) {
+                PrepareChannelOutputData(pipelineData[pipelineCur]);
+                SendChannelData(pipelineData[pipelineCur]);
+                if (frame >= 0)
+                    SetChannelOutputFrameNumber(frame);
+            }
+
+            // express the stage times in the same order as the serial loop,
+            // Process is the time spent waiting on the pipeline thread
+            sendTime = startTime + (GetTime() - readEnd) + (readStart - waitTime);
+            readTime = sendTime + (readEnd - readStart);
+            processTime = readTime + (waitTime - startTime);
+        } else {
+            sendTime = GetTime();
+
+            if (getFPPmode() != BRIDGE_MODE) {
+                if (FrameSkip) {
+                    sequence->SeekSequenceFile(channelOutputFrame + FrameSkip + 1);
+                    FrameSkip = 0;
+                }
+                sequence->ReadSequenceData();
+            }
 
-        readTime = GetTime();
-		sequence->ProcessSequenceData(1000.0 * channelOutputFrame / RefreshRate, 1);
+            readTime = GetTime();
+            if (getFPPmode() != BRIDGE_MODE)
+                sequence->ProcessSequenceData(1000.0 * channelOutputFrame / RefreshRate, 1);
 
-		processTime = GetTime();
+            processTime = GetTime();
+        }
 
 		if ((sequence->IsSequenceRunning()) ||
 			(IsEffectRunning()) ||
@@ -204,13 +561,16 @@ void *RunChannelOutputThread(void *data)
                 if (startTime > (lastStatTime + 1000000)) {
                     lastStatTime = startTime;
                 }
+				std::string shardTimes;
+				if (UDPOutput::INSTANCE)
+					shardTimes = UDPOutput::INSTANCE->GetShardTimingSummary();
 				LogDebug(VB_CHANNELOUT,
-                         "Output Thread: Loop: %dus, Send: %lldus, Read: %lldus, Process: %lldus, Sleep: %dus, FrameNum: %ld\n",
+                         "Output Thread: Loop: %dus, Send: %lldus, Read: %lldus, Process: %lldus, Sleep: %dus, FrameNum: %ld%s\n",
 					LightDelay,
                     sendTime - startTime,
 					readTime - sendTime,
                     processTime - readTime, 
-                    sleepTime, channelOutputFrame);
+                    sleepTime, channelOutputFrame, shardTimes.c_str());
 			}
 		}
 		else
@@ -223,26 +583,35 @@ void *RunChannelOutputThread(void *data)
 				RunThread = 0;
 		}
 
-		// Calculate how long we need to nanosleep()
-		long dt = (LightDelay - (GetTime() - startTime)) * 1000;
-		if (dt > 0)
-		{
-			gettimeofday(&tv, NULL);
-			ts.tv_sec = tv.tv_sec;
-			ts.tv_nsec = tv.tv_usec * 1000 + dt;
-
-			if (ts.tv_nsec >= 1000000000)
-			{
-				ts.tv_sec  += 1;
-				ts.tv_nsec -= 1000000000;
-			}
-
-			if (pthread_cond_timedwait(&outputThreadCond, &outputThreadLock, &ts) != ETIMEDOUT) {
-				LogDebug(VB_CHANNELOUT, "Forced output\n");
+		// Wait for the deadline of the next frame
+		AddMicrosToTimespec(nextFrameTime, LightDelay);
+		clock_gettime(CLOCK_MONOTONIC, &now);
+		outputTimingFrames++;
+
+		long long late = MicrosBetween(nextFrameTime, now);
+		if (late >= 0) {
+			// This frame took longer than the frame time.  Send the next one
+			// right away to catch up, unless we're more than a frame behind,
+			// then start the schedule over rather than bursting frames out.
+			outputTimingOverruns++;
+			AddTimingSample(outputOverrunHistogram, outputTimingMaxOverrun, late);
+			if (late > LightDelay) {
+				outputTimingResyncs++;
+				nextFrameTime = now;
 			}
-        }
+		} else if (pthread_cond_timedwait(&outputThreadCond, &outputThreadLock, &nextFrameTime) != ETIMEDOUT) {
+			LogDebug(VB_CHANNELOUT, "Forced output\n");
+			clock_gettime(CLOCK_MONOTONIC, &nextFrameTime);
+		} else {
+			clock_gettime(CLOCK_MONOTONIC, &now);
+			late = MicrosBetween(nextFrameTime, now);
+			AddTimingSample(outputJitterHistogram, outputTimingMaxJitter, late > 0 ? late : 0);
+		}
 	}
 
+	if (pipelined)
+		StopChannelOutputPipeline();
+
 	StopOutputThreads();
     pthread_mutex_unlock(&outputThreadLock);
 
@@ -270,7 +639,13 @@ int StartChannelOutputThread(void)
 	LogDebug(VB_CHANNELOUT, "StartChannelOutputThread()\n");
     
     pthread_mutex_init(&outputThreadLock, NULL);
-    pthread_cond_init(&outputThreadCond, NULL);
+
+    // the output thread waits on CLOCK_MONOTONIC deadlines
+    pthread_condattr_t condAttr;
+    pthread_condattr_init(&condAttr);
+    pthread_condattr_setclock(&condAttr, CLOCK_MONOTONIC);
+    pthread_cond_init(&outputThreadCond, &condAttr);
+    pthread_condattr_destroy(&condAttr);
 
 	int E131BridgingInterval = getSettingInt("E131BridgingInterval");
 
@@ -372,6 +747,63 @@ void UpdateMasterPosition(int frameNumber)
 	CalculateNewChannelOutputDelayForFrame(frameNumber);
 }
 
+/*
+ * Update the master position from a timestamped sync packet.  frameTime
+ * is when the master started frameNumber, converted to our monotonic
+ * clock.  Small errors are slewed out over the next sync interval by
+ * adjusting the frame time, only large ones skip or hold frames.
+ */
+void UpdateMasterPositionAtTime(int frameNumber, long long frameTime)
+{
+	MasterFramesPlayed = frameNumber;
+
+	pthread_mutex_lock(&frameClockLock);
+	int localFrame = frameClockNumber;
+	long long localTime = frameClockTime;
+	pthread_mutex_unlock(&frameClockLock);
+
+	if (!localTime || (DefaultLightDelay <= 0)) {
+		CalculateNewChannelOutputDelayForFrame(frameNumber);
+		return;
+	}
+
+	// when we started, or will start, the master's frame.  Positive
+	// means we are behind the master.
+	long long ourTime = localTime + (long long)(frameNumber - localFrame) * DefaultLightDelay;
+	long long error = ourTime - frameTime;
+	clockSyncs++;
+	clockErrorUS = error;
+
+	if ((error > 500000) || (error < -500000)) {
+		// too far off to slew, jump to where the master is now
+		long long now = GetMonotonicTime();
+		int expectedFrame = frameNumber + (now - frameTime) / DefaultLightDelay;
+		clockJumps++;
+		clockSlewUS = 0;
+		CalculateNewChannelOutputDelayForFrame(expectedFrame);
+		return;
+	}
+
+	long long offset;
+	double driftPPM = 0.0;
+	if (multiSync)
+		multiSync->GetMasterClockOffset(GetMonotonicTime(), offset, driftPPM);
+
+	// frame time in our clock for the master's rate, less the correction
+	long long slew = (long long)(DefaultLightDelay * driftPPM / 1000000.0) + (error / CLOCK_SLEW_FRAMES);
+	long long maxSlew = DefaultLightDelay / CLOCK_MAX_SLEW_DIV;
+	if (slew > maxSlew)
+		slew = maxSlew;
+	else if (slew < -maxSlew)
+		slew = -maxSlew;
+
+	clockSlewUS = slew;
+	LightDelay = DefaultLightDelay - slew;
+
+	LogExcess(VB_CHANNELOUT, "Master frame %d, local frame %d, error %lldus, drift %.1fppm, LightDelay %d\n",
+		frameNumber, localFrame, error, driftPPM, LightDelay);
+}
+
 /*
  * Calculate the new sync offset based on the current position reported
  * by the media player.
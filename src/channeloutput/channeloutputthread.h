@@ -26,6 +26,8 @@
 #ifndef _CHANNELOUTPUTTHREAD_H
 #define _CHANNELOUTPUTTHREAD_H
 
+#include <jsoncpp/json/json.h>
+
 void DisableChannelOutput(void);
 void EnableChannelOutput(void);
 void InitChannelOutputSyncVars(void);
@@ -33,11 +35,14 @@ void DestroyChannelOutputSyncVars(void);
 void ForceChannelOutputNow(void);
 
 int  ChannelOutputThreadIsRunning(void);
+int  GetChannelOutputFrameTime(void);
 void SetChannelOutputRefreshRate(int rate);
 int  StartChannelOutputThread(void);
 int  StopChannelOutputThread(void);
 void ResetMasterPosition(void);
 void UpdateMasterPosition(int frameNumber);
+void UpdateMasterPositionAtTime(int frameNumber, long long frameTime);
 void CalculateNewChannelOutputDelay(float mediaPosition);
+void GetChannelOutputTimingStats(Json::Value &result);
 
 #endif
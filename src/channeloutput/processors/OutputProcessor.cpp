@@ -115,6 +115,12 @@ void OutputProcessors::GetRequiredChannelRange(int &min, int & max) {
         max = std::max(max, m2);
     }
 }
+void OutputProcessors::GetRequiredChannelRanges(const std::function<void(int, int)> &addRange) {
+    std::lock_guard<std::mutex> lock(processorsLock);
+    for (OutputProcessor *a : processors) {
+        a->GetRequiredChannelRanges(addRange);
+    }
+}
 
 
 OutputProcessor::OutputProcessor() : description(), active(true) {
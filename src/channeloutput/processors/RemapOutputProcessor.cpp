@@ -55,6 +55,10 @@ void RemapOutputProcessor::GetRequiredChannelRange(int &min, int &max) {
     max = std::max(sourceChannel, destChannel);
     max += loops * count - 1;
 }
+void RemapOutputProcessor::GetRequiredChannelRanges(const std::function<void(int, int)> &addRange) {
+    addRange(sourceChannel, sourceChannel + count - 1);
+    addRange(destChannel, destChannel + loops * count - 1);
+}
 
 void RemapOutputProcessor::ProcessData(unsigned char *channelData) const {
     switch (reverse) {
@@ -37,6 +37,7 @@ public:
     int getReverse() const { return reverse;}
     
     virtual void GetRequiredChannelRange(int &min, int &max);
+    virtual void GetRequiredChannelRanges(const std::function<void(int, int)> &addRange);
 
 protected:
     int sourceChannel;
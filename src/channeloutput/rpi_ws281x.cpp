@@ -180,24 +180,26 @@ void RPIWS281xOutput::GetRequiredChannelRange(int &min, int & max) {
 }
 void RPIWS281xOutput::PrepData(unsigned char *channelData)
 {
-	unsigned char *c = channelData;
 	unsigned int r = 0;
 	unsigned int g = 0;
 	unsigned int b = 0;
 
 	PixelString *ps = NULL;
-	int inCh = 0;
 
 	for (int s = 0; s < m_strings.size(); s++)
 	{
 		ps = m_strings[s];
-		inCh = 0;
+		if (m_remapBuffer.size() < ps->m_outputChannels)
+			m_remapBuffer.resize(ps->m_outputChannels);
 
-		for (int p = 0, pix = 0; p < ps->m_outputChannels; pix++)
+		uint8_t *c = m_remapBuffer.data();
+		ps->Remap(channelData, c);
+
+		for (int p = 0, pix = 0; (p + 2) < ps->m_outputChannels; pix++)
 		{
-			r = ps->m_brightnessMaps[p++][channelData[ps->m_outputMap[inCh++]]];
-			g = ps->m_brightnessMaps[p++][channelData[ps->m_outputMap[inCh++]]];
-			b = ps->m_brightnessMaps[p++][channelData[ps->m_outputMap[inCh++]]];
+			r = c[p++];
+			g = c[p++];
+			b = c[p++];
 
 			ledstring[m_ledstringNumber].channel[s].leds[pix] =
 				(r << 16) | (g <<  8) | (b);
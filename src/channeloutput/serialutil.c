@@ -25,13 +25,18 @@
 
 #include <errno.h>
 #include <fcntl.h>
+#include <poll.h>
+#include <pthread.h>
+#include <stdlib.h>
 #include <sys/ioctl.h>
 #include <string.h>
 #include <termios.h>
 #include <unistd.h>
 #include <linux/serial.h>
 
+#include "common.h"
 #include "log.h"
+#include "serialutil.h"
 
 // The following is in asm-generic/termios.h, but including that in a C++
 // program causes errors.  The Qt developers worked around this by including
@@ -249,3 +254,249 @@ int SerialResetRTS(int fd)
 	return 0;
 }
 
+/////////////////////////////////////////////////////////////////////////////
+
+struct serialWriter {
+	int             fd;
+	int             baud;
+	int             bitsPerByte;
+	int             flags;
+	int             maxBytes;
+	int             runThread;
+	int             dropped;
+	long long       busyUntil;
+
+	unsigned char  *pending;
+	int             pendingBytes;
+	unsigned char  *sending;
+
+	pthread_t       threadID;
+	pthread_mutex_t lock;
+	pthread_cond_t  cond;
+};
+
+/*
+ * Write a whole buffer to the non-blocking port, waiting for room in the
+ * tty buffer when the adapter falls behind.
+ */
+static int SerialWriterWrite(SerialWriter *writer, unsigned char *data, int len)
+{
+	int sent = 0;
+
+	while (sent < len)
+	{
+		ssize_t r = write(writer->fd, data + sent, len - sent);
+		if (r > 0)
+		{
+			sent += r;
+			continue;
+		}
+
+		if ((r < 0) && (errno != EAGAIN) && (errno != EINTR))
+		{
+			LogErr(VB_CHANNELOUT, "Error writing to serial port: %s\n",
+				strerror(errno));
+			return -1;
+		}
+
+		struct pollfd pfd;
+		pfd.fd = writer->fd;
+		pfd.events = POLLOUT;
+		pfd.revents = 0;
+		if ((poll(&pfd, 1, 1000) == 0) || !writer->runThread)
+		{
+			LogWarn(VB_CHANNELOUT, "Serial port stalled, dropped %d of %d bytes\n",
+				len - sent, len);
+			return -1;
+		}
+	}
+
+	return sent;
+}
+
+/*
+ *
+ */
+static void SerialWriterFlush(SerialWriter *writer, unsigned char *data, int len)
+{
+	long long now = GetTime();
+
+	// Don't hand the adapter more than the line can carry, anything past
+	// that just sits in the driver and adds latency to the next frame
+	if ((writer->flags & SERIAL_WRITER_RATE_LIMIT) && (writer->busyUntil > now))
+	{
+		usleep(writer->busyUntil - now);
+		now = writer->busyUntil;
+	}
+
+	SerialWriterWrite(writer, data, len);
+
+	writer->busyUntil = now +
+		(long long)len * writer->bitsPerByte * 1000000 / writer->baud;
+}
+
+/*
+ *
+ */
+static void *RunSerialWriterThread(void *data)
+{
+	SerialWriter *writer = (SerialWriter *)data;
+
+	pthread_mutex_lock(&writer->lock);
+	while (writer->runThread)
+	{
+		if (!writer->pendingBytes)
+		{
+			pthread_cond_wait(&writer->cond, &writer->lock);
+			continue;
+		}
+
+		unsigned char *buf = writer->pending;
+		int len = writer->pendingBytes;
+
+		writer->pending = writer->sending;
+		writer->pendingBytes = 0;
+		writer->sending = buf;
+
+		if (writer->dropped)
+		{
+			LogDebug(VB_CHANNELOUT, "Serial writer dropped %d frames\n",
+				writer->dropped);
+			writer->dropped = 0;
+		}
+		pthread_mutex_unlock(&writer->lock);
+
+		SerialWriterFlush(writer, buf, len);
+
+		pthread_mutex_lock(&writer->lock);
+	}
+	pthread_mutex_unlock(&writer->lock);
+
+	return NULL;
+}
+
+/*
+ * Start a writer thread for an already open port.  mode is the same
+ * string passed to SerialOpen() and is used to work out the time each
+ * byte takes on the wire.
+ */
+SerialWriter *SerialWriterCreate(int fd, int baud, const char *mode,
+	int maxBytes, int flags)
+{
+	SerialWriter *writer = (SerialWriter *)malloc(sizeof(SerialWriter));
+	if (!writer)
+		return NULL;
+
+	bzero(writer, sizeof(SerialWriter));
+	writer->fd = fd;
+	writer->baud = baud > 0 ? baud : 9600;
+	writer->flags = flags;
+	writer->maxBytes = maxBytes;
+
+	// start bit + data bits + parity + stop bits
+	writer->bitsPerByte = 1 + 8 + 1;
+	if (mode && (strlen(mode) == 3))
+	{
+		int dataBits = ((mode[0] >= '5') && (mode[0] <= '8')) ? mode[0] - '0' : 8;
+
+		writer->bitsPerByte = 1 + dataBits + (mode[1] != 'N') +
+			(mode[2] == '2' ? 2 : 1);
+	}
+
+	writer->pending = (unsigned char *)malloc(maxBytes);
+	writer->sending = (unsigned char *)malloc(maxBytes);
+	if (!writer->pending || !writer->sending)
+	{
+		LogErr(VB_CHANNELOUT, "Error allocating %d byte serial buffers\n",
+			maxBytes);
+		free(writer->pending);
+		free(writer->sending);
+		free(writer);
+		return NULL;
+	}
+
+	pthread_mutex_init(&writer->lock, NULL);
+	pthread_cond_init(&writer->cond, NULL);
+	writer->runThread = 1;
+
+	int result = pthread_create(&writer->threadID, NULL,
+		&RunSerialWriterThread, writer);
+	if (result)
+	{
+		LogErr(VB_CHANNELOUT, "Error creating serial writer thread: %s\n",
+			strerror(result));
+		pthread_mutex_destroy(&writer->lock);
+		pthread_cond_destroy(&writer->cond);
+		free(writer->pending);
+		free(writer->sending);
+		free(writer);
+		return NULL;
+	}
+
+	return writer;
+}
+
+/*
+ * Gather a frame into the writer's buffer and wake the port thread.
+ * Returns the number of bytes queued or -1 if the frame did not fit.
+ */
+int SerialWriterQueue(SerialWriter *writer, const struct iovec *iov, int iovcnt)
+{
+	int len = 0;
+	int i = 0;
+
+	for (i = 0; i < iovcnt; i++)
+		len += iov[i].iov_len;
+
+	pthread_mutex_lock(&writer->lock);
+
+	int offset = 0;
+	if (writer->flags & SERIAL_WRITER_APPEND)
+		offset = writer->pendingBytes;
+
+	if ((offset + len) > writer->maxBytes)
+	{
+		pthread_mutex_unlock(&writer->lock);
+		return -1;
+	}
+
+	if (writer->pendingBytes && !offset)
+		writer->dropped++;
+
+	unsigned char *dst = writer->pending + offset;
+	for (i = 0; i < iovcnt; i++)
+	{
+		memcpy(dst, iov[i].iov_base, iov[i].iov_len);
+		dst += iov[i].iov_len;
+	}
+	writer->pendingBytes = offset + len;
+
+	pthread_mutex_unlock(&writer->lock);
+	pthread_cond_signal(&writer->cond);
+
+	return len;
+}
+
+/*
+ * Stop the port thread.  Anything not yet written is discarded, the
+ * caller still owns and closes the fd.
+ */
+void SerialWriterDestroy(SerialWriter *writer)
+{
+	if (!writer)
+		return;
+
+	pthread_mutex_lock(&writer->lock);
+	writer->runThread = 0;
+	pthread_mutex_unlock(&writer->lock);
+	pthread_cond_signal(&writer->cond);
+
+	pthread_join(writer->threadID, NULL);
+
+	pthread_mutex_destroy(&writer->lock);
+	pthread_cond_destroy(&writer->cond);
+	free(writer->pending);
+	free(writer->sending);
+	free(writer);
+}
+
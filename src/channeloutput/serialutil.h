@@ -26,9 +26,32 @@
 #ifndef _SERIALUTIL_H
 #define _SERIALUTIL_H
 
+#include <sys/uio.h>
+
 int SerialOpen(const char *device, int baud, const char *mode);
 int SerialClose(int fd);
 int SerialSendBreak(int fd, int duration);
 int SerialResetRTS(int fd);
 
+/*
+ * Asynchronous writer, a per-port thread which writes queued frames so a
+ * slow serial adapter does not hold up the channel output thread.
+ *
+ * SERIAL_WRITER_LATEST_FRAME - a queued frame replaces one not yet sent,
+ *                              for protocols which send the full frame
+ * SERIAL_WRITER_APPEND       - queued data is sent in order, queueing
+ *                              fails when the backlog is full
+ * SERIAL_WRITER_RATE_LIMIT   - pace writes to what the baud rate can carry
+ */
+#define SERIAL_WRITER_LATEST_FRAME 0x00
+#define SERIAL_WRITER_APPEND       0x01
+#define SERIAL_WRITER_RATE_LIMIT   0x02
+
+typedef struct serialWriter SerialWriter;
+
+SerialWriter *SerialWriterCreate(int fd, int baud, const char *mode,
+	int maxBytes, int flags);
+int SerialWriterQueue(SerialWriter *writer, const struct iovec *iov, int iovcnt);
+void SerialWriterDestroy(SerialWriter *writer);
+
 #endif /* _SERIALUTIL_H */
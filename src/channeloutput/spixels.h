@@ -55,6 +55,7 @@ class SpixelsOutput : public ThreadedChannelOutputBase {
 
 	std::vector<LEDStrip*>    m_strips;
 	std::vector<PixelString*> m_strings;
+	std::vector<uint8_t>      m_remapBuffer;
 };
 
 #endif
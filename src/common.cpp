@@ -45,6 +45,7 @@
 #include <sys/time.h>
 #include <sys/types.h>
 #include <ctype.h>
+#include <time.h>
 #include <unistd.h>
 
 #include <sstream>
@@ -62,6 +63,16 @@ long long GetTime(void)
 	return now_tv.tv_sec * 1000000LL + now_tv.tv_usec;
 }
 
+/*
+ * Get the monotonic clock in microseconds, unaffected by NTP steps
+ */
+long long GetMonotonicTime(void)
+{
+	struct timespec now_ts;
+	clock_gettime(CLOCK_MONOTONIC, &now_ts);
+	return now_ts.tv_sec * 1000000LL + now_ts.tv_nsec / 1000;
+}
+
 /*
  * Check to see if the specified directory exists
  */
@@ -66,6 +66,7 @@
 
 
 long long GetTime(void);
+long long GetMonotonicTime(void);
 int       DirectoryExists(const char * Directory);
 int       FileExists(const char * File);
 int       FileExists(const std::string &File);
@@ -24,6 +24,8 @@
  */
 
 #include <errno.h> 
+#include <poll.h>
+#include <pthread.h>
 #include <sys/types.h>
 #include <sys/socket.h>
 #include <netinet/in.h>
@@ -53,21 +55,38 @@
 #include "command.h"
 #include "Universe.h"
 
-#define BRIDGE_INVALID_UNIVERSE_INDEX 0xFFFFFF
+#define BRIDGE_INVALID_UNIVERSE_INDEX 0xFFFF
+
+#define BRIDGE_PROTOCOL_E131    0
+#define BRIDGE_PROTOCOL_ARTNET  1
+#define BRIDGE_PROTOCOL_COUNT   2
+
+#define ARTNET_PORT             6454
+#define ARTNET_ID_LENGTH        8
+#define ARTNET_OPCODE_INDEX     8
+#define ARTNET_SEQUENCE_INDEX   12
+#define ARTNET_UNIVERSE_INDEX   14
+#define ARTNET_LENGTH_INDEX     16
+#define ARTNET_HEADER_LENGTH    18
+#define ARTNET_OPCODE_DMX       0x5000
+#define ARTNET_OPCODE_SYNC      0x5200
 
 struct sockaddr_in addr;
 socklen_t addrlen;
 int bridgeSock = -1;
 int ddpSock = -1;
+int artnetSock = -1;
 
 
-#define MAX_MSG 48
+#define MAX_MSG 128
 #define BUFSIZE 1500
 struct mmsghdr msgs[MAX_MSG];
 struct iovec iovecs[MAX_MSG];
 unsigned char buffers[MAX_MSG][BUFSIZE+1];
 
-unsigned int UniverseCache[65536];
+// InputUniverses index for each protocol/universe number, filled in
+// once at config load so the receive path is a single lookup
+static unsigned short UniverseIndex[BRIDGE_PROTOCOL_COUNT][65536];
 
 
 UniverseEntry InputUniverses[MAX_UNIVERSE_COUNT];
@@ -76,6 +95,7 @@ int InputUniverseCount;
 static unsigned long ddpBytesReceived = 0;
 static unsigned long ddpPacketsReceived = 0;
 static unsigned long ddpErrors = 0;
+static unsigned long ddpPushPackets = 0;
 
 static long ddpLastSequence = 0;
 static long ddpLastChannel = 0;
@@ -84,12 +104,126 @@ static unsigned long ddpMaxChannel = 0;
 
 static unsigned long e131Errors = 0;
 static unsigned long e131SyncPackets = 0;
+static unsigned long artnetErrors = 0;
+static unsigned long artnetSyncPackets = 0;
 static UniverseEntry unknownUniverse;
 
+// E1.31 receivers treat packets up to 20 sequence numbers behind the last
+// one as out of order, anything further back is a restarted sender
+#define BRIDGE_REORDER_WINDOW    20
+
+#define BRIDGE_HISTOGRAM_BUCKETS 8
+
+// upper bounds of the histogram buckets in microseconds, the last bucket
+// holds everything above
+static const unsigned int BridgeHistogramLimits[BRIDGE_HISTOGRAM_BUCKETS - 1] =
+    { 500, 1000, 2000, 5000, 10000, 20000, 50000 };
+static const char *BridgeHistogramLabels[BRIDGE_HISTOGRAM_BUCKETS] =
+    { "<0.5ms", "<1ms", "<2ms", "<5ms", "<10ms", "<20ms", "<50ms", ">=50ms" };
+
+class BridgeHistogram {
+  public:
+    BridgeHistogram() { Reset(); }
+
+    void Reset() {
+        memset(buckets, 0, sizeof(buckets));
+        count = 0;
+        total = 0;
+        max = 0;
+    }
+
+    void Add(unsigned int us) {
+        int b = 0;
+        while ((b < (BRIDGE_HISTOGRAM_BUCKETS - 1)) && (us >= BridgeHistogramLimits[b]))
+            b++;
+        buckets[b]++;
+        count++;
+        total += us;
+        if (us > max)
+            max = us;
+    }
+
+    Json::Value GetJson() const {
+        Json::Value result;
+        Json::Value hist;
+        for (int b = 0; b < BRIDGE_HISTOGRAM_BUCKETS; b++)
+            hist[BridgeHistogramLabels[b]] = (Json::UInt64)buckets[b];
+        result["histogram"] = hist;
+        result["count"] = (Json::UInt64)count;
+        result["avgUS"] = count ? (Json::UInt64)(total / count) : 0;
+        result["maxUS"] = max;
+        return result;
+    }
+
+    unsigned long      buckets[BRIDGE_HISTOGRAM_BUCKETS];
+    unsigned long      count;
+    unsigned long long total;
+    unsigned int       max;
+};
+
+// Timing telemetry for an input universe (or DDP as a whole).  Arrival
+// stats are kept by the receive thread, latency is recorded by the output
+// thread under bridgeFrameLock when it picks up a frame.
+class BridgeUniverseStats {
+  public:
+    BridgeUniverseStats() { Reset(); }
+
+    void Reset() {
+        lastArrival = 0;
+        lastInterval = -1;
+        receiveTime = 0;
+        frameReceiveTime = 0;
+        reordered = 0;
+        interArrival.Reset();
+        jitter.Reset();
+        latency.Reset();
+    }
+
+    void Arrived(long long now) {
+        if (lastArrival) {
+            int interval = now - lastArrival;
+            interArrival.Add(interval);
+            if (lastInterval >= 0)
+                jitter.Add(abs(interval - lastInterval));
+            lastInterval = interval;
+        }
+        lastArrival = now;
+    }
+
+    long long       lastArrival;
+    int             lastInterval;
+    long long       receiveTime;      // newest data not yet committed
+    long long       frameReceiveTime; // newest data in the committed frame
+    unsigned long   reordered;
+    BridgeHistogram interArrival;
+    BridgeHistogram jitter;
+    BridgeHistogram latency;
+};
+
+static BridgeUniverseStats InputUniverseStats[MAX_UNIVERSE_COUNT];
+static BridgeUniverseStats ddpStats;
+
+// time the current batch of packets was read from the socket
+static long long bridgePacketTime = 0;
+
+// Received data is assembled in bridgeData by the receive thread and
+// copied to bridgeFrame once a frame is complete (E1.31 sync, DDP push
+// or the frame timer), the output thread only ever sees whole frames.
+static pthread_t       bridgeThreadID;
+static volatile int    bridgeThreadRunning = 0;
+static pthread_mutex_t bridgeFrameLock = PTHREAD_MUTEX_INITIALIZER;
+static char           *bridgeData = NULL;
+static char           *bridgeFrame = NULL;
+static bool            bridgeFrameReady = false;
+static bool            bridgeDataPending = false;
+static bool            bridgeSyncedDataSeen = false;
+static long long       bridgeLastCommit = 0;
+static long long       bridgeLastSyncedData = 0;
+
 // prototypes for functions below
-bool Bridge_StoreData(char *bridgeBuffer);
-bool Bridge_StoreDDPData(char *bridgeBuffer);
-int Bridge_GetIndexFromUniverseNumber(int universe);
+bool Bridge_StoreData(unsigned char *bridgeBuffer, int len);
+bool Bridge_StoreArtNetData(unsigned char *bridgeBuffer, int len);
+bool Bridge_StoreDDPData(unsigned char *bridgeBuffer, int len);
 void InputUniversesPrint();
 
 
@@ -155,6 +289,12 @@ void LoadInputUniversesFromFile(void)
 
 			if(u["active"].asInt())
 			{
+				if (InputUniverseCount >= MAX_UNIVERSE_COUNT) {
+					LogErr(VB_E131BRIDGE, "Too many input universes, only the first %d will be used\n",
+						MAX_UNIVERSE_COUNT);
+					break;
+				}
+
 				InputUniverses[InputUniverseCount].active = u["active"].asInt();
 				InputUniverses[InputUniverseCount].universe = u["id"].asInt();
 				InputUniverses[InputUniverseCount].startAddress = u["startChannel"].asInt();
@@ -166,10 +306,15 @@ void LoadInputUniversesFromFile(void)
 							strcpy(InputUniverses[InputUniverseCount].unicastAddress,"\0");
 							break;
 					case 1: //UnicastAddress
-							strcpy(InputUniverses[InputUniverseCount].unicastAddress,
-								u["address"].asString().c_str());
+							strncpy(InputUniverses[InputUniverseCount].unicastAddress,
+								u["address"].asString().c_str(), 15);
+							InputUniverses[InputUniverseCount].unicastAddress[15] = 0;
+							break;
+					case 2: // ArtNet Broadcast
+					case 3: // ArtNet Unicast
+							strcpy(InputUniverses[InputUniverseCount].unicastAddress,"\0");
 							break;
-					default: // ArtNet
+					default: // DDP is received without a universe config
 							continue;
 				}
 	
@@ -183,41 +328,282 @@ void LoadInputUniversesFromFile(void)
 	InputUniversesPrint();
 }
 
+/*
+ * Build the protocol/universe -> InputUniverses index table and clamp
+ * each universe so a received packet can be copied without further
+ * checks against the channel data size.
+ */
+static void Bridge_BuildUniverseIndex(void)
+{
+	for (int p = 0; p < BRIDGE_PROTOCOL_COUNT; p++)
+		for (int i = 0; i < 65536; i++)
+			UniverseIndex[p][i] = BRIDGE_INVALID_UNIVERSE_INDEX;
+
+	for (int i = 0; i < InputUniverseCount; i++) {
+		UniverseEntry *u = &InputUniverses[i];
+		int protocol = ((u->type == ARTNET_TYPE_BROADCAST) || (u->type == ARTNET_TYPE_UNICAST))
+			? BRIDGE_PROTOCOL_ARTNET : BRIDGE_PROTOCOL_E131;
+
+		if ((u->universe < 0) || (u->universe > 65535) ||
+			(u->startAddress < 1) || (u->startAddress > FPPD_MAX_CHANNELS)) {
+			LogErr(VB_E131BRIDGE, "Ignoring invalid input universe %d starting at channel %d\n",
+				u->universe, u->startAddress);
+			continue;
+		}
+
+		if (u->size > 512)
+			u->size = 512;
+		if (u->size < 0)
+			u->size = 0;
+		if ((u->startAddress - 1 + u->size) > FPPD_MAX_CHANNELS)
+			u->size = FPPD_MAX_CHANNELS - (u->startAddress - 1);
+
+		if (UniverseIndex[protocol][u->universe] != BRIDGE_INVALID_UNIVERSE_INDEX) {
+			LogWarn(VB_E131BRIDGE, "Input universe %d is configured more than once, using the first entry\n",
+				u->universe);
+			continue;
+		}
+		UniverseIndex[protocol][u->universe] = i;
+	}
+}
+
+/*
+ * Check a universe's sequence number.  Returns false for a late packet
+ * which must not overwrite newer data.
+ */
+static bool Bridge_CheckSequence(int universeIndex, int sn, bool skipsZero)
+{
+	UniverseEntry *u = &InputUniverses[universeIndex];
+
+	if (u->packetsReceived != 0) {
+		int diff = (signed char)(sn - u->lastSequenceNumber);
+		// ArtNet goes from 255 to 1, some E1.31 senders do too
+		if ((u->lastSequenceNumber == 255) && (sn == 1) && (skipsZero || (diff == 2)))
+			diff = 1;
+
+		if ((diff <= 0) && (diff > -BRIDGE_REORDER_WINDOW)) {
+			InputUniverseStats[universeIndex].reordered++;
+			return false;
+		}
+		if (diff != 1)
+			++u->errorPackets;
+	}
+	u->lastSequenceNumber = sn;
+
+	return true;
+}
+
+/*
+ * Copy a universe's worth of received data into the back buffer.  The
+ * universe bounds were clamped when the config was loaded, so only the
+ * length needs checking against the packet.
+ */
+static inline void Bridge_StoreUniverseData(int universeIndex, unsigned char *data, int len)
+{
+	UniverseEntry *u = &InputUniverses[universeIndex];
+	BridgeUniverseStats *stats = &InputUniverseStats[universeIndex];
+
+	if (len > u->size)
+		len = u->size;
+	if (len > 0)
+		memcpy(bridgeData + u->startAddress - 1, data, len);
+
+	u->bytesReceived += len;
+	u->packetsReceived++;
+	bridgeDataPending = true;
+
+	stats->Arrived(bridgePacketTime);
+	stats->receiveTime = bridgePacketTime;
+}
+
+/*
+ * Publish the received data as a complete frame
+ */
+static void Bridge_CommitFrame(void)
+{
+    pthread_mutex_lock(&bridgeFrameLock);
+    CopyOutputRanges(bridgeFrame, bridgeData);
+    bridgeFrameReady = true;
+
+    for (int i = 0; i < InputUniverseCount; i++) {
+        if (InputUniverseStats[i].receiveTime) {
+            InputUniverseStats[i].frameReceiveTime = InputUniverseStats[i].receiveTime;
+            InputUniverseStats[i].receiveTime = 0;
+        }
+    }
+    if (ddpStats.receiveTime) {
+        ddpStats.frameReceiveTime = ddpStats.receiveTime;
+        ddpStats.receiveTime = 0;
+    }
+    pthread_mutex_unlock(&bridgeFrameLock);
+
+    bridgeDataPending = false;
+    bridgeLastCommit = GetTime();
+}
+
+/*
+ * Copy the most recent complete frame into the channel data if a new one
+ * has arrived since the last call.  Called from the output thread.
+ */
+bool Bridge_LatchReceivedData(char *channelData)
+{
+    bool latched = false;
+
+    pthread_mutex_lock(&bridgeFrameLock);
+    if (bridgeFrameReady) {
+        CopyOutputRanges(channelData, bridgeFrame);
+        bridgeFrameReady = false;
+        latched = true;
+
+        // receive to output latency of the data in this frame
+        long long now = GetTime();
+        for (int i = 0; i < InputUniverseCount; i++) {
+            if (InputUniverseStats[i].frameReceiveTime) {
+                InputUniverseStats[i].latency.Add(now - InputUniverseStats[i].frameReceiveTime);
+                InputUniverseStats[i].frameReceiveTime = 0;
+            }
+        }
+        if (ddpStats.frameReceiveTime) {
+            ddpStats.latency.Add(now - ddpStats.frameReceiveTime);
+            ddpStats.frameReceiveTime = 0;
+        }
+    }
+    pthread_mutex_unlock(&bridgeFrameLock);
+
+    return latched;
+}
+
 /*
  * Read data waiting for us
  */
-bool Bridge_ReceiveE131Data(void)
+static bool Bridge_ReceiveE131Data(void)
 {
 //	LogExcess(VB_E131BRIDGE, "Bridge_ReceiveData()\n");
 
     int msgcnt = recvmmsg(bridgeSock, msgs, MAX_MSG, 0, nullptr);
     bool sync = false;
     while (msgcnt > 0) {
+        bridgePacketTime = GetTime();
         for (int x = 0; x < msgcnt; x++) {
-            sync |= Bridge_StoreData((char*)buffers[x]);
+            if (Bridge_StoreData(buffers[x], msgs[x].msg_len)) {
+                // latch here so data for the next frame later in
+                // this batch doesn't get mixed in
+                Bridge_CommitFrame();
+                sync = true;
+            }
         }
         msgcnt = recvmmsg(bridgeSock, msgs, MAX_MSG, 0, nullptr);
     }
     return sync;
 }
-bool Bridge_ReceiveDDPData(void)
+static bool Bridge_ReceiveArtNetData(void)
+{
+    int msgcnt = recvmmsg(artnetSock, msgs, MAX_MSG, 0, nullptr);
+    bool sync = false;
+    while (msgcnt > 0) {
+        bridgePacketTime = GetTime();
+        for (int x = 0; x < msgcnt; x++) {
+            if (Bridge_StoreArtNetData(buffers[x], msgs[x].msg_len)) {
+                Bridge_CommitFrame();
+                sync = true;
+            }
+        }
+        msgcnt = recvmmsg(artnetSock, msgs, MAX_MSG, 0, nullptr);
+    }
+    return sync;
+}
+static bool Bridge_ReceiveDDPData(void)
 {
     //    LogExcess(VB_E131BRIDGE, "Bridge_ReceiveData()\n");
     int msgcnt = recvmmsg(ddpSock, msgs, MAX_MSG, 0, nullptr);
     bool sync = false;
     while (msgcnt > 0) {
+        bridgePacketTime = GetTime();
         for (int x = 0; x < msgcnt; x++) {
-            sync |= Bridge_StoreDDPData((char*)buffers[x]);
+            if (Bridge_StoreDDPData(buffers[x], msgs[x].msg_len)) {
+                Bridge_CommitFrame();
+                sync = true;
+            }
         }
         msgcnt = recvmmsg(ddpSock, msgs, MAX_MSG, 0, nullptr);
     }
     return sync;
 }
 
-void Bridge_Initialize(int &eSock, int &dSock)
+/*
+ * Receive thread.  Frames are latched on E1.31 sync, ArtSync and DDP push.  If
+ * the sender doesn't use either, data is latched once the sockets have
+ * been drained.  If sync/push packets stop arriving, pending data is
+ * latched after two frame times.
+ */
+static void *RunBridgeReceiveThread(void *data)
+{
+    int frameTime = getSettingInt("E131BridgingInterval");
+    if (!frameTime)
+        frameTime = 50;
+
+    struct pollfd fds[3];
+    int fdCount = 2;
+    fds[0].fd = bridgeSock;
+    fds[0].events = POLLIN;
+    fds[1].fd = ddpSock;
+    fds[1].events = POLLIN;
+    if (artnetSock >= 0) {
+        fds[2].fd = artnetSock;
+        fds[2].events = POLLIN;
+        fdCount++;
+    }
+
+    LogDebug(VB_E131BRIDGE, "Bridge receive thread started\n");
+
+    while (bridgeThreadRunning) {
+        for (int f = 0; f < fdCount; f++)
+            fds[f].revents = 0;
+        int pr = poll(fds, fdCount, frameTime);
+        if ((pr < 0) && (errno != EINTR)) {
+            LogErr(VB_E131BRIDGE, "Bridge poll() failed: %s\n", strerror(errno));
+            break;
+        }
+
+        bool sync = false;
+        if (pr > 0) {
+            if (fds[0].revents & POLLIN)
+                sync |= Bridge_ReceiveE131Data();
+            if (fds[1].revents & POLLIN)
+                sync |= Bridge_ReceiveDDPData();
+            if ((fdCount > 2) && (fds[2].revents & POLLIN))
+                sync |= Bridge_ReceiveArtNetData();
+        }
+
+        long long now = GetTime();
+        if (bridgeSyncedDataSeen) {
+            bridgeLastSyncedData = now;
+            bridgeSyncedDataSeen = false;
+        }
+
+        if (sync) {
+            ForceChannelOutputNow();
+        } else if (bridgeDataPending) {
+            bool syncExpected = (now - bridgeLastSyncedData) < 1000000;
+            if (!syncExpected || ((now - bridgeLastCommit) > (2000LL * frameTime)))
+                Bridge_CommitFrame();
+        }
+    }
+
+    LogDebug(VB_E131BRIDGE, "Bridge receive thread stopped\n");
+
+    return NULL;
+}
+
+void Bridge_Initialize(void)
 {
 	LogExcess(VB_E131BRIDGE, "Bridge_Initialize()\n");
 
+    if (!bridgeData) {
+        bridgeData = (char*)calloc(1, FPPD_MAX_CHANNELS);
+        bridgeFrame = (char*)calloc(1, FPPD_MAX_CHANNELS);
+    }
+
     // prepare the msg receive buffers
     memset(msgs, 0, sizeof(msgs));
     for (int i = 0; i < MAX_MSG; i++) {
@@ -227,11 +613,8 @@ void Bridge_Initialize(int &eSock, int &dSock)
         msgs[i].msg_hdr.msg_iovlen = 1;
     }
     
-	/* Initialize our Universe Index lookup cache */
-	for (int i = 0; i < 65536; i++)
-		UniverseCache[i] = BRIDGE_INVALID_UNIVERSE_INDEX;
-
 	LoadInputUniversesFromFile();
+	Bridge_BuildUniverseIndex();
 	LogInfo(VB_E131BRIDGE, "Universe Count = %d\n",InputUniverseCount);
 	InputUniversesPrint();
     
@@ -260,6 +643,35 @@ void Bridge_Initialize(int &eSock, int &dSock)
         exit(1);
     }
 
+    bool artnetConfigured = false;
+    for (int i = 0; i < InputUniverseCount; i++) {
+        if ((InputUniverses[i].type == ARTNET_TYPE_BROADCAST) ||
+            (InputUniverses[i].type == ARTNET_TYPE_UNICAST))
+            artnetConfigured = true;
+    }
+
+    if (artnetConfigured) {
+        artnetSock = socket(AF_INET, SOCK_DGRAM | SOCK_NONBLOCK, 0);
+        if (artnetSock < 0) {
+            LogErr(VB_E131BRIDGE, "e131bridge ArtNet socket failed: %s\n", strerror(errno));
+        } else {
+            int enable = 1;
+            setsockopt(artnetSock, SOL_SOCKET, SO_REUSEADDR, &enable, sizeof(enable));
+            setsockopt(artnetSock, SOL_SOCKET, SO_BROADCAST, &enable, sizeof(enable));
+
+            memset((char *)&addr, 0, sizeof(addr));
+            addr.sin_family = AF_INET;
+            addr.sin_addr.s_addr = htonl(INADDR_ANY);
+            addr.sin_port = htons(ARTNET_PORT);
+            addrlen = sizeof(addr);
+            if (bind(artnetSock, (struct sockaddr *) &addr, sizeof(addr)) < 0) {
+                LogErr(VB_E131BRIDGE, "e131bridge ArtNet bind failed: %s\n", strerror(errno));
+                close(artnetSock);
+                artnetSock = -1;
+            }
+        }
+    }
+
 	int            UniverseOctet[2];
 	struct ip_mreq mreq;
 	char           strMulticastGroup[16];
@@ -336,58 +748,67 @@ void Bridge_Initialize(int &eSock, int &dSock)
 	}
     freeifaddrs(interfaces);
 
+    bridgeThreadRunning = 1;
+    if (pthread_create(&bridgeThreadID, NULL, &RunBridgeReceiveThread, NULL)) {
+        LogErr(VB_E131BRIDGE, "Unable to start bridge receive thread: %s\n", strerror(errno));
+        exit(1);
+    }
+
 	StartChannelOutputThread();
     
     if (i1 >= 0) close(i1);
     if (i2 >= 0) close(i2);
     if (i3 >= 0) close(i3);
-
-    eSock = bridgeSock;
-    dSock = ddpSock;
 }
 
 void Bridge_Shutdown(void)
 {
+    if (bridgeThreadRunning) {
+        bridgeThreadRunning = 0;
+        pthread_join(bridgeThreadID, NULL);
+    }
+
     close(bridgeSock);
     close(ddpSock);
+    if (artnetSock >= 0)
+        close(artnetSock);
     bridgeSock = -1;
     ddpSock = -1;
+    artnetSock = -1;
 }
 
-bool Bridge_StoreData(char *bridgeBuffer)
+bool Bridge_StoreData(unsigned char *bridgeBuffer, int len)
 {
+    if (len <= E131_VECTOR_INDEX) {
+        e131Errors++;
+        return false;
+    }
+
     if ((bridgeBuffer[E131_VECTOR_INDEX] == VECTOR_ROOT_E131_DATA) &&
+        (len >= E131_HEADER_LENGTH) &&
         (bridgeBuffer[E131_START_CODE] == 0x00)) {
         int universe = ((int)bridgeBuffer[E131_UNIVERSE_INDEX] << 8) + bridgeBuffer[E131_UNIVERSE_INDEX + 1];
-        int universeIndex = Bridge_GetIndexFromUniverseNumber(universe);
+        int universeIndex = UniverseIndex[BRIDGE_PROTOCOL_E131][universe];
+
+        // property value count includes the start code
+        int dataLen = ((int)bridgeBuffer[E131_COUNT_INDEX] << 8) + bridgeBuffer[E131_COUNT_INDEX + 1] - 1;
+        dataLen = std::min(dataLen, len - E131_HEADER_LENGTH);
+
         if(universeIndex != BRIDGE_INVALID_UNIVERSE_INDEX) {
-            int sn = bridgeBuffer[E131_SEQUENCE_INDEX];
-            if (InputUniverses[universeIndex].packetsReceived != 0) {
-                if (InputUniverses[universeIndex].lastSequenceNumber == 255) {
-                    // some wrap from 255 -> 1 and some from 255 -> 0, spec doesn't say which
-                    if (sn != 0 && sn != 1) {
-                        ++InputUniverses[universeIndex].errorPackets;
-                    }
-                } else if ((InputUniverses[universeIndex].lastSequenceNumber + 1) != sn) {
-                    ++InputUniverses[universeIndex].errorPackets;
-                }
-            }
-            InputUniverses[universeIndex].lastSequenceNumber = sn;
-            
-            memcpy((void*)(sequence->m_seqData+InputUniverses[universeIndex].startAddress-1),
-                   (void*)(bridgeBuffer+E131_HEADER_LENGTH),
-                   InputUniverses[universeIndex].size);
-            InputUniverses[universeIndex].bytesReceived += InputUniverses[universeIndex].size;
-            InputUniverses[universeIndex].packetsReceived++;
+            if (!Bridge_CheckSequence(universeIndex, bridgeBuffer[E131_SEQUENCE_INDEX], false))
+                return false;
+
+            if (bridgeBuffer[E131_SYNC_ADDRESS_INDEX] || bridgeBuffer[E131_SYNC_ADDRESS_INDEX + 1])
+                bridgeSyncedDataSeen = true;
+
+            Bridge_StoreUniverseData(universeIndex, bridgeBuffer + E131_HEADER_LENGTH, dataLen);
         } else {
             unknownUniverse.packetsReceived++;
-            int len = bridgeBuffer[16] & 0xF;
-            len <<= 8;
-            len += bridgeBuffer[17];
-            unknownUniverse.bytesReceived += len;
+            unknownUniverse.bytesReceived += std::max(dataLen, 0);
             LogDebug(VB_E131BRIDGE, "Received data packet for unconfigured universe %d\n", universe);
         }
-    } else if (bridgeBuffer[E131_VECTOR_INDEX] == VECTOR_ROOT_E131_EXTENDED) {
+    } else if ((bridgeBuffer[E131_VECTOR_INDEX] == VECTOR_ROOT_E131_EXTENDED) &&
+               (len > E131_EXTENDED_PACKET_TYPE_INDEX)) {
         if (bridgeBuffer[E131_EXTENDED_PACKET_TYPE_INDEX] == VECTOR_E131_EXTENDED_SYNCHRONIZATION) {
             e131SyncPackets++;
             return true;
@@ -396,17 +817,74 @@ bool Bridge_StoreData(char *bridgeBuffer)
         LogDebug(VB_E131BRIDGE, "Unknown e1.31 extended packet type %d\n", (int)bridgeBuffer[E131_EXTENDED_PACKET_TYPE_INDEX]);
     } else {
         e131Errors++;
-        LogDebug(VB_E131BRIDGE, "Unknown e1.31 packet type %d, start code %d\n", (int)bridgeBuffer[E131_VECTOR_INDEX], (int)bridgeBuffer[E131_START_CODE]);
+        LogDebug(VB_E131BRIDGE, "Unknown e1.31 packet type %d, start code %d\n", (int)bridgeBuffer[E131_VECTOR_INDEX],
+                 (len > E131_START_CODE) ? (int)bridgeBuffer[E131_START_CODE] : -1);
     }
     return false;
 }
 
-bool Bridge_StoreDDPData(char *bridgeBuffer)  {
+/*
+ * Store an ArtDmx packet, returns true for ArtSync
+ */
+bool Bridge_StoreArtNetData(unsigned char *bridgeBuffer, int len)
+{
+    if ((len < (ARTNET_OPCODE_INDEX + 2)) ||
+        memcmp(bridgeBuffer, "Art-Net\0", ARTNET_ID_LENGTH)) {
+        artnetErrors++;
+        return false;
+    }
+
+    int opcode = bridgeBuffer[ARTNET_OPCODE_INDEX] | (bridgeBuffer[ARTNET_OPCODE_INDEX + 1] << 8);
+    if (opcode == ARTNET_OPCODE_SYNC) {
+        artnetSyncPackets++;
+        return true;
+    }
+
+    if (opcode != ARTNET_OPCODE_DMX) {
+        // ArtPoll and friends from other nodes on the network, not errors
+        return false;
+    }
+
+    if (len < ARTNET_HEADER_LENGTH) {
+        artnetErrors++;
+        return false;
+    }
+
+    // 15 bit port address, low byte first
+    int universe = bridgeBuffer[ARTNET_UNIVERSE_INDEX] | ((bridgeBuffer[ARTNET_UNIVERSE_INDEX + 1] & 0x7F) << 8);
+    int dataLen = (bridgeBuffer[ARTNET_LENGTH_INDEX] << 8) | bridgeBuffer[ARTNET_LENGTH_INDEX + 1];
+    dataLen = std::min(dataLen, len - ARTNET_HEADER_LENGTH);
+
+    int universeIndex = UniverseIndex[BRIDGE_PROTOCOL_ARTNET][universe];
+    if (universeIndex == BRIDGE_INVALID_UNIVERSE_INDEX) {
+        unknownUniverse.packetsReceived++;
+        unknownUniverse.bytesReceived += dataLen;
+        LogDebug(VB_E131BRIDGE, "Received ArtNet data packet for unconfigured universe %d\n", universe);
+        return false;
+    }
+
+    // sequence number 0 means the sender doesn't use them
+    int sn = bridgeBuffer[ARTNET_SEQUENCE_INDEX];
+    if (sn && !Bridge_CheckSequence(universeIndex, sn, true))
+        return false;
+
+    // once ArtSync has been seen, the sender latches its frames with it
+    if (artnetSyncPackets)
+        bridgeSyncedDataSeen = true;
+
+    Bridge_StoreUniverseData(universeIndex, bridgeBuffer + ARTNET_HEADER_LENGTH, dataLen);
+
+    return false;
+}
+
+bool Bridge_StoreDDPData(unsigned char *bridgeBuffer, int len)  {
     bool push = false;
-    if (bridgeBuffer[3] == 1) {
+    if ((len >= 10) && (bridgeBuffer[3] == 1)) {
         ddpPacketsReceived++;
         bool tc = bridgeBuffer[0] & DDP_TIMECODE_FLAG;
         push = bridgeBuffer[0] & DDP_PUSH_FLAG;
+        if (push)
+            ddpPushPackets++;
         
         unsigned long chan = bridgeBuffer[4];
         chan <<= 8;
@@ -416,8 +894,8 @@ bool Bridge_StoreDDPData(char *bridgeBuffer)  {
         chan <<= 8;
         chan += bridgeBuffer[7];
         
-        unsigned long len = bridgeBuffer[8] << 8;
-        len += bridgeBuffer[9];
+        unsigned long dataLen = bridgeBuffer[8] << 8;
+        dataLen += bridgeBuffer[9];
         
         int sn = bridgeBuffer[1] & 0xF;
         if (sn) {
@@ -436,42 +914,35 @@ bool Bridge_StoreDDPData(char *bridgeBuffer)  {
                 //printf("%d   %d    %d  %d\n", sn, ddpLastSequence, chan, ddpLastChannel);
             }
             ddpLastSequence = sn;
-            ddpLastChannel = chan + len;
+            ddpLastChannel = chan + dataLen;
+        }
+
+        int offset = tc ? 14 : 10;
+        if (((offset + dataLen) > len) ||
+            (chan >= FPPD_MAX_CHANNELS) ||
+            (dataLen > (FPPD_MAX_CHANNELS - chan))) {
+            ddpErrors++;
+            return false;
         }
 
         ddpMinChannel = std::min(ddpMinChannel, chan + 1);
-        ddpMaxChannel = std::max(ddpMaxChannel, chan + len);
+        ddpMaxChannel = std::max(ddpMaxChannel, chan + dataLen);
 
-        int offset = tc ? 14 : 10;
-        memcpy(sequence->m_seqData + chan, &bridgeBuffer[offset], len);
+        memcpy(bridgeData + chan, &bridgeBuffer[offset], dataLen);
+        bridgeDataPending = true;
+        // only senders that use PUSH latch their frames with it
+        if (ddpPushPackets)
+            bridgeSyncedDataSeen = true;
         
-        ddpBytesReceived += len;
+        ddpBytesReceived += dataLen;
+        ddpStats.receiveTime = bridgePacketTime;
+        if (push)
+            ddpStats.Arrived(bridgePacketTime);
     }
     return push;
 }
 
 
-inline int Bridge_GetIndexFromUniverseNumber(int universe)
-{
-	int index;
-	int val=BRIDGE_INVALID_UNIVERSE_INDEX;
-
-	if (UniverseCache[universe] != BRIDGE_INVALID_UNIVERSE_INDEX)
-		return UniverseCache[universe];
-
-	for(index=0;index<InputUniverseCount;index++)
-	{
-		if(universe == InputUniverses[index].universe)
-		{
-			val = index;
-			UniverseCache[universe] = index;
-			break;
-		}
-	}
-
-	return val;
-}
-
 void ResetBytesReceived()
 {
 	int i;
@@ -482,11 +953,14 @@ void ResetBytesReceived()
 		InputUniverses[i].packetsReceived = 0;
         InputUniverses[i].errorPackets = 0;
         InputUniverses[i].lastSequenceNumber = 0;
+        InputUniverseStats[i].Reset();
 	}
+    ddpStats.Reset();
     ddpBytesReceived = 0;
     ddpPacketsReceived = 0;
     ddpErrors = 0;
     e131Errors = 0;
+    artnetErrors = 0;
 }
 
 Json::Value GetE131UniverseBytesReceived()
@@ -523,6 +997,9 @@ Json::Value GetE131UniverseBytesReceived()
         er << ddpErrors;
         std::string errors = er.str();
         ddpUniverse["errors"] = errors;
+        ddpUniverse["interArrival"] = ddpStats.interArrival.GetJson();
+        ddpUniverse["jitter"] = ddpStats.jitter.GetJson();
+        ddpUniverse["latency"] = ddpStats.latency.GetJson();
         universes.append(ddpUniverse);
     }
 
@@ -536,6 +1013,10 @@ Json::Value GetE131UniverseBytesReceived()
 		universe["bytesReceived"] = std::to_string(InputUniverses[i].bytesReceived);
 		universe["packetsReceived"] = std::to_string(InputUniverses[i].packetsReceived);
 		universe["errors"] = std::to_string(InputUniverses[i].errorPackets);
+		universe["reordered"] = std::to_string(InputUniverseStats[i].reordered);
+		universe["interArrival"] = InputUniverseStats[i].interArrival.GetJson();
+		universe["jitter"] = InputUniverseStats[i].jitter.GetJson();
+		universe["latency"] = InputUniverseStats[i].latency.GetJson();
 
 		universes.append(universe);
 	}
@@ -594,6 +1075,28 @@ Json::Value GetE131UniverseBytesReceived()
         
         universes.append(universe);
     }
+    if (artnetErrors) {
+        Json::Value universe;
+
+        universe["id"] = "ArtNet Errors";
+        universe["startChannel"] = "-";
+        universe["bytesReceived"] = "-";
+        universe["packetsReceived"] = "-";
+        universe["errors"] = std::to_string(artnetErrors);
+
+        universes.append(universe);
+    }
+    if (artnetSyncPackets) {
+        Json::Value universe;
+
+        universe["id"] = "ArtNet Sync";
+        universe["startChannel"] = "-";
+        universe["bytesReceived"] = "-";
+        universe["packetsReceived"] = std::to_string(artnetSyncPackets);
+        universe["errors"] = "-";
+
+        universes.append(universe);
+    }
     
 	result["universes"] = universes;
 
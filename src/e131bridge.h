@@ -28,9 +28,8 @@
 
 #include "e131defs.h"
 
-void Bridge_Initialize(int &e131Socket, int &ddpSocket);
-bool Bridge_ReceiveE131Data(void);
-bool Bridge_ReceiveDDPData(void);
+void Bridge_Initialize(void);
+bool Bridge_LatchReceivedData(char *channelData);
 void Bridge_Shutdown(void);
 
 void  ResetBytesReceived();
@@ -38,6 +38,7 @@
 #define E131_COUNT_INDEX      123
 #define E131_START_CODE       125
 #define E131_PRIORITY_INDEX   108
+#define E131_SYNC_ADDRESS_INDEX 109
 
 #define E131_RLP_COUNT_INDEX       16
 #define E131_FRAMING_COUNT_INDEX   38
@@ -49,4 +50,8 @@
 #define VECTOR_ROOT_E131_DATA       0x4
 #define VECTOR_ROOT_E131_EXTENDED   0x8
 
+#define E131_SYNC_PACKET_LENGTH       49
+#define E131_SYNC_SEQUENCE_INDEX      44
+#define E131_SYNC_UNIVERSE_INDEX      45
+
 #endif
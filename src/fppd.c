@@ -101,6 +101,9 @@ static void handleCrash(int s) {
         return;
     }
     inCrashHandler = true;
+    // write out anything queued and log the crash info synchronously,
+    // without locking or waiting on the log writer thread
+    FlushLogsForCrash();
     LogErr(VB_ALL, "Crash handler called:  %d\n", s);
 
     void* callstack[128];
@@ -471,6 +474,11 @@ int main(int argc, char *argv[])
 	if (getDaemonize())
 		CreateDaemon();
 
+	// log from a background thread so logging doesn't stall the output
+	// thread, this needs to be after the fork in CreateDaemon()
+	if (strcmp(getSetting("LogAsync"), "0"))
+		StartAsyncLogging();
+
 	if (strcmp(getSetting("MQTTHost"),""))
 	{
 		mqtt = new MosquittoClient(getSetting("MQTTHost"), getSettingInt("MQTTPort"), getSetting("MQTTPrefix"));
@@ -564,8 +572,6 @@ void MainLoop(void)
 {
 	int            commandSock = 0;
 	int            controlSock = 0;
-	int            bridgeSock = 0;
-    int            ddpSock = 0;
 	int            prevFPPstatus = FPPstatus;
 	int            sleepms = 50000;
 	fd_set         active_fd_set;
@@ -589,11 +595,7 @@ void MainLoop(void)
 	}
 	else if (getFPPmode() == BRIDGE_MODE)
 	{
-		Bridge_Initialize(bridgeSock, ddpSock);
-		if (bridgeSock)
-			FD_SET (bridgeSock, &active_fd_set);
-                if (ddpSock)
-                    FD_SET (ddpSock, &active_fd_set);
+		Bridge_Initialize();
 	}
 
 	controlSock = multiSync->GetControlSocket();
@@ -631,15 +633,9 @@ void MainLoop(void)
 			}
 		}
 
-        bool pushBridgeData = false;
 		if (commandSock && FD_ISSET(commandSock, &read_fd_set))
 			CommandProc();
 
-		if (bridgeSock && FD_ISSET(bridgeSock, &read_fd_set))
- 			pushBridgeData |= Bridge_ReceiveE131Data();
-        if (ddpSock && FD_ISSET(ddpSock, &read_fd_set))
-            pushBridgeData |= Bridge_ReceiveDDPData();
-
 		if (FD_ISSET(controlSock, &read_fd_set))
 			multiSync->ProcessControlPacket();
 
@@ -711,10 +707,6 @@ void MainLoop(void)
 				playlist->ProcessMedia();
 			}
         }
-        else if (getFPPmode() == BRIDGE_MODE && pushBridgeData)
-        {
-            ForceChannelOutputNow();
-        }
         multiSync->PeriodicPing();
 		CheckGPIOInputs();
 	}
@@ -6,6 +6,12 @@
 #include <vector>
 #include <cstring>
 #include <memory>
+#include <algorithm>
+#include <list>
+#include <thread>
+#include <mutex>
+#include <condition_variable>
+#include <map>
 
 #include <stdio.h>
 #include <inttypes.h>
@@ -41,6 +47,7 @@ int gettimeofday(struct timeval * tp, struct timezone * tzp)
 
 #else
 #include <sys/time.h>
+#include <sys/mman.h>
 #include <unistd.h>
 #endif
 
@@ -57,6 +64,10 @@ template<typename... Args> static void LogErr(int i, const char *fmt, Args... ar
     static log4cpp::Category &fseq_logger_base = log4cpp::Category::getInstance(std::string("log_base"));
     fseq_logger_base.error(fmt, args...);
 }
+template<typename... Args> static void LogWarn(int i, const char *fmt, Args... args) {
+    static log4cpp::Category &fseq_logger_base = log4cpp::Category::getInstance(std::string("log_base"));
+    fseq_logger_base.warn(fmt, args...);
+}
 template<typename... Args> static void LogInfo(int i, const char *fmt, Args... args) {
     static log4cpp::Category &fseq_logger_base = log4cpp::Category::getInstance(std::string("log_base"));
     fseq_logger_base.info(fmt, args...);
@@ -72,6 +83,7 @@ template<typename... Args> static void LogDebug(int i, const char *fmt, Args...
 
 #ifndef NO_ZSTD
 #include <zstd.h>
+#include <zdict.h>
 #endif
 #ifndef NO_ZLIB
 #include <zlib.h>
@@ -262,7 +274,8 @@ FSEQFile::FSEQFile(const std::string &fn)
     m_seqVersionMinor(0),
     m_memoryBuffer(),
     m_seqChanDataOffset(0),
-    m_memoryBufferPos(0)
+    m_memoryBufferPos(0),
+    m_memoryMap(nullptr)
 {
     if (fn == "-memory-") {
         m_seqFile = nullptr;
@@ -284,6 +297,7 @@ void FSEQFile::dumpInfo(bool indent) {
     LogDebug(VB_SEQUENCE, "%sseqChannelCount       : %d\n", ind, m_seqChannelCount);
     LogDebug(VB_SEQUENCE, "%sseqNumPeriods         : %d\n", ind, m_seqNumFrames);
     LogDebug(VB_SEQUENCE, "%sseqStepTime           : %dms\n", ind, m_seqStepTime);
+    LogDebug(VB_SEQUENCE, "%sseqReadMode           : %s\n", ind, getReadMode().c_str());
 }
 
 
@@ -301,7 +315,8 @@ FSEQFile::FSEQFile(const std::string &fn, FILE *file, const std::vector<uint8_t>
     m_seqFile(file),
     m_uniqueId(0),
     m_memoryBuffer(),
-    m_memoryBufferPos(0)
+    m_memoryBufferPos(0),
+    m_memoryMap(nullptr)
 {
     fseeko(m_seqFile, 0L, SEEK_END);
     m_seqFileSize = ftello(m_seqFile);
@@ -324,6 +339,11 @@ FSEQFile::FSEQFile(const std::string &fn, FILE *file, const std::vector<uint8_t>
     }
 }
 FSEQFile::~FSEQFile() {
+#ifndef _MSC_VER
+    if (m_memoryMap) {
+        munmap(m_memoryMap, m_seqFileSize);
+    }
+#endif
     if (m_seqFile) {
         fclose(m_seqFile);
     }
@@ -371,6 +391,37 @@ void FSEQFile::preload(uint64_t pos, uint64_t size) {
 #endif
 }
 
+bool FSEQFile::m_memoryMapEnabled = true;
+
+bool FSEQFile::mapFile() {
+#ifndef _MSC_VER
+    if (m_memoryMap) {
+        return true;
+    }
+    if (!m_memoryMapEnabled || !m_seqFile || m_seqFileSize == 0) {
+        return false;
+    }
+    //on 32bit systems, very large files may not fit in the address space,
+    //in which case we'll just fall back to reading
+    void *map = mmap(nullptr, m_seqFileSize, PROT_READ, MAP_SHARED, fileno(m_seqFile), 0);
+    if (map == MAP_FAILED) {
+        LogDebug(VB_SEQUENCE, "Could not mmap sequence file %s, using read mode\n", m_filename.c_str());
+        return false;
+    }
+    m_memoryMap = (uint8_t*)map;
+    return true;
+#else
+    return false;
+#endif
+}
+
+const uint8_t *FSEQFile::getMappedData(uint64_t pos, uint64_t size) const {
+    if (m_memoryMap == nullptr || (pos + size) > m_seqFileSize) {
+        return nullptr;
+    }
+    return &m_memoryMap[pos];
+}
+
 void FSEQFile::parseVariableHeaders(const std::vector<uint8_t> &header, int start) {
     while (start < header.size() - 5) {
         int len = read2ByteUInt(&header[start]);
@@ -479,12 +530,25 @@ V1FSEQFile::V1FSEQFile(const std::string &fn, FILE *file, const std::vector<uint
     struct stat stats;
     fstat(fileno(file), &stats);
     m_uniqueId = stats.st_mtime;
+
+    mapFile();
 }
 
 V1FSEQFile::~V1FSEQFile() {
 
 }
 
+//copy the ranges, stored back to back in buffer, to their channels in data
+static void unpackRanges(const std::vector<std::pair<uint32_t, uint32_t>> &ranges,
+                         const uint8_t *buffer, uint8_t *data) {
+    uint32_t offset = 0;
+    for (auto &rng : ranges) {
+        uint32_t toRead = rng.second;
+        memcpy(&data[rng.first], &buffer[offset], toRead);
+        offset += toRead;
+    }
+}
+
 class UncompressedFrameData : public FSEQFile::FrameData {
 public:
     UncompressedFrameData(uint32_t frame,
@@ -498,29 +562,59 @@ public:
     }
 
     virtual void readFrame(uint8_t *data) {
-        uint32_t offset = 0;
+        unpackRanges(m_ranges, m_data, data);
+    }
+
+    uint8_t *m_data;
+    std::vector<std::pair<uint32_t, uint32_t>> m_ranges;
+};
+// Frame data that points directly into the mmapped file.  Each range
+// is at its channel offset within the frame (non-sparse files only).
+class MappedFrameData : public FSEQFile::FrameData {
+public:
+    MappedFrameData(uint32_t frame,
+                    const uint8_t *data,
+                    const std::vector<std::pair<uint32_t, uint32_t>> &ranges)
+    : FrameData(frame), m_data(data), m_ranges(ranges) {
+    }
+    virtual ~MappedFrameData() {
+    }
+
+    virtual void readFrame(uint8_t *data) {
         for (auto &rng : m_ranges) {
-            uint32_t toRead = rng.second;
-            memcpy(&data[rng.first], &m_data[offset], toRead);
-            offset += toRead;
+            memcpy(&data[rng.first], &m_data[rng.first], rng.second);
         }
     }
 
-    uint8_t *m_data;
+    const uint8_t *m_data;
     std::vector<std::pair<uint32_t, uint32_t>> m_ranges;
 };
-void V1FSEQFile::prepareRead(const std::vector<std::pair<uint32_t, uint32_t>> &ranges) {
-    m_rangesToRead = ranges;
-    m_dataBlockSize = 0;
-    for (auto &rng : m_rangesToRead) {
-        //make sure we don't read beyond the end of the sequence data
-        int toRead = rng.second;
-        if ((rng.first + toRead) > m_seqChannelCount) {
-            toRead = m_seqChannelCount - rng.first;
-            rng.second = toRead;
+
+// Clip the requested ranges to the channels available in the sequence,
+// ranges entirely beyond the end of the sequence data are dropped
+static uint32_t clipRanges(const std::vector<std::pair<uint32_t, uint32_t>> &ranges,
+                           uint32_t channelCount,
+                           std::vector<std::pair<uint32_t, uint32_t>> &clipped) {
+    uint32_t size = 0;
+    clipped.clear();
+    for (auto &rng : ranges) {
+        if (rng.first >= channelCount || rng.second == 0) {
+            continue;
         }
-        m_dataBlockSize += toRead;
+        uint32_t toRead = std::min(rng.second, channelCount - rng.first);
+        clipped.push_back(std::pair<uint32_t, uint32_t>(rng.first, toRead));
+        size += toRead;
+    }
+    if (clipped.empty()) {
+        //nothing needed from this sequence, but an empty list means
+        //prepareRead has not been called
+        clipped.push_back(std::pair<uint32_t, uint32_t>(0, 0));
     }
+    return size;
+}
+
+void V1FSEQFile::prepareRead(const std::vector<std::pair<uint32_t, uint32_t>> &ranges) {
+    m_dataBlockSize = clipRanges(ranges, m_seqChannelCount, m_rangesToRead);
     FrameData *f = getFrame(0);
     if (f) {
         delete f;
@@ -537,20 +631,55 @@ FrameData *V1FSEQFile::getFrame(uint32_t frame) {
     offset *= frame;
     offset += m_seqChanDataOffset;
 
+    const uint8_t *mdata = getMappedData(offset, m_seqChannelCount);
+    if (mdata) {
+        //let the kernel know that we'll likely need the next frame soon
+        preload(offset + m_seqChannelCount, m_seqChannelCount);
+        return new MappedFrameData(frame, mdata, m_rangesToRead);
+    }
+
     UncompressedFrameData *data = new UncompressedFrameData(frame, m_dataBlockSize, m_rangesToRead);
+    readFrameData(frame, data->m_data);
+    return data;
+}
+
+bool V1FSEQFile::readFrameData(uint32_t frame, uint8_t *buffer) {
+    if (m_rangesToRead.empty()) {
+        std::vector<std::pair<uint32_t, uint32_t>> range;
+        range.push_back(std::pair<uint32_t, uint32_t>(0, m_seqChannelCount));
+        prepareRead(range);
+    }
+    if (frame >= m_seqNumFrames) {
+        return false;
+    }
+    uint64_t offset = m_seqChannelCount;
+    offset *= frame;
+    offset += m_seqChanDataOffset;
+
+    const uint8_t *mdata = getMappedData(offset, m_seqChannelCount);
+    if (mdata) {
+        preload(offset + m_seqChannelCount, m_seqChannelCount);
+        uint32_t sz = 0;
+        for (auto &rng : m_rangesToRead) {
+            memcpy(&buffer[sz], &mdata[rng.first], rng.second);
+            sz += rng.second;
+        }
+        return true;
+    }
+
     if (seek(offset, SEEK_SET)) {
         LogErr(VB_SEQUENCE, "Failed to seek to proper offset for channel data for frame %d! %" PRIu64 "\n", frame, offset);
-        return data;
+        return false;
     }
     uint32_t sz = 0;
     //read the ranges into the buffer
-    for (auto &rng : data->m_ranges) {
+    for (auto &rng : m_rangesToRead) {
         if (rng.first < m_seqChannelCount) {
             int toRead = rng.second;
             uint64_t doffset = offset;
             doffset += rng.first;
             seek(doffset, SEEK_SET);
-            size_t bread = read(&data->m_data[sz], toRead);
+            size_t bread = read(&buffer[sz], toRead);
             if (bread != toRead) {
                 LogErr(VB_SEQUENCE, "Failed to read channel data for frame %d!   Needed to read %d but read %d\n",
                        frame, toRead, (int)bread);
@@ -558,7 +687,11 @@ FrameData *V1FSEQFile::getFrame(uint32_t frame) {
             sz += toRead;
         }
     }
-    return data;
+    return true;
+}
+
+void V1FSEQFile::unpackFrameData(const uint8_t *buffer, uint8_t *data) const {
+    unpackRanges(m_rangesToRead, buffer, data);
 }
 
 void V1FSEQFile::addFrame(uint32_t frame,
@@ -575,9 +708,14 @@ uint32_t V1FSEQFile::getMaxChannel() const {
 }
 
 static const int V2FSEQ_HEADER_SIZE = 32;
+//the block count is 12 bits, low 8 in byte 21, high 4 in the upper nibble of byte 20
+static const uint32_t V2FSEQ_MAX_BLOCKS = 4095;
+static const uint32_t V2FSEQ_FIRST_BLOCK_FRAMES = 10;
 #if !defined(NO_ZLIB) || !defined(NO_ZSTD)
 static const int V2FSEQ_OUT_BUFFER_SIZE = 1024*1024; //1M output buffer
 static const int V2FSEQ_OUT_BUFFER_FLUSH_SIZE = 900 * 1024; //90% full, flush it
+static const int V2FSEQ_BLOCK_CACHE_COUNT = 4; //number of decompressed blocks to keep around
+static const uint64_t V2FSEQ_BLOCK_CACHE_MAX_SIZE = 64 * 1024 * 1024; //but not if they use more than this
 #endif
 
 class V2Handler {
@@ -592,12 +730,16 @@ public:
 
     virtual uint8_t getCompressionType() = 0;
     virtual FrameData *getFrame(uint32_t frame) = 0;
+    virtual bool readFrameData(uint32_t frame, uint8_t *buffer) = 0;
 
     virtual uint32_t computeMaxBlocks() = 0;
     virtual void addFrame(uint32_t frame, const uint8_t *data) = 0;
     virtual void finalize() = 0;
     virtual std::string GetType() const = 0;
 
+    virtual void setReadAhead(uint32_t numBlocks, uint32_t numThreads) {}
+    virtual void getBlockDecodeStats(std::vector<FSEQFile::BlockDecodeStats> &stats) {}
+
     int seek(uint64_t location, int origin) {
         return m_file->seek(location, origin);
     }
@@ -613,6 +755,18 @@ public:
     void preload(uint64_t pos, uint64_t size) {
         m_file->preload(pos, size);
     }
+    const uint8_t *getMappedData(uint64_t pos, uint64_t size) {
+        return m_file->getMappedData(pos, size);
+    }
+    //pack the ranges to read from a full frame as stored in the file
+    void copyRanges(const uint8_t *fdata, uint8_t *buffer) {
+        uint32_t sz = 0;
+        for (int x = 0; x < m_file->m_rangesToRead.size(); x++) {
+            uint32_t toRead = m_file->m_rangesToRead[x].second;
+            memcpy(&buffer[sz], &fdata[m_file->m_rangesToReadOffsets[x]], toRead);
+            sz += toRead;
+        }
+    }
 
     V2FSEQFile *m_file;
     uint64_t   m_seqChanDataOffset;
@@ -627,37 +781,53 @@ public:
     virtual uint32_t computeMaxBlocks() override {return 0;}
     virtual std::string GetType() const override { return "No Compression"; }
     virtual FrameData *getFrame(uint32_t frame) override {
+        uint64_t offset = m_file->getChannelCount();
+        offset *= frame;
+        offset += m_seqChanDataOffset;
+
+        const uint8_t *mdata = m_file->m_sparseRanges.empty() ? getMappedData(offset, m_file->getChannelCount()) : nullptr;
+        if (mdata) {
+            //let the kernel know that we'll likely need the next frame soon
+            preload(offset + m_file->getChannelCount(), m_file->getChannelCount());
+            return new MappedFrameData(frame, mdata, m_file->m_rangesToRead);
+        }
+
         UncompressedFrameData *data = new UncompressedFrameData(frame, m_file->m_dataBlockSize, m_file->m_rangesToRead);
+        readFrameData(frame, data->m_data);
+        return data;
+    }
+    virtual bool readFrameData(uint32_t frame, uint8_t *buffer) override {
         uint64_t offset = m_file->getChannelCount();
         offset *= frame;
         offset += m_seqChanDataOffset;
-        if (seek(offset, SEEK_SET)) {
-            LogErr(VB_SEQUENCE, "Failed to seek to proper offset for channel data! %" PRIu64 "\n", offset);
-            return data;
+
+        const uint8_t *mdata = getMappedData(offset, m_file->getChannelCount());
+        if (mdata) {
+            preload(offset + m_file->getChannelCount(), m_file->getChannelCount());
+            copyRanges(mdata, buffer);
+            return true;
         }
-        if (m_file->m_sparseRanges.empty()) {
-            uint32_t sz = 0;
-            //read the ranges into the buffer
-            for (auto &rng : data->m_ranges) {
-                if (rng.first < m_file->getChannelCount()) {
-                    int toRead = rng.second;
-                    uint64_t doffset = offset;
-                    doffset += rng.first;
-                    seek(doffset, SEEK_SET);
-                    size_t bread = read(&data->m_data[sz], toRead);
-                    if (bread != toRead) {
-                        LogErr(VB_SEQUENCE, "Failed to read channel data!   Needed to read %d but read %d\n", toRead, (int)bread);
-                    }
-                    sz += toRead;
-                }
+
+        uint32_t sz = 0;
+        //read the ranges into the buffer
+        for (int x = 0; x < m_file->m_rangesToRead.size(); x++) {
+            int toRead = m_file->m_rangesToRead[x].second;
+            if (toRead == 0) {
+                continue;
             }
-        } else {
-            size_t bread = read(data->m_data, m_file->m_dataBlockSize);
-            if (bread != m_file->m_dataBlockSize) {
-                LogErr(VB_SEQUENCE, "Failed to read channel data!   Needed to read %d but read %d\n", m_file->m_dataBlockSize, (int)bread);
+            uint64_t doffset = offset;
+            doffset += m_file->m_rangesToReadOffsets[x];
+            if (seek(doffset, SEEK_SET)) {
+                LogErr(VB_SEQUENCE, "Failed to seek to proper offset for channel data! %" PRIu64 "\n", doffset);
+                return false;
+            }
+            size_t bread = read(&buffer[sz], toRead);
+            if (bread != toRead) {
+                LogErr(VB_SEQUENCE, "Failed to read channel data!   Needed to read %d but read %d\n", toRead, (int)bread);
             }
+            sz += toRead;
         }
-        return data;
+        return true;
     }
     virtual void addFrame(uint32_t frame, const uint8_t *data) override {
         if (m_file->m_sparseRanges.empty()) {
@@ -674,17 +844,308 @@ public:
 };
 class V2CompressedHandler : public V2Handler {
 public:
-    V2CompressedHandler(V2FSEQFile *f) : V2Handler(f), m_maxBlocks(0), m_curBlock(99999), m_framesPerBlock(0), m_curFrameInBlock(0) {
+    V2CompressedHandler(V2FSEQFile *f) : V2Handler(f), m_maxBlocks(0), m_curBlock(99999), m_framesPerBlock(0),
+        m_framesInFirstBlock(V2FSEQ_FIRST_BLOCK_FRAMES), m_curFrameInBlock(0),
+        m_blockUseCount(0), m_readAheadBlocks(0), m_readAheadThreads(0), m_shuttingDown(false), m_curJob(nullptr) {
         if (!m_file->m_frameOffsets.empty()) {
             m_maxBlocks = m_file->m_frameOffsets.size() - 1;
+            m_blockStats.resize(m_maxBlocks);
+            for (int x = 0; x < m_maxBlocks; x++) {
+                m_blockStats[x].firstFrame = m_file->m_frameOffsets[x].first;
+                m_blockStats[x].numFrames = getNumFramesInBlock(x);
+                m_blockStats[x].compressedSize = m_file->m_frameOffsets[x + 1].second - m_file->m_frameOffsets[x].second;
+            }
         }
     }
     virtual ~V2CompressedHandler() {}
 
+    // A decompressed block.  The data buffers are reused as blocks are
+    // evicted so once the cache is warm there are no more allocations.
+    class DecompressedBlock {
+    public:
+        DecompressedBlock() : block(0xFFFFFFFF), numFrames(0), framesDecoded(0), lastUse(0), decoding(false), decodeTime(0) {}
+
+        uint32_t block;
+        uint32_t numFrames;
+        uint32_t framesDecoded;
+        uint64_t lastUse;
+        bool     decoding; //being decompressed or queued for a prefetch thread
+        uint64_t decodeTime;
+        std::vector<uint8_t> data;
+    };
+
+    //decompress the block so that at least numFrames frames are available
+    virtual void decompressBlock(DecompressedBlock &block, uint32_t numFrames) = 0;
+
+    //decompress the entire block, called from the prefetch threads so it
+    //can only use the passed in context and read buffer
+    virtual void *createDecompressionContext() { return nullptr; }
+    virtual void freeDecompressionContext(void *ctx) {}
+    virtual void decompressWholeBlock(DecompressedBlock &block, void *ctx, std::vector<uint8_t> &readBuffer) = 0;
+
+    virtual void setReadAhead(uint32_t numBlocks, uint32_t numThreads) override {
+        std::unique_lock<std::mutex> lock(m_blockLock);
+        m_readAheadBlocks = numBlocks;
+        if (m_prefetchThreads.empty()) {
+            uint32_t maxThreads = std::thread::hardware_concurrency();
+            if (maxThreads && numThreads > maxThreads) {
+                numThreads = maxThreads;
+            }
+            m_readAheadThreads = numThreads ? numThreads : 1;
+        }
+    }
+    virtual void getBlockDecodeStats(std::vector<FSEQFile::BlockDecodeStats> &stats) override {
+        std::unique_lock<std::mutex> lock(m_blockLock);
+        stats = m_blockStats;
+    }
+
+    virtual FrameData *getFrame(uint32_t frame) override {
+        UncompressedFrameData *data = new UncompressedFrameData(frame, m_file->m_dataBlockSize, m_file->m_rangesToRead);
+        readFrameData(frame, data->m_data);
+        return data;
+    }
+    virtual bool readFrameData(uint32_t frame, uint8_t *buffer) override {
+        uint32_t numBlocks = m_file->m_frameOffsets.size() - 1;
+        if (m_curBlock >= numBlocks
+            || (frame < m_file->m_frameOffsets[m_curBlock].first)
+            || (frame >= m_file->m_frameOffsets[m_curBlock + 1].first)) {
+            //frame is not in the current block
+            m_curBlock = findBlock(frame);
+        }
+        if (m_curBlock >= numBlocks) {
+            LogErr(VB_SEQUENCE, "Could not find block for frame %d\n", frame);
+            memset(buffer, 0, m_file->m_dataBlockSize);
+            return false;
+        }
+
+        std::unique_lock<std::mutex> lock(m_blockLock);
+        DecompressedBlock &block = *getCachedBlock(m_curBlock, false);
+        uint32_t fidx = frame - m_file->m_frameOffsets[m_curBlock].first;
+        if (fidx >= block.framesDecoded) {
+            FSEQFile::BlockDecodeStats &stats = m_blockStats[m_curBlock];
+            uint64_t start = GetTime();
+            //only a stall if a prefetch was queued or running for this block,
+            //plain incremental decodes (first block, seeks) don't count
+            bool prefetched = block.decoding;
+            auto queued = std::find(m_prefetchQueue.begin(), m_prefetchQueue.end(), &block);
+            if (queued != m_prefetchQueue.end()) {
+                //a prefetch thread hasn't started on it yet, just do it here
+                m_prefetchQueue.erase(queued);
+                block.decoding = false;
+            }
+            while (block.decoding) {
+                m_blockDecodedSignal.wait(lock);
+            }
+            if (fidx >= block.framesDecoded) {
+                if (block.framesDecoded == 0) {
+                    stats.decodeCount++;
+                    block.decodeTime = 0;
+                }
+                block.decoding = true;
+                lock.unlock();
+                uint64_t dstart = GetTime();
+                decompressBlock(block, fidx + 1);
+                uint64_t dtime = GetTime() - dstart;
+                lock.lock();
+                block.decoding = false;
+                block.decodeTime += dtime;
+                stats.totalDecodeTime += dtime;
+                stats.lastDecodeTime = block.decodeTime;
+                if (block.decodeTime > stats.maxDecodeTime) {
+                    stats.maxDecodeTime = block.decodeTime;
+                }
+            }
+            if (prefetched) {
+                stats.stallCount++;
+                stats.stallTime += GetTime() - start;
+            }
+        }
+        lock.unlock();
+
+        uint64_t foffset = fidx;
+        foffset *= m_file->getChannelCount();
+        copyRanges(&block.data[foffset], buffer);
+
+        if (m_readAheadBlocks) {
+            lock.lock();
+            prefetchBlocks(m_curBlock + 1);
+        }
+        return true;
+    }
+
+    //binary search of the block index, the last entry is the end marker
+    uint32_t findBlock(uint32_t frame) {
+        auto &offsets = m_file->m_frameOffsets;
+        if (offsets.size() < 2) {
+            return 0xFFFFFFFF;
+        }
+        auto it = std::upper_bound(offsets.begin(), offsets.end() - 1, frame,
+                                   [](uint32_t f, const std::pair<uint32_t, uint64_t> &p) {
+                                       return f < p.first;
+                                   });
+        if (it == offsets.begin()) {
+            return 0;
+        }
+        return (it - offsets.begin()) - 1;
+    }
+    uint32_t getNumFramesInBlock(uint32_t blockNum) {
+        return (m_file->m_frameOffsets[blockNum + 1].first > m_file->getNumFrames() ? m_file->getNumFrames() :  m_file->m_frameOffsets[blockNum + 1].first) - m_file->m_frameOffsets[blockNum].first;
+    }
+
+    //must be called with m_blockLock held.  For prefetches, this will
+    //return nullptr if the block would not fit in the cache limits.
+    DecompressedBlock *getCachedBlock(uint32_t blockNum, bool prefetch) {
+        m_blockUseCount++;
+        for (auto &b : m_blockCache) {
+            if (b.block == blockNum) {
+                if (!prefetch) {
+                    b.lastUse = m_blockUseCount;
+                }
+                return &b;
+            }
+        }
+        uint32_t numFrames = getNumFramesInBlock(blockNum);
+        uint64_t size = numFrames;
+        size *= m_file->getChannelCount();
+
+        //evict least recently used blocks until the new block fits in the
+        //limits, keeping the largest evicted buffer to reuse for the new block.
+        //Blocks being decompressed and the current block are never evicted.
+        uint32_t maxCount = V2FSEQ_BLOCK_CACHE_COUNT;
+        if (maxCount < (m_readAheadBlocks + 2)) {
+            maxCount = m_readAheadBlocks + 2;
+        }
+        uint64_t cacheSize = size;
+        for (auto &b : m_blockCache) {
+            cacheSize += b.data.size();
+        }
+        std::vector<uint8_t> buffer;
+        while (m_blockCache.size() >= maxCount || cacheSize > V2FSEQ_BLOCK_CACHE_MAX_SIZE) {
+            auto lru = m_blockCache.end();
+            for (auto it = m_blockCache.begin(); it != m_blockCache.end(); ++it) {
+                if (!it->decoding && it->block != m_curBlock
+                    && (lru == m_blockCache.end() || it->lastUse < lru->lastUse)) {
+                    lru = it;
+                }
+            }
+            if (lru == m_blockCache.end()) {
+                break;
+            }
+            cacheSize -= lru->data.size();
+            if (lru->data.capacity() > buffer.capacity()) {
+                buffer.swap(lru->data);
+            }
+            m_blockCache.erase(lru);
+        }
+        if (prefetch && (m_blockCache.size() >= maxCount || cacheSize > V2FSEQ_BLOCK_CACHE_MAX_SIZE)) {
+            return nullptr;
+        }
+        m_blockCache.emplace_back();
+        DecompressedBlock *dest = &m_blockCache.back();
+        dest->data.swap(buffer);
+        dest->block = blockNum;
+        dest->numFrames = numFrames;
+        dest->framesDecoded = 0;
+        dest->lastUse = m_blockUseCount;
+        dest->data.resize(size);
+        return dest;
+    }
+
+    //must be called with m_blockLock held
+    void prefetchBlocks(uint32_t startBlock) {
+        uint32_t numBlocks = m_file->m_frameOffsets.size() - 1;
+        for (uint32_t b = startBlock; b < numBlocks && b < (startBlock + m_readAheadBlocks); b++) {
+            DecompressedBlock *block = getCachedBlock(b, true);
+            if (block == nullptr) {
+                //out of room in the cache
+                return;
+            }
+            if (block->framesDecoded == block->numFrames || block->decoding) {
+                continue;
+            }
+            if (m_prefetchThreads.empty()) {
+                for (uint32_t x = 0; x < m_readAheadThreads; x++) {
+                    m_prefetchThreads.push_back(new std::thread(&V2CompressedHandler::prefetchLoop, this));
+                }
+            }
+            block->decoding = true;
+            m_prefetchQueue.push_back(block);
+            m_prefetchSignal.notify_one();
+        }
+    }
+
+    void prefetchLoop() {
+        void *ctx = createDecompressionContext();
+        std::vector<uint8_t> readBuffer;
+        std::unique_lock<std::mutex> lock(m_blockLock);
+        while (!m_shuttingDown) {
+            if (m_prefetchQueue.empty()) {
+                m_prefetchSignal.wait(lock);
+                continue;
+            }
+            DecompressedBlock *block = m_prefetchQueue.front();
+            m_prefetchQueue.pop_front();
+            lock.unlock();
+
+            uint64_t start = GetTime();
+            decompressWholeBlock(*block, ctx, readBuffer);
+            uint64_t dtime = GetTime() - start;
+
+            lock.lock();
+            block->framesDecoded = block->numFrames;
+            block->decodeTime = dtime;
+            block->decoding = false;
+            FSEQFile::BlockDecodeStats &stats = m_blockStats[block->block];
+            stats.decodeCount++;
+            stats.prefetchCount++;
+            stats.totalDecodeTime += dtime;
+            stats.lastDecodeTime = dtime;
+            if (dtime > stats.maxDecodeTime) {
+                stats.maxDecodeTime = dtime;
+            }
+            m_blockDecodedSignal.notify_all();
+        }
+        lock.unlock();
+        freeDecompressionContext(ctx);
+    }
+
+    //get the compressed data for the block, either directly from the
+    //memory mapped file or read into the given buffer
+    const uint8_t *getCompressedBlock(uint32_t blockNum, uint64_t &len, std::vector<uint8_t> &readBuffer) {
+        uint64_t offset = m_file->m_frameOffsets[blockNum].second;
+        len = m_file->m_frameOffsets[blockNum + 1].second;
+        len -= offset;
+
+        if (blockNum < m_file->m_frameOffsets.size() - 2) {
+            //let the kernel know that we'll likely need the next block in the near future
+            uint64_t len2 = m_file->m_frameOffsets[blockNum + 2].second;
+            len2 -= m_file->m_frameOffsets[blockNum + 1].second;
+            preload(offset + len, len2);
+        }
+
+        const uint8_t *mdata = getMappedData(offset, len);
+        if (mdata) {
+            return mdata;
+        }
+        if (readBuffer.size() < len) {
+            readBuffer.resize(len);
+        }
+        std::unique_lock<std::mutex> lock(m_fileLock);
+        seek(offset, SEEK_SET);
+        uint64_t bread = read(&readBuffer[0], len);
+        if (bread != len) {
+            LogErr(VB_SEQUENCE, "Failed to read channel data for block %d!   Needed to read %" PRIu64 " but read %d\n", blockNum, len, (int)bread);
+        }
+        return &readBuffer[0];
+    }
+
     virtual uint32_t computeMaxBlocks() override {
         if (m_maxBlocks > 0) {
             return m_maxBlocks;
         }
+        if (m_file->m_targetBlockSize) {
+            return computeMaxBlocksForSize(m_file->m_targetBlockSize);
+        }
         //determine a good number of compression blocks
         uint64_t datasize = m_file->getChannelCount() * m_file->getNumFrames();
         uint64_t numBlocks = datasize;
@@ -697,6 +1158,7 @@ public:
         }
         m_framesPerBlock = m_file->getNumFrames() / numBlocks;
         if (m_framesPerBlock < 10) m_framesPerBlock = 10;
+        m_framesInFirstBlock = V2FSEQ_FIRST_BLOCK_FRAMES;
         m_curFrameInBlock = 0;
         m_curBlock = 0;
 
@@ -715,6 +1177,207 @@ public:
         m_curBlock = 0;
         return m_maxBlocks;
     }
+    //size the blocks so each decompresses to roughly targetSize bytes.  Large
+    //frames get small blocks so a seek never has to decode much more than
+    //the target.  If that would need more blocks than the index can hold, the
+    //blocks grow until it fits.
+    uint32_t computeMaxBlocksForSize(uint32_t targetSize) {
+        uint32_t frameSize = m_file->getChannelCount();
+        uint32_t numFrames = m_file->getNumFrames();
+        if (frameSize < 1) {
+            frameSize = 1;
+        }
+        m_framesPerBlock = targetSize / frameSize;
+        if (m_framesPerBlock < 1) {
+            m_framesPerBlock = 1;
+        }
+        m_framesInFirstBlock = std::min(m_framesPerBlock, V2FSEQ_FIRST_BLOCK_FRAMES);
+
+        uint64_t numBlocks = 1;
+        if (numFrames > m_framesInFirstBlock) {
+            uint32_t remaining = numFrames - m_framesInFirstBlock;
+            numBlocks += (remaining + m_framesPerBlock - 1) / m_framesPerBlock;
+            if (numBlocks > V2FSEQ_MAX_BLOCKS) {
+                m_framesPerBlock = (remaining + V2FSEQ_MAX_BLOCKS - 2) / (V2FSEQ_MAX_BLOCKS - 1);
+                numBlocks = 1 + (remaining + m_framesPerBlock - 1) / m_framesPerBlock;
+            }
+        }
+        m_maxBlocks = numBlocks;
+        m_curFrameInBlock = 0;
+        m_curBlock = 0;
+        return m_maxBlocks;
+    }
+    //if we hit the max per block OR we're in the first block and hit the first
+    //block size we'll start a new block.  We want the first block to be small so
+    //startup is quicker and we can get the first few frames as fast as possible.
+    bool isBlockFull() const {
+        if (m_curBlock == 0 && m_curFrameInBlock == m_framesInFirstBlock) {
+            return true;
+        }
+        return m_curFrameInBlock == m_framesPerBlock && (m_curBlock + 1) < m_maxBlocks;
+    }
+
+    // A block of frames to be compressed by the compression threads
+    class CompressionJob {
+    public:
+        CompressionJob() : firstFrame(0), level(0), done(false) {}
+
+        uint32_t firstFrame;
+        int      level;
+        bool     done;
+        std::vector<uint8_t> input;
+        std::vector<uint8_t> output;
+    };
+
+    //compression level to use for the block starting at the given frame
+    virtual int getCompressionLevel(uint32_t firstFrame) = 0;
+
+    //compress an entire block, called from the compression threads
+    virtual void *createCompressionContext() { return nullptr; }
+    virtual void freeCompressionContext(void *ctx) {}
+    virtual void compressBlock(CompressionJob &job, void *ctx) = 0;
+
+    //if true, frames are collected into whole blocks and compressed by the
+    //compression threads instead of streamed through the compressor
+    virtual bool useBlockCompression() const {
+        return m_file->m_compressionThreads > 1;
+    }
+    int getCompressionThreadCount() const {
+        return std::max(1, m_file->m_compressionThreads);
+    }
+
+    //Blocks are independent so with multiple threads, the frames for a
+    //block are collected and the block is handed off to a compression thread.
+    //The compressed blocks are written out in order as they complete.
+    void addFrameThreaded(uint32_t frame, const uint8_t *data) {
+        if (m_curJob == nullptr) {
+            std::unique_lock<std::mutex> lock(m_compressLock);
+            if (m_freeJobs.empty()) {
+                m_curJob = new CompressionJob();
+            } else {
+                m_curJob = m_freeJobs.front();
+                m_freeJobs.pop_front();
+            }
+            lock.unlock();
+            m_curJob->firstFrame = frame;
+            m_curJob->level = getCompressionLevel(frame);
+            m_curJob->done = false;
+            m_curJob->input.clear();
+        }
+        if (m_file->m_sparseRanges.empty()) {
+            m_curJob->input.insert(m_curJob->input.end(), data, data + m_file->getChannelCount());
+        } else {
+            for (auto &a : m_file->m_sparseRanges) {
+                m_curJob->input.insert(m_curJob->input.end(), &data[a.first], &data[a.first + a.second]);
+            }
+        }
+        m_curFrameInBlock++;
+        if (isBlockFull()) {
+            queueCompressionJob();
+            m_curFrameInBlock = 0;
+            m_curBlock++;
+        }
+    }
+    void finalizeThreaded() {
+        if (m_curFrameInBlock) {
+            queueCompressionJob();
+            m_curFrameInBlock = 0;
+            m_curBlock++;
+        }
+        std::unique_lock<std::mutex> lock(m_compressLock);
+        writeCompressedBlocks(lock, 0);
+    }
+    void queueCompressionJob() {
+        std::unique_lock<std::mutex> lock(m_compressLock);
+        if (m_compressThreads.empty()) {
+            for (int x = 0; x < getCompressionThreadCount(); x++) {
+                m_compressThreads.push_back(new std::thread(&V2CompressedHandler::compressLoop, this));
+            }
+        }
+        m_pendingJobs.push_back(m_curJob);
+        m_compressJobs.push_back(m_curJob);
+        m_curJob = nullptr;
+        m_compressSignal.notify_one();
+
+        //keep all the threads busy, but don't let too many blocks pile up
+        writeCompressedBlocks(lock, getCompressionThreadCount() * 2);
+    }
+    //write completed blocks in order, waiting until at most maxInFlight remain
+    void writeCompressedBlocks(std::unique_lock<std::mutex> &lock, int maxInFlight) {
+        while (!m_compressJobs.empty()) {
+            CompressionJob *job = m_compressJobs.front();
+            if (!job->done) {
+                if (m_compressJobs.size() <= (size_t)maxInFlight) {
+                    return;
+                }
+                m_compressDoneSignal.wait(lock);
+                continue;
+            }
+            m_compressJobs.pop_front();
+            lock.unlock();
+            uint64_t offset = tell();
+            m_file->m_frameOffsets.push_back(std::pair<uint32_t, uint64_t>(job->firstFrame, offset));
+            write(&job->output[0], job->output.size());
+            lock.lock();
+            m_freeJobs.push_back(job);
+        }
+    }
+    void compressLoop() {
+        void *ctx = createCompressionContext();
+        std::unique_lock<std::mutex> lock(m_compressLock);
+        while (!m_shuttingDown) {
+            if (m_pendingJobs.empty()) {
+                m_compressSignal.wait(lock);
+                continue;
+            }
+            CompressionJob *job = m_pendingJobs.front();
+            m_pendingJobs.pop_front();
+            lock.unlock();
+            compressBlock(*job, ctx);
+            lock.lock();
+            job->done = true;
+            m_compressDoneSignal.notify_all();
+        }
+        lock.unlock();
+        freeCompressionContext(ctx);
+    }
+
+    //stop the prefetch and compression threads, must be called from the
+    //destructor of the subclasses as the threads call their methods
+    void stopThreads() {
+        std::unique_lock<std::mutex> lock(m_blockLock);
+        m_shuttingDown = true;
+        m_prefetchQueue.clear();
+        lock.unlock();
+        m_prefetchSignal.notify_all();
+        for (auto t : m_prefetchThreads) {
+            t->join();
+            delete t;
+        }
+        m_prefetchThreads.clear();
+
+        std::unique_lock<std::mutex> clock(m_compressLock);
+        m_pendingJobs.clear();
+        clock.unlock();
+        m_compressSignal.notify_all();
+        for (auto t : m_compressThreads) {
+            t->join();
+            delete t;
+        }
+        m_compressThreads.clear();
+        for (auto j : m_compressJobs) {
+            delete j;
+        }
+        m_compressJobs.clear();
+        for (auto j : m_freeJobs) {
+            delete j;
+        }
+        m_freeJobs.clear();
+        if (m_curJob) {
+            delete m_curJob;
+            m_curJob = nullptr;
+        }
+    }
 
     virtual void finalize() override {
         uint64_t curr = tell();
@@ -741,9 +1404,37 @@ public:
 
     // for compressed files, this is the compression data
     uint32_t m_framesPerBlock;
+    uint32_t m_framesInFirstBlock;
     uint32_t m_curFrameInBlock;
     uint32_t m_curBlock;
     uint32_t m_maxBlocks;
+
+    // for reading, the recently decompressed blocks
+    std::list<DecompressedBlock> m_blockCache;
+    uint64_t m_blockUseCount;
+    std::vector<uint8_t> m_readBuffer;
+    std::vector<FSEQFile::BlockDecodeStats> m_blockStats;
+
+    // blocks queued for the prefetch threads to decompress
+    uint32_t m_readAheadBlocks;
+    uint32_t m_readAheadThreads;
+    volatile bool m_shuttingDown;
+    std::list<DecompressedBlock*> m_prefetchQueue;
+    std::vector<std::thread*> m_prefetchThreads;
+    std::mutex m_blockLock;
+    std::mutex m_fileLock;
+    std::condition_variable m_prefetchSignal;
+    std::condition_variable m_blockDecodedSignal;
+
+    // for writing with multiple compression threads
+    CompressionJob *m_curJob;
+    std::list<CompressionJob*> m_pendingJobs; //waiting for a compression thread
+    std::list<CompressionJob*> m_compressJobs; //all jobs not yet written, in order
+    std::list<CompressionJob*> m_freeJobs;
+    std::vector<std::thread*> m_compressThreads;
+    std::mutex m_compressLock;
+    std::condition_variable m_compressSignal;
+    std::condition_variable m_compressDoneSignal;
 };
 
 #ifndef NO_ZSTD
@@ -751,7 +1442,10 @@ class V2ZSTDCompressionHandler : public V2CompressedHandler {
 public:
     V2ZSTDCompressionHandler(V2FSEQFile *f) : V2CompressedHandler(f),
     m_cctx(nullptr),
-    m_dctx(nullptr)
+    m_dctx(nullptr),
+    m_blockDctx(nullptr),
+    m_ddict(nullptr),
+    m_streamBlock(0xFFFFFFFF)
     {
         m_outBuffer.pos = 0;
         m_outBuffer.size = V2FSEQ_OUT_BUFFER_SIZE;
@@ -759,87 +1453,95 @@ public:
         m_inBuffer.src = nullptr;
         m_inBuffer.size = 0;
         m_inBuffer.pos = 0;
+        if (!m_file->m_compressionDictionary.empty()) {
+            m_ddict = ZSTD_createDDict(&m_file->m_compressionDictionary[0], m_file->m_compressionDictionary.size());
+            if (m_ddict == nullptr) {
+                LogErr(VB_SEQUENCE, "Could not load the zstd dictionary\n");
+            }
+        }
     }
     virtual ~V2ZSTDCompressionHandler() {
+        stopThreads();
         free(m_outBuffer.dst);
-        if (m_inBuffer.src != nullptr) {
-            free((void*)m_inBuffer.src);
-        }
-        if (m_dctx) {
+        if (m_cctx) {
             ZSTD_freeCStream(m_cctx);
         }
         if (m_dctx) {
             ZSTD_freeDStream(m_dctx);
         }
+        if (m_blockDctx) {
+            ZSTD_freeDCtx(m_blockDctx);
+        }
+        if (m_ddict) {
+            ZSTD_freeDDict(m_ddict);
+        }
+        for (auto &a : m_cdicts) {
+            ZSTD_freeCDict(a.second);
+        }
     }
     virtual uint8_t getCompressionType() override { return 1;}
     virtual std::string GetType() const override { return "Compressed ZSTD"; }
 
-    virtual FrameData *getFrame(uint32_t frame) override {
-        if (m_curBlock > 256 || (frame < m_file->m_frameOffsets[m_curBlock].first) || (frame >= m_file->m_frameOffsets[m_curBlock + 1].first)) {
-            //frame is not in the current block
-            m_curBlock = 0;
-            while (frame >= m_file->m_frameOffsets[m_curBlock + 1].first) {
-                m_curBlock++;
-            }
-            if (m_dctx == nullptr) {
-                m_dctx = ZSTD_createDStream();
-            }
-            ZSTD_initDStream(m_dctx);
-            seek(m_file->m_frameOffsets[m_curBlock].second, SEEK_SET);
-
-            uint64_t len = m_file->m_frameOffsets[m_curBlock + 1].second;
-            len -= m_file->m_frameOffsets[m_curBlock].second;
-            if (m_inBuffer.src) {
-                free((void*)m_inBuffer.src);
+    virtual void decompressBlock(DecompressedBlock &block, uint32_t numFrames) override {
+        if (m_ddict) {
+            //the streaming API can't reference a dictionary on older zstd
+            //versions, blocks with a dictionary are decompressed in their entirety
+            if (m_blockDctx == nullptr) {
+                m_blockDctx = ZSTD_createDCtx();
             }
-            m_inBuffer.src = malloc(len);
-            m_inBuffer.pos = 0;
+            decompressWholeBlock(block, m_blockDctx, m_readBuffer);
+            block.framesDecoded = block.numFrames;
+            return;
+        }
+        if (m_dctx == nullptr) {
+            m_dctx = ZSTD_createDStream();
+        }
+        if (m_streamBlock != block.block || block.framesDecoded == 0) {
+            //not continuing the block the stream is on, start over
+            uint64_t len = 0;
+            m_inBuffer.src = getCompressedBlock(block.block, len, m_readBuffer);
             m_inBuffer.size = len;
-            int bread = read((void*)m_inBuffer.src, len);
-            if (bread != len) {
-                LogErr(VB_SEQUENCE, "Failed to read channel data for frame %d!   Needed to read %" PRIu64 " but read %d\n", frame, len, (int)bread);
-            }
-
-            if (m_curBlock < m_file->m_frameOffsets.size() - 2) {
-                //let the kernel know that we'll likely need the next block in the near future
-                uint64_t len2 = m_file->m_frameOffsets[m_curBlock + 2].second;
-                len2 -= m_file->m_frameOffsets[m_curBlock+1].second;
-                preload(tell(), len2);
+            m_inBuffer.pos = 0;
+            ZSTD_initDStream(m_dctx);
+            m_streamBlock = block.block;
+            block.framesDecoded = 0;
+        }
+        ZSTD_outBuffer_s out = {
+            &block.data[0],
+            numFrames * (size_t)m_file->getChannelCount(),
+            block.framesDecoded * (size_t)m_file->getChannelCount()
+        };
+        while (out.pos < out.size && m_inBuffer.pos < m_inBuffer.size) {
+            size_t ret = ZSTD_decompressStream(m_dctx, &out, &m_inBuffer);
+            if (ZSTD_isError(ret)) {
+                LogErr(VB_SEQUENCE, "Error decompressing block %d: %s\n", block.block, ZSTD_getErrorName(ret));
+                break;
             }
-
-            free(m_outBuffer.dst);
-            m_numFramesInBlock = (m_file->m_frameOffsets[m_curBlock + 1].first > m_file->getNumFrames() ? m_file->getNumFrames() :  m_file->m_frameOffsets[m_curBlock + 1].first) - m_file->m_frameOffsets[m_curBlock].first;
-            m_outBuffer.size = m_numFramesInBlock * m_file->getChannelCount();
-            m_outBuffer.dst = malloc(m_outBuffer.size);
-            m_outBuffer.pos = 0;
-            m_curFrameInBlock = 0;
-            
         }
-        int fidx = frame - m_file->m_frameOffsets[m_curBlock].first;
-        if (fidx >= m_curFrameInBlock) {
-            m_outBuffer.size = (fidx + 1) * m_file->getChannelCount();
-            int opos = m_outBuffer.pos;
-            ZSTD_decompressStream(m_dctx, &m_outBuffer, &m_inBuffer);
-            m_curFrameInBlock = fidx + 1;
+        if (out.pos < out.size) {
+            LogErr(VB_SEQUENCE, "Could not decompress frames for block %d.  Needed %d bytes but got %d\n",
+                   block.block, (int)out.size, (int)out.pos);
         }
-        
-        fidx *= m_file->getChannelCount();
-        uint8_t *fdata = (uint8_t*)m_outBuffer.dst;
-        UncompressedFrameData *data = new UncompressedFrameData(frame, m_file->m_dataBlockSize, m_file->m_rangesToRead);
-        if (!m_file->m_sparseRanges.empty()) {
-            memcpy(data->m_data, &fdata[fidx], m_file->getChannelCount());
+        block.framesDecoded = numFrames;
+    }
+    virtual void *createDecompressionContext() override {
+        return ZSTD_createDCtx();
+    }
+    virtual void freeDecompressionContext(void *ctx) override {
+        ZSTD_freeDCtx((ZSTD_DCtx*)ctx);
+    }
+    virtual void decompressWholeBlock(DecompressedBlock &block, void *ctx, std::vector<uint8_t> &readBuffer) override {
+        uint64_t len = 0;
+        const uint8_t *src = getCompressedBlock(block.block, len, readBuffer);
+        size_t ret;
+        if (m_ddict) {
+            ret = ZSTD_decompress_usingDDict((ZSTD_DCtx*)ctx, &block.data[0], block.data.size(), src, len, m_ddict);
         } else {
-            uint32_t sz = 0;
-            //read the ranges into the buffer
-            for (auto &rng : data->m_ranges) {
-                if (rng.first < m_file->getChannelCount()) {
-                    memcpy(&data->m_data[sz], &fdata[fidx + rng.first], rng.second);
-                    sz += rng.second;
-                }
-            }
+            ret = ZSTD_decompressDCtx((ZSTD_DCtx*)ctx, &block.data[0], block.data.size(), src, len);
+        }
+        if (ZSTD_isError(ret)) {
+            LogErr(VB_SEQUENCE, "Error decompressing block %d: %s\n", block.block, ZSTD_getErrorName(ret));
         }
-        return data;
     }
     void compressData(ZSTD_CStream* m_cctx, ZSTD_inBuffer_s &input, ZSTD_outBuffer_s &output) {
         ZSTD_compressStream(m_cctx, &output, &input);
@@ -860,7 +1562,65 @@ public:
             count += input.pos;
         }
     }
+    virtual int getCompressionLevel(uint32_t firstFrame) override {
+        int clevel = m_file->m_compressionLevel == -1 ? 10 : m_file->m_compressionLevel;
+        if (clevel < 0 || clevel > 25) {
+            clevel = 10;
+        }
+        if (firstFrame == 0 && (ZSTD_versionNumber() > 10305)) {
+            // first frame needs to be grabbed as fast as possible
+            // or remotes may be off by a few frames at start.  Thus,
+            // if using recent zstd, we'll use the negative levels
+            // for the first block so the decompression can
+            // be as fast as possible
+            clevel = -10;
+        }
+        return clevel;
+    }
+    virtual void *createCompressionContext() override {
+        return ZSTD_createCCtx();
+    }
+    virtual void freeCompressionContext(void *ctx) override {
+        ZSTD_freeCCtx((ZSTD_CCtx*)ctx);
+    }
+    virtual bool useBlockCompression() const override {
+        //like the decompression, the dictionary is only used for whole blocks
+        return V2CompressedHandler::useBlockCompression() || !m_file->m_compressionDictionary.empty();
+    }
+    //the digested dictionary for a compression level, shared by the compression threads
+    ZSTD_CDict *getCompressionDictionary(int level) {
+        std::unique_lock<std::mutex> lock(m_cdictLock);
+        ZSTD_CDict *&cdict = m_cdicts[level];
+        if (cdict == nullptr) {
+            cdict = ZSTD_createCDict(&m_file->m_compressionDictionary[0], m_file->m_compressionDictionary.size(), level);
+        }
+        return cdict;
+    }
+    virtual void compressBlock(CompressionJob &job, void *ctx) override {
+        job.output.resize(ZSTD_compressBound(job.input.size()));
+        ZSTD_CDict *cdict = nullptr;
+        if (!m_file->m_compressionDictionary.empty()) {
+            cdict = getCompressionDictionary(job.level);
+        }
+        size_t ret;
+        if (cdict) {
+            ret = ZSTD_compress_usingCDict((ZSTD_CCtx*)ctx, &job.output[0], job.output.size(),
+                                           &job.input[0], job.input.size(), cdict);
+        } else {
+            ret = ZSTD_compressCCtx((ZSTD_CCtx*)ctx, &job.output[0], job.output.size(),
+                                    &job.input[0], job.input.size(), job.level);
+        }
+        if (ZSTD_isError(ret)) {
+            LogErr(VB_SEQUENCE, "Error compressing block at frame %d: %s\n", job.firstFrame, ZSTD_getErrorName(ret));
+            ret = 0;
+        }
+        job.output.resize(ret);
+    }
     virtual void addFrame(uint32_t frame, const uint8_t *data) override {
+        if (useBlockCompression()) {
+            addFrameThreaded(frame, data);
+            return;
+        }
 
         if (m_cctx == nullptr) {
             m_cctx = ZSTD_createCStream();
@@ -868,19 +1628,7 @@ public:
         if (m_curFrameInBlock == 0) {
             uint64_t offset = tell();
             m_file->m_frameOffsets.push_back(std::pair<uint32_t, uint64_t>(frame, offset));
-            int clevel = m_file->m_compressionLevel == -1 ? 10 : m_file->m_compressionLevel;
-            if (clevel < 0 || clevel > 25) {
-                clevel = 10;
-            }
-            if (frame == 0 && (ZSTD_versionNumber() > 10305)) {
-                // first frame needs to be grabbed as fast as possible
-                // or remotes may be off by a few frames at start.  Thus,
-                // if using recent zstd, we'll use the negative levels
-                // for the first block so the decompression can
-                // be as fast as possible
-                clevel = -10;
-            }
-            ZSTD_initCStream(m_cctx, clevel);
+            ZSTD_initCStream(m_cctx, getCompressionLevel(frame));
         }
 
         uint8_t *curData = (uint8_t *)data;
@@ -909,11 +1657,7 @@ public:
         }
 
         m_curFrameInBlock++;
-        //if we hit the max per block OR we're in the first block and hit frame #10
-        //we'll start a new block.  We want the first block to be small so startup is
-        //quicker and we can get the first few frames as fast as possible.
-        if ((m_curBlock == 0 && m_curFrameInBlock == 10)
-            || (m_curFrameInBlock == m_framesPerBlock && m_file->m_frameOffsets.size() < m_maxBlocks)) {
+        if (isBlockFull()) {
             while(ZSTD_endStream(m_cctx, &m_outBuffer) > 0) {
                 write(m_outBuffer.dst, m_outBuffer.pos);
                 m_outBuffer.pos = 0;
@@ -925,7 +1669,9 @@ public:
         }
     }
     virtual void finalize() override {
-        if (m_curFrameInBlock) {
+        if (useBlockCompression()) {
+            finalizeThreaded();
+        } else if (m_curFrameInBlock) {
             while(ZSTD_endStream(m_cctx, &m_outBuffer) > 0) {
                 write(m_outBuffer.dst, m_outBuffer.pos);
                 m_outBuffer.pos = 0;
@@ -940,95 +1686,74 @@ public:
 
     ZSTD_CStream* m_cctx;
     ZSTD_DStream* m_dctx;
+    ZSTD_DCtx* m_blockDctx;
+    ZSTD_DDict* m_ddict;
+    std::map<int, ZSTD_CDict*> m_cdicts;
+    std::mutex m_cdictLock;
     ZSTD_outBuffer_s m_outBuffer;
     ZSTD_inBuffer_s m_inBuffer;
-    int m_numFramesInBlock;
-    int m_curFrameInBlock;
+    uint32_t m_streamBlock;
 };
 #endif
 
 #ifndef NO_ZLIB
 class V2ZLIBCompressionHandler : public V2CompressedHandler {
 public:
-    V2ZLIBCompressionHandler(V2FSEQFile *f) : V2CompressedHandler(f), m_stream(nullptr), m_outBuffer(nullptr), m_inBuffer(nullptr) {
+    V2ZLIBCompressionHandler(V2FSEQFile *f) : V2CompressedHandler(f), m_stream(nullptr), m_outBuffer(nullptr) {
     }
     virtual ~V2ZLIBCompressionHandler() {
+        stopThreads();
         if (m_outBuffer) {
             free(m_outBuffer);
         }
-        if (m_inBuffer) {
-            free(m_inBuffer);
+        if (m_stream) {
+            deflateEnd(m_stream);
+            free(m_stream);
         }
     }
     virtual uint8_t getCompressionType() override { return 2; }
     virtual std::string GetType() const override { return "Compressed ZLIB"; }
 
-    virtual FrameData *getFrame(uint32_t frame) override {
-        if (m_curBlock > 256 || (frame < m_file->m_frameOffsets[m_curBlock].first) || (frame >= m_file->m_frameOffsets[m_curBlock + 1].first)) {
-            //frame is not in the current block
-            m_curBlock = 0;
-            while (frame >= m_file->m_frameOffsets[m_curBlock + 1].first) {
-                m_curBlock++;
-            }
-            seek(m_file->m_frameOffsets[m_curBlock].second, SEEK_SET);
-            uint64_t len = m_file->m_frameOffsets[m_curBlock + 1].second;
-            len -= m_file->m_frameOffsets[m_curBlock].second;
-            if (m_inBuffer) {
-                free(m_inBuffer);
-            }
-            m_inBuffer = (uint8_t*)malloc(len);
-
-            int bread = read((void*)m_inBuffer, len);
-            if (bread != len) {
-                LogErr(VB_SEQUENCE, "Failed to read channel data for frame %d!   Needed to read %" PRIu64 " but read %d\n", frame, len, (int)bread);
-            }
-
-            if (m_curBlock < m_file->m_frameOffsets.size() - 2) {
-                //let the kernel know that we'll likely need the next block in the near future
-                uint64_t len = m_file->m_frameOffsets[m_curBlock + 2].second;
-                len -= m_file->m_frameOffsets[m_curBlock+1].second;
-                preload(tell(), len);
-            }
-
-            if (m_stream == nullptr) {
-                m_stream = (z_stream*)calloc(1, sizeof(z_stream));
-                m_stream->next_in = m_inBuffer;
-                m_stream->avail_in = len;
-                inflateInit(m_stream);
-            }
-            if (m_outBuffer != nullptr) {
-                free(m_outBuffer);
-            }
-            int numFrames = (m_file->m_frameOffsets[m_curBlock + 1].first > m_file->getNumFrames() ? m_file->getNumFrames() :  m_file->m_frameOffsets[m_curBlock + 1].first) - m_file->m_frameOffsets[m_curBlock].first;
-            int outsize = numFrames * m_file->getChannelCount();
-            m_outBuffer = (uint8_t*)malloc(outsize);
-            m_stream->next_out = m_outBuffer;
-            m_stream->avail_out = outsize;
-
-            inflate(m_stream, Z_SYNC_FLUSH);
-            inflateEnd(m_stream);
-            free(m_stream);
-            m_stream = nullptr;
+    virtual void decompressBlock(DecompressedBlock &block, uint32_t numFrames) override {
+        //zlib blocks are always decompressed in their entirety
+        decompressWholeBlock(block, nullptr, m_readBuffer);
+        block.framesDecoded = block.numFrames;
+    }
+    virtual void decompressWholeBlock(DecompressedBlock &block, void *ctx, std::vector<uint8_t> &readBuffer) override {
+        uint64_t len = 0;
+        const uint8_t *src = getCompressedBlock(block.block, len, readBuffer);
+
+        z_stream stream;
+        memset(&stream, 0, sizeof(stream));
+        stream.next_in = (Bytef*)src;
+        stream.avail_in = len;
+        inflateInit(&stream);
+        stream.next_out = &block.data[0];
+        stream.avail_out = block.data.size();
+        inflate(&stream, Z_SYNC_FLUSH);
+        inflateEnd(&stream);
+    }
+    virtual int getCompressionLevel(uint32_t firstFrame) override {
+        int clevel = m_file->m_compressionLevel == -1 ? 3 : m_file->m_compressionLevel;
+        if (clevel < 0 || clevel > 9) {
+            clevel = 3;
         }
-        int fidx = frame - m_file->m_frameOffsets[m_curBlock].first;
-        fidx *= m_file->getChannelCount();
-        uint8_t *fdata = (uint8_t*)m_outBuffer;
-        UncompressedFrameData *data = new UncompressedFrameData(frame, m_file->m_dataBlockSize, m_file->m_rangesToRead);
-        if (!m_file->m_sparseRanges.empty()) {
-            memcpy(data->m_data, &fdata[fidx], m_file->getChannelCount());
-        } else {
-            uint32_t sz = 0;
-            //read the ranges into the buffer
-            for (auto &rng : data->m_ranges) {
-                if (rng.first < m_file->getChannelCount()) {
-                    memcpy(&data->m_data[sz], &fdata[fidx + rng.first], rng.second);
-                    sz += rng.second;
-                }
-            }
+        return clevel;
+    }
+    virtual void compressBlock(CompressionJob &job, void *ctx) override {
+        uLongf len = compressBound(job.input.size());
+        job.output.resize(len);
+        if (compress2(&job.output[0], &len, &job.input[0], job.input.size(), job.level) != Z_OK) {
+            LogErr(VB_SEQUENCE, "Error compressing block at frame %d\n", job.firstFrame);
+            len = 0;
         }
-        return data;
+        job.output.resize(len);
     }
     virtual void addFrame(uint32_t frame, const uint8_t *data) override {
+        if (useBlockCompression()) {
+            addFrameThreaded(frame, data);
+            return;
+        }
         if (m_outBuffer == nullptr) {
             m_outBuffer = (uint8_t*)malloc(V2FSEQ_OUT_BUFFER_SIZE);
         }
@@ -1042,11 +1767,7 @@ public:
             memset(m_stream, 0, sizeof(z_stream));
         }
         if (m_curFrameInBlock == 0) {
-            int clevel = m_file->m_compressionLevel == -1 ? 3 : m_file->m_compressionLevel;
-            if (clevel < 0 || clevel > 9) {
-                clevel = 3;
-            }
-            deflateInit(m_stream, clevel);
+            deflateInit(m_stream, getCompressionLevel(frame));
             m_stream->next_out = m_outBuffer;
             m_stream->avail_out = V2FSEQ_OUT_BUFFER_SIZE;
         }
@@ -1072,11 +1793,7 @@ public:
             m_stream->avail_out = V2FSEQ_OUT_BUFFER_SIZE;
         }
         m_curFrameInBlock++;
-        //if we hit the max per block OR we're in the first block and hit frame #10
-        //we'll start a new block.  We want the first block to be small so startup is
-        //quicker and we can get the first few frames as fast as possible.
-        if ((m_curBlock == 0 && m_curFrameInBlock == 10)
-            || (m_curFrameInBlock == m_framesPerBlock && m_file->m_frameOffsets.size() < m_maxBlocks)) {
+        if (isBlockFull()) {
 
             while (deflate(m_stream, Z_FINISH) != Z_STREAM_END) {
                 uint64_t sz = V2FSEQ_OUT_BUFFER_SIZE;
@@ -1096,7 +1813,9 @@ public:
         }
     }
     virtual void finalize() override {
-        if (m_curFrameInBlock) {
+        if (useBlockCompression()) {
+            finalizeThreaded();
+        } else if (m_curFrameInBlock) {
             while (deflate(m_stream, Z_FINISH) != Z_STREAM_END) {
                 uint64_t sz = V2FSEQ_OUT_BUFFER_SIZE;
                 sz -= m_stream->avail_out;
@@ -1118,7 +1837,6 @@ public:
 
     z_stream *m_stream;
     uint8_t *m_outBuffer;
-    uint8_t *m_inBuffer;
 };
 #endif
 
@@ -1153,12 +1871,67 @@ V2FSEQFile::V2FSEQFile(const std::string &fn, CompressionType ct, int cl)
     : FSEQFile(fn),
     m_compressionType(ct),
     m_compressionLevel(cl),
+    m_compressionThreads(1),
+    m_targetBlockSize(0),
     m_handler(nullptr)
 {
     m_seqVersionMajor = 2;
     m_seqVersionMinor = 0;
     createHandler();
 }
+void V2FSEQFile::initializeFromFSEQ(const FSEQFile& fseq) {
+    FSEQFile::initializeFromFSEQ(fseq);
+    //the source dictionary doesn't apply to the data we'll be writing
+    for (auto it = m_variableHeaders.begin(); it != m_variableHeaders.end(); ) {
+        if (it->code[0] == 'z' && it->code[1] == 'd') {
+            it = m_variableHeaders.erase(it);
+        } else {
+            ++it;
+        }
+    }
+    if (!m_compressionDictionary.empty()) {
+        setCompressionDictionary(m_compressionDictionary);
+    }
+}
+void V2FSEQFile::setCompressionDictionary(const std::vector<uint8_t> &dict) {
+    if (!dict.empty() && m_compressionType != CompressionType::zstd) {
+        LogWarn(VB_SEQUENCE, "Compression dictionaries are only supported for zstd compression\n");
+        return;
+    }
+    m_compressionDictionary = dict;
+    for (auto it = m_variableHeaders.begin(); it != m_variableHeaders.end(); ) {
+        if (it->code[0] == 'z' && it->code[1] == 'd') {
+            it = m_variableHeaders.erase(it);
+        } else {
+            ++it;
+        }
+    }
+    if (!m_compressionDictionary.empty()) {
+        VariableHeader header;
+        header.code[0] = 'z';
+        header.code[1] = 'd';
+        header.data = m_compressionDictionary;
+        m_variableHeaders.push_back(header);
+    }
+}
+std::vector<uint8_t> V2FSEQFile::trainCompressionDictionary(const std::vector<uint8_t> &samples,
+                                                            const std::vector<size_t> &sampleSizes,
+                                                            uint32_t dictSize) {
+    std::vector<uint8_t> dict;
+#ifndef NO_ZSTD
+    if (samples.empty() || sampleSizes.empty() || dictSize == 0) {
+        return dict;
+    }
+    dict.resize(dictSize);
+    size_t ret = ZDICT_trainFromBuffer(&dict[0], dictSize, &samples[0], &sampleSizes[0], sampleSizes.size());
+    if (ZDICT_isError(ret)) {
+        LogWarn(VB_SEQUENCE, "Could not train compression dictionary: %s\n", ZDICT_getErrorName(ret));
+        ret = 0;
+    }
+    dict.resize(ret);
+#endif
+    return dict;
+}
 void V2FSEQFile::writeHeader() {
     if (!m_sparseRanges.empty()) {
         //make sure the sparse ranges fit, and then
@@ -1210,8 +1983,9 @@ void V2FSEQFile::writeHeader() {
     memcpy(&header[24], &m_uniqueId, sizeof(m_uniqueId));
 
     // index size
-    uint32_t maxBlocks = m_handler->computeMaxBlocks() & 0xFF;
-    header[21] = maxBlocks;
+    uint32_t maxBlocks = m_handler->computeMaxBlocks() & V2FSEQ_MAX_BLOCKS;
+    header[21] = maxBlocks & 0xFF;
+    header[20] |= (maxBlocks >> 4) & 0xF0;
 
     int headerSize = V2FSEQ_HEADER_SIZE + maxBlocks * 8 + m_sparseRanges.size() * 6;
 
@@ -1223,6 +1997,22 @@ void V2FSEQFile::writeHeader() {
         dataOffset += a.data.size() + 4;
     }
     dataOffset = roundTo4(dataOffset);
+    if (dataOffset > 0xFFFF && !m_compressionDictionary.empty()) {
+        //the data offset is only 2 bytes, the dictionary has to go
+        LogWarn(VB_SEQUENCE, "Compression dictionary of %d bytes does not fit in the header, not using it\n",
+                (int)m_compressionDictionary.size());
+        setCompressionDictionary(std::vector<uint8_t>());
+        dataOffset = headerSize;
+        for (auto &a : m_variableHeaders) {
+            dataOffset += a.data.size() + 4;
+        }
+        dataOffset = roundTo4(dataOffset);
+    }
+    if (maxBlocks > 255 || !m_compressionDictionary.empty()) {
+        //readers older than 2.1 can't handle the larger index or the dictionary
+        header[6] = 1;
+    }
+    m_seqVersionMinor = header[6];
     write2ByteUInt(&header[4], dataOffset);
     m_seqChanDataOffset = dataOffset;
 
@@ -1260,6 +2050,9 @@ void V2FSEQFile::writeHeader() {
 V2FSEQFile::V2FSEQFile(const std::string &fn, FILE *file, const std::vector<uint8_t> &header)
 : FSEQFile(fn, file, header),
 m_compressionType(none),
+m_compressionLevel(-1),
+m_compressionThreads(1),
+m_targetBlockSize(0),
 m_handler(nullptr)
 {
     if (header[0] == 'E') {
@@ -1274,7 +2067,8 @@ m_handler(nullptr)
         uint64_t *a = (uint64_t*)&header[24];
         m_uniqueId = *a;
         
-        switch (header[20]) {
+        //upper 4 bits of the compression type are the upper bits of the block count
+        switch (header[20] & 0x0F) {
             case 0:
             m_compressionType = CompressionType::none;
             break;
@@ -1285,10 +2079,10 @@ m_handler(nullptr)
             m_compressionType = CompressionType::zlib;
             break;
             default:
-            LogErr(VB_SEQUENCE, "Unknown compression type: %d", (int)header[32]);
+            LogErr(VB_SEQUENCE, "Unknown compression type: %d", (int)(header[20] & 0x0F));
         }
         
-        uint32_t maxBlocks = header[21];
+        uint32_t maxBlocks = header[21] | ((header[20] & 0xF0) << 4);
         
         uint64_t offset = m_seqChanDataOffset;
         int hoffset = V2FSEQ_HEADER_SIZE;
@@ -1316,7 +2110,13 @@ m_handler(nullptr)
             m_sparseRanges.push_back(std::pair<uint32_t, uint32_t>(st, len));
         }
         parseVariableHeaders(header, hoffset);
+        for (auto &a : m_variableHeaders) {
+            if (a.code[0] == 'z' && a.code[1] == 'd') {
+                m_compressionDictionary = a.data;
+            }
+        }
     }
+    mapFile();
 
     createHandler();
 }
@@ -1335,6 +2135,7 @@ void V2FSEQFile::dumpInfo(bool indent) {
     LogDebug(VB_SEQUENCE, "%sSequence File Information\n", ind);
     LogDebug(VB_SEQUENCE, "%scompressionType       : %d\n", ind, m_compressionType);
     LogDebug(VB_SEQUENCE, "%snumBlocks             : %d\n", ind, m_handler->computeMaxBlocks());
+    LogDebug(VB_SEQUENCE, "%sdictionarySize        : %d\n", ind, (int)m_compressionDictionary.size());
     for (auto &a : m_frameOffsets) {
         LogDebug(VB_SEQUENCE, "%s      %d              : %" PRIu64 "\n", ind, a.first, a.second);
     }
@@ -1346,32 +2147,41 @@ void V2FSEQFile::dumpInfo(bool indent) {
 
 
 void V2FSEQFile::prepareRead(const std::vector<std::pair<uint32_t, uint32_t>> &ranges) {
+    m_rangesToReadOffsets.clear();
     if (m_sparseRanges.empty()) {
-        m_rangesToRead = ranges;
-        m_dataBlockSize = 0;
+        m_dataBlockSize = clipRanges(ranges, m_seqChannelCount, m_rangesToRead);
         for (auto &rng : m_rangesToRead) {
-            //make sure we don't read beyond the end of the sequence data
-            int toRead = rng.second;
-            if ((rng.first + toRead) > m_seqChannelCount) {
-                toRead = m_seqChannelCount - rng.first;
-                rng.second = toRead;
-            }
-            m_dataBlockSize += toRead;
-        }
-    } else if (m_compressionType != CompressionType::none) {
-        //with compression, there is no way to NOT read the entire frame of data, we'll just
-        //use the sparse data range since we'll have everything anyway so the ranges
-        //needed is relatively irrelevant
-        m_dataBlockSize = m_seqChannelCount;
-        m_rangesToRead = m_sparseRanges;
+            m_rangesToReadOffsets.push_back(rng.first);
+        }
     } else {
-        //no compression with sparse ranges
-        //FIXME - an intersection between the two would be useful, but hard
-        //for now, just assume that if it's sparse, it has all the data that is needed
-        //and read everything
-        m_dataBlockSize = m_seqChannelCount;
-        m_rangesToRead = m_sparseRanges;
+        //only read the parts of the sparse ranges that are actually needed.  For
+        //compressed files the whole frame is decompressed anyway, but this still
+        //limits the copying to what is used.
+        m_rangesToRead.clear();
+        m_dataBlockSize = 0;
+        uint32_t sparseOffset = 0;
+        for (auto &sp : m_sparseRanges) {
+            uint64_t spEnd = sp.first;
+            spEnd += sp.second;
+            for (auto &rng : ranges) {
+                uint64_t rngEnd = rng.first;
+                rngEnd += rng.second;
+                uint32_t st = std::max(sp.first, rng.first);
+                uint64_t end = std::min(spEnd, rngEnd);
+                if (st < end) {
+                    m_rangesToRead.push_back(std::pair<uint32_t, uint32_t>(st, end - st));
+                    m_rangesToReadOffsets.push_back(sparseOffset + st - sp.first);
+                    m_dataBlockSize += end - st;
+                }
+            }
+            sparseOffset += sp.second;
+        }
+        if (m_rangesToRead.empty()) {
+            m_rangesToRead.push_back(std::pair<uint32_t, uint32_t>(0, 0));
+            m_rangesToReadOffsets.push_back(0);
+        }
     }
+    LogDebug(VB_SEQUENCE, "Reading %d range(s), %d bytes per frame\n", (int)m_rangesToRead.size(), m_dataBlockSize);
     FrameData *f = getFrame(0);
     if (f) {
         delete f;
@@ -1397,6 +2207,36 @@ FrameData *V2FSEQFile::getFrame(uint32_t frame) {
     }
     return nullptr;
 }
+bool V2FSEQFile::readFrameData(uint32_t frame, uint8_t *buffer) {
+    if (m_rangesToRead.empty()) {
+        std::vector<std::pair<uint32_t, uint32_t>> range;
+        range.push_back(std::pair<uint32_t, uint32_t>(0, getMaxChannel() + 1));
+        prepareRead(range);
+    }
+    if (frame >= m_seqNumFrames || m_handler == nullptr) {
+        return false;
+    }
+    try {
+        return m_handler->readFrameData(frame, buffer);
+    } catch(...) {
+        LogErr(VB_SEQUENCE, "Error getting frame from handler %s.\n", m_handler->GetType().c_str());
+    }
+    return false;
+}
+void V2FSEQFile::unpackFrameData(const uint8_t *buffer, uint8_t *data) const {
+    unpackRanges(m_rangesToRead, buffer, data);
+}
+void V2FSEQFile::setReadAhead(int numBlocks, int numThreads) {
+    if (m_handler != nullptr) {
+        m_handler->setReadAhead(numBlocks < 0 ? 0 : numBlocks, numThreads < 1 ? 1 : numThreads);
+    }
+}
+void V2FSEQFile::getBlockDecodeStats(std::vector<BlockDecodeStats> &stats) {
+    stats.clear();
+    if (m_handler != nullptr) {
+        m_handler->getBlockDecodeStats(stats);
+    }
+}
 void V2FSEQFile::addFrame(uint32_t frame,
                           const uint8_t *data) {
     if (m_handler != nullptr) {
@@ -31,6 +31,24 @@ public:
         uint32_t frame;
     };
     
+    //decompression statistics for a block of a compressed file, times are in microseconds
+    class BlockDecodeStats {
+        public:
+        BlockDecodeStats() : firstFrame(0), numFrames(0), compressedSize(0), decodeCount(0), prefetchCount(0),
+            stallCount(0), lastDecodeTime(0), maxDecodeTime(0), totalDecodeTime(0), stallTime(0) {}
+
+        uint32_t firstFrame;
+        uint32_t numFrames;
+        uint64_t compressedSize;
+        uint32_t decodeCount;   //number of times the block was decompressed
+        uint32_t prefetchCount; //number of those done by the prefetch threads
+        uint32_t stallCount;    //number of times getFrame had to wait on a prefetch of the block
+        uint64_t lastDecodeTime;
+        uint64_t maxDecodeTime;
+        uint64_t totalDecodeTime;
+        uint64_t stallTime;
+    };
+
     enum CompressionType {
         none,
         zstd,
@@ -70,6 +88,19 @@ public:
     //provide the necessary data in a timely fassion for the given frame
     //It may not be used right away and will be deleted at some point in the future
     virtual FrameData *getFrame(uint32_t frame) = 0;
+
+    //For reading without allocating a FrameData for every frame.  The data for
+    //the ranges passed to prepareRead is copied back to back into buffer which
+    //must hold at least getFrameDataSize() bytes.  unpackFrameData then copies
+    //the ranges from the buffer to their channels in the channel data.
+    virtual uint32_t getFrameDataSize() const = 0;
+    virtual bool readFrameData(uint32_t frame, uint8_t *buffer) = 0;
+    virtual void unpackFrameData(const uint8_t *buffer, uint8_t *data) const = 0;
+
+    //For compressed files, decompress up to numBlocks blocks ahead of the
+    //block currently being read using numThreads background threads
+    virtual void setReadAhead(int numBlocks, int numThreads = 1) {}
+    virtual void getBlockDecodeStats(std::vector<BlockDecodeStats> &stats) { stats.clear(); }
     
     //For writing to the fseq file
     virtual void initializeFromFSEQ(const FSEQFile& fseq);
@@ -101,6 +132,14 @@ public:
     
     const std::vector<uint8_t> &getMemoryBuffer() const { return m_memoryBuffer;}
     uint64_t getMemoryBufferPos() const { return m_memoryBufferPos; }
+
+    //if true, frames are read directly out of an mmap of the file instead of
+    //through seek/read into a per frame buffer
+    bool isMemoryMapped() const { return m_memoryMap != nullptr; }
+    std::string getReadMode() const { return isMemoryMapped() ? "mmap" : "read"; }
+
+    //allow/disallow memory mapping of files opened after this call
+    static void setMemoryMapEnabled(bool b) { m_memoryMapEnabled = b; }
 protected:
     std::string   m_filename;
     uint64_t      m_uniqueId;
@@ -121,11 +160,18 @@ protected:
     uint64_t write(const void * ptr, uint64_t size);
     uint64_t read(void *ptr, uint64_t size);
     void preload(uint64_t pos, uint64_t size);
-    
+
+    //map the entire file read only, returns false if it could not be mapped
+    bool mapFile();
+    const uint8_t *getMappedData(uint64_t pos, uint64_t size) const;
+
 private:
     FILE* volatile  m_seqFile;
     std::vector<uint8_t> m_memoryBuffer;
     uint64_t      m_memoryBufferPos;
+
+    uint8_t      *m_memoryMap;
+    static bool   m_memoryMapEnabled;
 };
 
 
@@ -138,6 +184,9 @@ public:
   
     virtual void prepareRead(const std::vector<std::pair<uint32_t, uint32_t>> &ranges) override;
     virtual FrameData *getFrame(uint32_t frame) override;
+    virtual uint32_t getFrameDataSize() const override { return m_dataBlockSize; }
+    virtual bool readFrameData(uint32_t frame, uint8_t *buffer) override;
+    virtual void unpackFrameData(const uint8_t *buffer, uint8_t *data) const override;
 
     virtual void writeHeader() override;
     virtual void addFrame(uint32_t frame,
@@ -165,7 +214,14 @@ public:
     
     virtual void prepareRead(const std::vector<std::pair<uint32_t, uint32_t>> &ranges) override;
     virtual FrameData *getFrame(uint32_t frame) override;
+    virtual uint32_t getFrameDataSize() const override { return m_dataBlockSize; }
+    virtual bool readFrameData(uint32_t frame, uint8_t *buffer) override;
+    virtual void unpackFrameData(const uint8_t *buffer, uint8_t *data) const override;
+
+    virtual void setReadAhead(int numBlocks, int numThreads = 1) override;
+    virtual void getBlockDecodeStats(std::vector<BlockDecodeStats> &stats) override;
     
+    virtual void initializeFromFSEQ(const FSEQFile& fseq) override;
     virtual void writeHeader() override;
     virtual void addFrame(uint32_t frame,
                           const uint8_t *data) override;
@@ -173,13 +229,28 @@ public:
 
     virtual void dumpInfo(bool indent = false) override;
 
+    //zstd only, the dictionary is stored in the 'zd' variable header and
+    //is used for every block.  Must be set before writeHeader is called.
+    void setCompressionDictionary(const std::vector<uint8_t> &dict);
+    //train a dictionary of up to dictSize bytes from the sample data, returns
+    //an empty dictionary if one could not be created
+    static std::vector<uint8_t> trainCompressionDictionary(const std::vector<uint8_t> &samples,
+                                                           const std::vector<size_t> &sampleSizes,
+                                                           uint32_t dictSize);
+
     virtual uint32_t getMaxChannel() const override;
 
     
     CompressionType m_compressionType;
     int             m_compressionLevel;
+    int             m_compressionThreads; //when writing, compress blocks on this many threads
+    uint32_t        m_targetBlockSize; //when writing, uncompressed bytes per block, 0 to size by frame count
+    std::vector<uint8_t> m_compressionDictionary;
     std::vector<std::pair<uint32_t, uint32_t>> m_sparseRanges;
     std::vector<std::pair<uint32_t, uint32_t>> m_rangesToRead;
+    //offset of each range to read within a frame as stored in the file,
+    //differs from the channel number for sparse files
+    std::vector<uint32_t> m_rangesToReadOffsets;
     std::vector<std::pair<uint32_t, uint64_t>> m_frameOffsets;
     uint32_t m_dataBlockSize;
 private:
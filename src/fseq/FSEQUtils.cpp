@@ -4,6 +4,9 @@
 #include <string.h>
 #include <stdlib.h>
 #include <inttypes.h>
+#include <sys/time.h>
+
+#include <algorithm>
 
 #include "fppversion.h"
 #include "log.h"
@@ -23,7 +26,12 @@ void usage(char *appname) {
     printf("   -r (#-# | #+#)    - Channel Range.  Use - to separate start/end channel\n");
     printf("                            Use + to separate start channel + num channels\n");
     printf("   -n                - No Sparse. -r will only read the range, but the resulting fseq is not sparse.\n");
-    printf("   -j                - Output the fseq file metadata to json");
+    printf("   -j                - Output the fseq file metadata to json\n");
+    printf("   -M                - Disable memory mapped reads\n");
+    printf("   -t #              - Number of threads to use for compression\n");
+    printf("   -B #              - Size compression blocks by uncompressed size in KB instead of frame count\n");
+    printf("   -d #              - Train a zstd dictionary of # KB from the frames and store it in the fseq\n");
+    printf("   -b                - Benchmark compression levels.  Uses -l if specified, otherwise a range of levels.\n");
     printf("   -h                - This help output\n");
 }
 const char *outputFilename = nullptr;
@@ -33,6 +41,10 @@ static bool verbose = false;
 static std::vector<std::pair<uint32_t, uint32_t>> ranges;
 static bool sparse = true;
 static bool json = false;
+static bool benchmark = false;
+static int compressionThreads = 1;
+static uint32_t targetBlockSize = 0;
+static uint32_t dictionarySize = 0;
 static V2FSEQFile::CompressionType compressionType = V2FSEQFile::CompressionType::zstd;
 
 int parseArguments(int argc, char **argv) {
@@ -49,7 +61,7 @@ int parseArguments(int argc, char **argv) {
             {0,                0,                    0, 0}
         };
         
-        c = getopt_long(argc, argv, "c:l:o:f:r:hjVvn", long_options, &option_index);
+        c = getopt_long(argc, argv, "c:l:o:f:r:t:B:d:hjVvnMb", long_options, &option_index);
         if (c == -1) {
             break;
         }
@@ -95,6 +107,21 @@ int parseArguments(int argc, char **argv) {
             case 'n':
                 sparse = false;
                 break;
+            case 't':
+                compressionThreads = strtol(optarg, NULL, 10);
+                break;
+            case 'b':
+                benchmark = true;
+                break;
+            case 'B':
+                targetBlockSize = strtol(optarg, NULL, 10) * 1024;
+                break;
+            case 'd':
+                dictionarySize = strtol(optarg, NULL, 10) * 1024;
+                break;
+            case 'M':
+                FSEQFile::setMemoryMapEnabled(false);
+                break;
             case 'V':
                 printVersionInfo();
                 exit(0);
@@ -109,6 +136,133 @@ int parseArguments(int argc, char **argv) {
     return this_option_optind;
 }
 
+static uint64_t GetTime(void) {
+    struct timeval now_tv;
+    gettimeofday(&now_tv, NULL);
+    return now_tv.tv_sec * 1000000LL + now_tv.tv_usec;
+}
+
+//copy the frames from src to dest, returns the time (in us) spent writing
+static uint64_t copyFrames(FSEQFile *src, FSEQFile *dest) {
+    static uint8_t data[1024*1024];
+    uint64_t writeTime = 0;
+    for (int x = 0; x < src->getNumFrames(); x++) {
+        FSEQFile::FrameData *fdata = src->getFrame(x);
+        fdata->readFrame(data);
+        delete fdata;
+        uint64_t start = GetTime();
+        dest->addFrame(x, data);
+        writeTime += GetTime() - start;
+    }
+    uint64_t start = GetTime();
+    dest->finalize();
+    writeTime += GetTime() - start;
+    return writeTime;
+}
+
+//train a dictionary from frames spread throughout the sequence.  The frames
+//are gathered the same way the compressor will see them and split into
+//smaller samples as the trainer works best with lots of small samples.
+static std::vector<uint8_t> trainDictionary(FSEQFile *src, V2FSEQFile *dest) {
+    static const uint32_t SAMPLE_SIZE = 16 * 1024;
+    static const uint64_t MAX_SAMPLE_DATA = 8 * 1024 * 1024;
+    static uint8_t data[1024*1024];
+
+    std::vector<uint8_t> samples;
+    std::vector<size_t> sampleSizes;
+    uint32_t numFrames = src->getNumFrames();
+    if (numFrames == 0) {
+        return samples;
+    }
+    uint32_t frameSize = 0;
+    if (dest->m_sparseRanges.empty()) {
+        frameSize = src->getChannelCount();
+    } else {
+        for (auto &a : dest->m_sparseRanges) {
+            frameSize += a.second;
+        }
+    }
+    uint32_t framesToSample = numFrames;
+    if (frameSize && ((uint64_t)framesToSample * frameSize) > MAX_SAMPLE_DATA) {
+        framesToSample = std::max((uint64_t)1, MAX_SAMPLE_DATA / frameSize);
+    }
+    for (uint32_t x = 0; x < framesToSample; x++) {
+        uint32_t frame = (uint64_t)x * numFrames / framesToSample;
+        FSEQFile::FrameData *fdata = src->getFrame(frame);
+        if (fdata == nullptr) {
+            continue;
+        }
+        fdata->readFrame(data);
+        delete fdata;
+
+        size_t start = samples.size();
+        if (dest->m_sparseRanges.empty()) {
+            samples.insert(samples.end(), data, data + src->getChannelCount());
+        } else {
+            for (auto &a : dest->m_sparseRanges) {
+                uint32_t len = std::min(a.second, src->getChannelCount() - std::min(a.first, src->getChannelCount()));
+                samples.insert(samples.end(), &data[a.first], &data[a.first + len]);
+            }
+        }
+        for (size_t pos = start; pos < samples.size(); pos += SAMPLE_SIZE) {
+            sampleSizes.push_back(std::min((size_t)SAMPLE_SIZE, samples.size() - pos));
+        }
+    }
+    std::vector<uint8_t> dict = V2FSEQFile::trainCompressionDictionary(samples, sampleSizes, dictionarySize);
+    if (verbose) {
+        printf("Trained a %d byte dictionary from %d frames\n", (int)dict.size(), framesToSample);
+    }
+    return dict;
+}
+
+//apply the block size and dictionary options to a new v2 file, the file
+//must already be initialized from the source
+static void setupV2File(V2FSEQFile *dest, const std::vector<uint8_t> &dict) {
+    dest->m_compressionThreads = compressionThreads;
+    dest->m_targetBlockSize = targetBlockSize;
+    if (!dict.empty()) {
+        dest->setCompressionDictionary(dict);
+    }
+}
+
+static void runBenchmark(FSEQFile *src) {
+    std::vector<int> levels;
+    if (compressionLevel != -1) {
+        levels.push_back(compressionLevel);
+    } else if (compressionType == V2FSEQFile::CompressionType::zstd) {
+        levels = {1, 3, 5, 10, 15, 19};
+    } else if (compressionType == V2FSEQFile::CompressionType::zlib) {
+        levels = {1, 3, 6, 9};
+    } else {
+        levels.push_back(0);
+    }
+    if (ranges.empty()) {
+        ranges.push_back(std::pair<uint32_t, uint32_t>(0, 999999999));
+    }
+    src->prepareRead(ranges);
+
+    uint64_t rawSize = src->getChannelCount();
+    rawSize *= src->getNumFrames();
+    printf("Benchmarking %s: %d frames, %d channels, %d thread(s)\n",
+           basename(src->getFilename().c_str()), src->getNumFrames(), src->getChannelCount(), compressionThreads);
+    std::vector<uint8_t> dict;
+    for (auto level : levels) {
+        V2FSEQFile *dest = (V2FSEQFile*)FSEQFile::createFSEQFile("-memory-", 2, compressionType, level);
+        dest->initializeFromFSEQ(*src);
+        if (dictionarySize && dict.empty() && compressionType == V2FSEQFile::CompressionType::zstd) {
+            dict = trainDictionary(src, dest);
+        }
+        setupV2File(dest, dict);
+        dest->writeHeader();
+        uint64_t time = copyFrames(src, dest);
+        uint64_t size = dest->getMemoryBuffer().size();
+        double mbs = time ? (double)rawSize / (double)time : 0;
+        printf("Level %3d:  %8.2f MB/s    ratio %6.2f    size: %" PRIu64 "\n",
+               level, mbs, size ? (double)rawSize / (double)size : 0.0, size);
+        delete dest;
+    }
+}
+
 int main(int argc, char *argv[]) {
     int idx = parseArguments(argc, argv);
     if (verbose) {
@@ -117,7 +271,9 @@ int main(int argc, char *argv[]) {
     FSEQFile *src = FSEQFile::openFSEQFile(argv[idx]);
     if (src) {
         
-        if (json) {
+        if (benchmark) {
+            runBenchmark(src);
+        } else if (json) {
             /*
              getNumFrames() const { return m_seqNumFrames; }
              int           getStepTime() const { return m_seqStepTime; }
@@ -125,14 +281,15 @@ int main(int argc, char *argv[]) {
              uint64_t      getUniqueId() const { return m_uniqueId; }
              const std::string& getFilename() const { return m_filename; }
              */
-            printf("{\"Name\": \"%s\", \"Version\": \"%d.%d\", \"ID\": \"%" PRIu64 "\", \"StepTime\": %d, \"NumFrames\": %d, \"MaxChannel\": %d, \"ChannelCount\": %d",
+            printf("{\"Name\": \"%s\", \"Version\": \"%d.%d\", \"ID\": \"%" PRIu64 "\", \"StepTime\": %d, \"NumFrames\": %d, \"MaxChannel\": %d, \"ChannelCount\": %d, \"ReadMode\": \"%s\"",
                    basename(src->getFilename().c_str()),
                    src->getVersionMajor(), src->getVersionMinor(),
                    src->getUniqueId(),
                    src->getStepTime(),
                    src->getNumFrames(),
                    src->getMaxChannel(),
-                   src->getChannelCount()
+                   src->getChannelCount(),
+                   src->getReadMode().c_str()
                    );
             if (src->getVersionMajor() >= 2) {
                 V2FSEQFile *f = (V2FSEQFile*)src;
@@ -164,16 +321,17 @@ int main(int argc, char *argv[]) {
             src->prepareRead(ranges);
 
             dest->initializeFromFSEQ(*src);
-            dest->writeHeader();
-            
-            uint8_t data[1024*1024];
-            for (int x = 0; x < src->getNumFrames(); x++) {
-                FSEQFile::FrameData *fdata = src->getFrame(x);
-                fdata->readFrame(data);
-                delete fdata;
-                dest->addFrame(x, data);
+            if (fseqVersion == 2) {
+                V2FSEQFile *f = (V2FSEQFile*)dest;
+                std::vector<uint8_t> dict;
+                if (dictionarySize && compressionType == V2FSEQFile::CompressionType::zstd) {
+                    dict = trainDictionary(src, f);
+                }
+                setupV2File(f, dict);
             }
-            dest->finalize();
+            dest->writeHeader();
+
+            copyFrames(src, dest);
             
             if (!strcmp(outputFilename, "-memory-")) {
                 printf("size: %d\n", (int)dest->getMemoryBuffer().size());
@@ -26,6 +26,7 @@
 
 #include "channeloutput/channeloutput.h"
 #include "channeloutput/channeloutputthread.h"
+#include "channeloutput/UDPOutput.h"
 #include "common.h"
 #include "e131bridge.h"
 #include "fpp.h"
@@ -192,6 +193,22 @@ const http_response PlayerResource::render_GET(const http_request &req)
 	{
 		LogDebug(VB_HTTP, "API - Getting list of running sequences\n");
 	}
+	else if (url == "sequence/stats")
+	{
+		GetSequenceStats(result);
+	}
+	else if (url == "outputs/timing")
+	{
+		GetOutputTimingStats(result);
+	}
+	else if (url == "outputs/controllers")
+	{
+		GetControllerHealth(result);
+	}
+	else if (url == "outputs/udp")
+	{
+		GetUDPOutputStats(result);
+	}
 	else if (url == "testing")
 	{
 		LogDebug(VB_HTTP, "API - Getting test mode status\n");
@@ -593,6 +610,9 @@ void PlayerResource::GetLogSettings(Json::Value &result)
 
 	log["level"] = logLevelStr;
 	log["mask"] = logMaskStr;
+	log["async"] = AsyncLoggingEnabled() ? true : false;
+	log["overflowPolicy"] = GetLogOverflowPolicy();
+	log["dropped"] = GetDroppedLogMessageCount();
 	result["log"] = log;
 }
 
@@ -819,6 +839,71 @@ void PlayerResource::GetPlaylistConfig(Json::Value &result)
 	SetOKResult(result, "");
 }
 
+/*
+ *
+ */
+void PlayerResource::GetSequenceStats(Json::Value &result)
+{
+	LogDebug(VB_HTTP, "API - Getting sequence decode stats\n");
+
+	sequence->GetDecodeStats(result);
+
+	SetOKResult(result, "");
+}
+
+/*
+ *
+ */
+void PlayerResource::GetOutputTimingStats(Json::Value &result)
+{
+	LogDebug(VB_HTTP, "API - Getting channel output timing stats\n");
+
+	GetChannelOutputTimingStats(result);
+
+	SetOKResult(result, "");
+}
+
+/*
+ *
+ */
+void PlayerResource::GetControllerHealth(Json::Value &result)
+{
+	LogDebug(VB_HTTP, "API - Getting controller health\n");
+
+	if (UDPOutput::INSTANCE)
+	{
+		UDPOutput::INSTANCE->GetControllerHealth(result);
+	}
+	else
+	{
+		result["monitoring"] = false;
+		result["controllers"] = Json::Value(Json::arrayValue);
+	}
+
+	SetOKResult(result, "");
+}
+
+/*
+ *
+ */
+void PlayerResource::GetUDPOutputStats(Json::Value &result)
+{
+	LogDebug(VB_HTTP, "API - Getting UDP output stats\n");
+
+	if (UDPOutput::INSTANCE)
+	{
+		UDPOutput::INSTANCE->GetChangeDetectionStats(result);
+		UDPOutput::INSTANCE->GetShardStats(result);
+	}
+	else
+	{
+		result["changeDetection"]["enabled"] = false;
+		result["shards"] = Json::Value(Json::arrayValue);
+	}
+
+	SetOKResult(result, "");
+}
+
 /*
  *
  */
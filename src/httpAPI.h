@@ -52,6 +52,10 @@ class PlayerResource : public http_resource {
 	void GetMultiSyncSystems(Json::Value &result);
 	void GetPlaylistFileTime(Json::Value &result);
 	void GetPlaylistConfig(Json::Value &result);
+	void GetSequenceStats(Json::Value &result);
+	void GetOutputTimingStats(Json::Value &result);
+	void GetControllerHealth(Json::Value &result);
+	void GetUDPOutputStats(Json::Value &result);
 
 	void PostEffects(const std::string &effectName, const Json::Value &data,
 					Json::Value &result);
@@ -27,16 +27,26 @@
 #include "log.h"
 #include "settings.h"
 
+#include <fcntl.h>
 #include <stdio.h>
 #include <stdbool.h>
 #include <stdarg.h>
+#include <stdint.h>
 #include <string.h>
 #include <strings.h>
+#include <sys/stat.h>
 #include <sys/syscall.h>
 #include <sys/types.h>
 #include <time.h>
 #include <unistd.h>
 
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <mutex>
+#include <thread>
+#include <vector>
+
 int logLevel = LOG_INFO;
 int logMask  = VB_MOST;
 
@@ -44,6 +54,463 @@ char logFileName[1024] = "";
 char logLevelStr[16];
 char logMaskStr[1024];
 
+/////////////////////////////////////////////////////////////////////////////
+// Asynchronous logging
+//
+// Each thread that logs gets its own single producer/single consumer ring
+// of formatted records so logging doesn't take a lock or touch the log file
+// on the calling thread.  A background writer thread merges the rings back
+// into the order the messages were logged and writes them to the log file,
+// which it keeps open and reopens if the file is rotated out from under it.
+
+#define LOG_QUEUE_SIZE          (64 * 1024) // bytes per thread, power of 2
+#define LOG_MAX_MESSAGE_SIZE    2048
+#define LOG_WRITER_INTERVAL_MS  50
+#define LOG_REOPEN_CHECK_SECS   1
+
+typedef struct {
+	uint64_t    seq;
+	time_t      time;
+	long        tid;
+	const char *file;
+	int         line;
+	uint32_t    len; // message bytes following the header
+} LogRecordHeader;
+
+// Who is currently allowed to advance a queue's tail
+#define LOG_DRAINER_NONE    0
+#define LOG_DRAINER_WRITER  1
+#define LOG_DRAINER_CRASH   2
+
+class LogQueue {
+  public:
+	LogQueue() : head(0), tail(0), dropped(0), orphaned(false), drainer(LOG_DRAINER_NONE) {}
+
+	// head is only advanced by the thread that owns the queue, tail only by
+	// whoever has claimed the queue through drainer.  Both are free running
+	// byte counts.
+	std::atomic<uint32_t> head;
+	std::atomic<uint32_t> tail;
+	std::atomic<uint32_t> dropped;
+	std::atomic<bool>     orphaned; // owning thread has exited
+	std::atomic<int>      drainer;
+	char                  data[LOG_QUEUE_SIZE];
+
+	void put(uint32_t pos, const void *src, uint32_t len) {
+		uint32_t off = pos & (LOG_QUEUE_SIZE - 1);
+		uint32_t first = std::min(len, LOG_QUEUE_SIZE - off);
+		memcpy(&data[off], src, first);
+		memcpy(data, (const char *)src + first, len - first);
+	}
+	void get(uint32_t pos, void *dst, uint32_t len) const {
+		uint32_t off = pos & (LOG_QUEUE_SIZE - 1);
+		uint32_t first = std::min(len, LOG_QUEUE_SIZE - off);
+		memcpy(dst, &data[off], first);
+		memcpy((char *)dst + first, data, len - first);
+	}
+
+	// Take the right to drain this queue, fails if someone else has it
+	bool claim(int who) {
+		int expected = LOG_DRAINER_NONE;
+		return drainer.compare_exchange_strong(expected, who, std::memory_order_acquire);
+	}
+	void release(void) {
+		drainer.store(LOG_DRAINER_NONE, std::memory_order_release);
+	}
+};
+
+// Owns the calling thread's queue, marks it orphaned when the thread exits
+// so the writer can free it once it has been drained.
+class LogQueueOwner {
+  public:
+	LogQueueOwner();
+	~LogQueueOwner() { queue->orphaned = true; }
+
+	LogQueue *queue;
+	long      tid;
+};
+
+static std::atomic<bool>      asyncLogging(false);
+static std::atomic<bool>      logCrashed(false);
+static std::atomic<bool>      logDropOnOverflow(true);
+static std::atomic<uint64_t>  logSequence(0);
+static std::atomic<uint32_t>  logDroppedTotal(0);
+static std::mutex             logQueuesLock;
+static std::vector<LogQueue*> logQueues;
+static std::mutex             logWriterLock;
+static std::condition_variable logWriterSignal;
+static bool                   logWriterRunning = false;
+static std::thread           *logWriterThread = nullptr;
+static thread_local bool      isLogWriterThread = false;
+
+LogQueueOwner::LogQueueOwner() : queue(new LogQueue()), tid(syscall(SYS_gettid))
+{
+	std::unique_lock<std::mutex> lock(logQueuesLock);
+	logQueues.push_back(queue);
+}
+
+static void FormatLogTime(time_t t, char *timeStr)
+{
+	struct tm tm;
+
+	localtime_r(&t, &tm);
+	sprintf(timeStr,"%4d-%.2d-%.2d %.2d:%.2d:%.2d",
+					1900+tm.tm_year,
+					tm.tm_mon+1,
+					tm.tm_mday,
+					tm.tm_hour,
+					tm.tm_min,
+					tm.tm_sec);
+}
+
+/*
+ * Format the "time (tid) file:line:" prefix for a queued record.  timeStr
+ * is only reformatted when the time changes from lastTime.
+ */
+static int FormatLogPrefix(const LogRecordHeader &h, char *timeStr, time_t &lastTime,
+	char *prefix, int size)
+{
+	if (h.time != lastTime) {
+		lastTime = h.time;
+		FormatLogTime(h.time, timeStr);
+	}
+
+	int len = snprintf(prefix, size, "%s (%ld) %s:%d:", timeStr, h.tid, h.file, h.line);
+	if (len >= size)
+		len = size - 1;
+
+	return len;
+}
+
+/*
+ * Pop the oldest queued record across the given (claimed) queues into msg,
+ * returns false once they are all empty.
+ */
+static bool PopLogRecord(const std::vector<LogQueue*> &queues, LogRecordHeader &nh, char *msg)
+{
+	LogQueue *next = nullptr;
+	for (auto q : queues) {
+		uint32_t tail = q->tail.load(std::memory_order_relaxed);
+		if (q->head.load(std::memory_order_acquire) == tail)
+			continue;
+
+		LogRecordHeader h;
+		q->get(tail, &h, sizeof(h));
+		if (!next || (h.seq < nh.seq)) {
+			next = q;
+			nh = h;
+		}
+	}
+	if (!next)
+		return false;
+
+	uint32_t tail = next->tail.load(std::memory_order_relaxed);
+	next->get(tail + sizeof(nh), msg, nh.len);
+	msg[nh.len] = 0;
+	next->tail.store(tail + sizeof(nh) + nh.len, std::memory_order_release);
+
+	return true;
+}
+
+/*
+ * Queue a message on the calling thread's ring for the writer thread
+ */
+static void AsyncLogWrite(const char *file, int line, const char *format, va_list arg)
+{
+	static thread_local LogQueueOwner owner;
+	LogQueue *q = owner.queue;
+	char msg[LOG_MAX_MESSAGE_SIZE];
+
+	int len = vsnprintf(msg, sizeof(msg), format, arg);
+	if (len < 0)
+		return;
+	if (len >= (int)sizeof(msg))
+		len = sizeof(msg) - 1;
+
+	LogRecordHeader h;
+	h.seq = logSequence++;
+	h.time = time(NULL);
+	h.tid = owner.tid;
+	h.file = file;
+	h.line = line;
+	h.len = len;
+
+	uint32_t needed = sizeof(h) + len;
+	uint32_t head = q->head.load(std::memory_order_relaxed);
+	while ((LOG_QUEUE_SIZE - (head - q->tail.load(std::memory_order_acquire))) < needed) {
+		if (logDropOnOverflow || !asyncLogging) {
+			q->dropped++;
+			logDroppedTotal++;
+			return;
+		}
+		// blocking policy, give the writer a chance to catch up
+		logWriterSignal.notify_one();
+		std::this_thread::sleep_for(std::chrono::milliseconds(1));
+	}
+
+	q->put(head, &h, sizeof(h));
+	q->put(head + sizeof(h), msg, len);
+	q->head.store(head + needed, std::memory_order_release);
+
+	// wake the writer early if the queue is getting full
+	if ((head + needed - q->tail.load(std::memory_order_relaxed)) > (LOG_QUEUE_SIZE / 2))
+		logWriterSignal.notify_one();
+}
+
+/*
+ * Open/reopen the log file for the writer thread if needed
+ */
+static FILE *GetAsyncLogFile(FILE *logFile, char *openName, time_t &lastCheck)
+{
+	if (!logFileName[0] || !strcmp(logFileName, "stdout"))
+		return stdout;
+	if (!strcmp(logFileName, "stderr"))
+		return stderr;
+
+	time_t now = time(NULL);
+	if (logFile && !strcmp(openName, logFileName)) {
+		if (now < (lastCheck + LOG_REOPEN_CHECK_SECS))
+			return logFile;
+
+		// reopen if the file has been rotated or removed
+		struct stat fst;
+		struct stat nst;
+		lastCheck = now;
+		if ((stat(logFileName, &nst) == 0) &&
+			(fstat(fileno(logFile), &fst) == 0) &&
+			(fst.st_ino == nst.st_ino) &&
+			(fst.st_dev == nst.st_dev))
+			return logFile;
+	}
+
+	if (logFile && (logFile != stdout) && (logFile != stderr))
+		fclose(logFile);
+
+	lastCheck = now;
+	strcpy(openName, logFileName);
+	logFile = fopen(logFileName, "a");
+	if (!logFile) {
+		fprintf(stderr, "Error: Unable to open log file for writing!\n");
+		openName[0] = 0;
+		return stderr;
+	}
+
+	return logFile;
+}
+
+/*
+ * Write everything queued so far, in the order it was logged
+ */
+static void DrainLogQueues(FILE *logFile)
+{
+	// skip any queue the crash handler has already claimed
+	std::vector<LogQueue*> queues;
+	{
+		std::unique_lock<std::mutex> lock(logQueuesLock);
+		for (auto q : logQueues) {
+			if (q->claim(LOG_DRAINER_WRITER))
+				queues.push_back(q);
+		}
+	}
+
+	char msg[LOG_MAX_MESSAGE_SIZE];
+	char prefix[256];
+	char timeStr[32];
+	time_t lastTime = 0;
+	LogRecordHeader nh;
+
+	timeStr[0] = 0;
+	while (PopLogRecord(queues, nh, msg)) {
+		FormatLogPrefix(nh, timeStr, lastTime, prefix, sizeof(prefix));
+		fprintf(logFile, "%s%s", prefix, msg);
+	}
+
+	uint32_t dropped = 0;
+	for (auto q : queues) {
+		dropped += q->dropped.exchange(0);
+		q->release();
+	}
+	if (dropped) {
+		FormatLogTime(time(NULL), timeStr);
+		fprintf(logFile, "%s (%ld) %s:%d:%u log message(s) dropped, log queue full\n",
+			timeStr, syscall(SYS_gettid), __FILE__, __LINE__, dropped);
+	}
+
+	fflush(logFile);
+
+	// free the queues of threads that have exited
+	std::unique_lock<std::mutex> lock(logQueuesLock);
+	for (auto it = logQueues.begin(); it != logQueues.end(); ) {
+		LogQueue *q = *it;
+		if (q->orphaned && (q->head == q->tail)) {
+			it = logQueues.erase(it);
+			delete q;
+		} else {
+			++it;
+		}
+	}
+}
+
+static void RunLogWriterThread(void)
+{
+	FILE *logFile = nullptr;
+	char openName[1024] = "";
+	time_t lastCheck = 0;
+
+	isLogWriterThread = true;
+
+	std::unique_lock<std::mutex> lock(logWriterLock);
+	while (true) {
+		logWriterSignal.wait_for(lock, std::chrono::milliseconds(LOG_WRITER_INTERVAL_MS));
+		bool running = logWriterRunning;
+		lock.unlock();
+
+		logFile = GetAsyncLogFile(logFile, openName, lastCheck);
+		DrainLogQueues(logFile);
+
+		lock.lock();
+		if (!running)
+			break;
+	}
+
+	if (logFile && (logFile != stdout) && (logFile != stderr))
+		fclose(logFile);
+}
+
+/*
+ * Start writing log messages from a background thread.  Must be called
+ * after any fork() since the writer thread would not survive it.
+ */
+void StartAsyncLogging(void)
+{
+	std::unique_lock<std::mutex> lock(logWriterLock);
+	if (logWriterThread)
+		return;
+
+	logWriterRunning = true;
+	logWriterThread = new std::thread(RunLogWriterThread);
+	asyncLogging = true;
+	lock.unlock();
+
+	atexit(StopAsyncLogging);
+}
+
+/*
+ * Flush anything queued and go back to writing synchronously
+ */
+void StopAsyncLogging(void)
+{
+	// after a crash the writer may never finish, don't wait on it at exit
+	if (logCrashed)
+		return;
+
+	std::unique_lock<std::mutex> lock(logWriterLock);
+	if (!logWriterThread)
+		return;
+
+	asyncLogging = false;
+	if (logWriterThread->get_id() == std::this_thread::get_id()) {
+		// called from the writer itself (crash), can't wait on it
+		return;
+	}
+
+	logWriterRunning = false;
+	logWriterSignal.notify_all();
+	lock.unlock();
+
+	logWriterThread->join();
+
+	lock.lock();
+	delete logWriterThread;
+	logWriterThread = nullptr;
+}
+
+/*
+ * Called from the crash handler.  Switches back to synchronous logging and
+ * writes out whatever is still queued using write(2).  Nothing here waits
+ * on a lock or on the writer thread since the crashed thread may be holding
+ * one or be the writer, if the queue list is busy the queued messages are
+ * skipped.  Lines get the same "time (tid) file:line:" prefix the writer
+ * thread uses.
+ */
+void FlushLogsForCrash(void)
+{
+	logCrashed = true;
+	asyncLogging = false;
+
+	if (!logQueuesLock.try_lock())
+		return;
+
+	// Claim each queue so the writer thread can't drain it at the same
+	// time, any the writer is already part way through are left to it
+	// unless the writer is the thread that crashed.
+	std::vector<LogQueue*> queues;
+	for (auto q : logQueues) {
+		if (q->claim(LOG_DRAINER_CRASH) ||
+			(isLogWriterThread && (q->drainer == LOG_DRAINER_WRITER)))
+			queues.push_back(q);
+	}
+
+	int fd = STDOUT_FILENO;
+	bool opened = false;
+	if (!strcmp(logFileName, "stderr")) {
+		fd = STDERR_FILENO;
+	} else if (logFileName[0] && strcmp(logFileName, "stdout")) {
+		fd = open(logFileName, O_WRONLY | O_APPEND | O_CREAT, 0644);
+		opened = fd >= 0;
+	}
+
+	char msg[LOG_MAX_MESSAGE_SIZE];
+	char prefix[256];
+	char timeStr[32];
+	time_t lastTime = 0;
+	LogRecordHeader nh;
+
+	timeStr[0] = 0;
+	while ((fd >= 0) && PopLogRecord(queues, nh, msg)) {
+		int len = FormatLogPrefix(nh, timeStr, lastTime, prefix, sizeof(prefix));
+		if ((write(fd, prefix, len) < 0) || (write(fd, msg, nh.len) < 0))
+			break;
+	}
+
+	if (opened)
+		close(fd);
+
+	for (auto q : queues)
+		q->release();
+
+	logQueuesLock.unlock();
+}
+
+int SetLogOverflowPolicy(const char *policy)
+{
+	if (!strcmp(policy, "drop")) {
+		logDropOnOverflow = true;
+	} else if (!strcmp(policy, "block")) {
+		logDropOnOverflow = false;
+	} else {
+		LogErr(VB_SETTING, "Unknown Log Overflow Policy: %s\n", policy);
+		return 0;
+	}
+
+	return 1;
+}
+
+const char *GetLogOverflowPolicy(void)
+{
+	return logDropOnOverflow ? "drop" : "block";
+}
+
+int AsyncLoggingEnabled(void)
+{
+	return asyncLogging ? 1 : 0;
+}
+
+unsigned int GetDroppedLogMessageCount(void)
+{
+	return logDroppedTotal;
+}
+
 void _LogWrite(const char *file, int line, int level, int facility, const char *format, ...)
 {
 	// Don't log if we're not logging this facility
@@ -55,18 +522,17 @@ void _LogWrite(const char *file, int line, int level, int facility, const char *
 		return;
 
 	va_list arg;
-	time_t t = time(NULL);
-	struct tm tm;
+
+	if (asyncLogging) {
+		va_start(arg, format);
+		AsyncLogWrite(file, line, format, arg);
+		va_end(arg);
+		return;
+	}
+
 	char timeStr[32];
 
-	localtime_r(&t, &tm);
-	sprintf(timeStr,"%4d-%.2d-%.2d %.2d:%.2d:%.2d",
-					1900+tm.tm_year,
-					tm.tm_mon+1,
-					tm.tm_mday,
-					tm.tm_hour,
-					tm.tm_min,
-					tm.tm_sec);
+	FormatLogTime(time(NULL), timeStr);
 
 	if (logFileName[0])
 	{
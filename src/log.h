@@ -83,6 +83,14 @@ int SetLogMask(const char *newMask);
 int loggingToFile(void);
 void logVersionInfo(void);
 
+void StartAsyncLogging(void);
+void StopAsyncLogging(void);
+void FlushLogsForCrash(void);
+int AsyncLoggingEnabled(void);
+int SetLogOverflowPolicy(const char *policy);
+const char *GetLogOverflowPolicy(void);
+unsigned int GetDroppedLogMessageCount(void);
+
 
 #define LogMaskIsSet(x)  (logMask & x)
 #define LogLevelIsSet(x) (logLevel >= x)
@@ -4,6 +4,8 @@
 #include <sys/socket.h>
 #include <sys/file.h>
 #include <sys/time.h>
+#include <errno.h>
+#include <fcntl.h>
 
 #include <netinet/in_systm.h>
 #include <netinet/in.h>
@@ -214,3 +216,89 @@ int ping(string target)
     return 0;
 }
 
+
+
+/*
+ * Open a raw ICMP socket in non-blocking mode
+ */
+int OpenPingSocket(void)
+{
+    int sock = socket(AF_INET, SOCK_RAW, IPPROTO_ICMP);
+    if (sock < 0)
+        return -1;
+
+    int flags = fcntl(sock, F_GETFL, 0);
+    if ((flags < 0) || (fcntl(sock, F_SETFL, flags | O_NONBLOCK) < 0))
+    {
+        close(sock);
+        return -1;
+    }
+
+    return sock;
+}
+
+/*
+ * Send a single echo request without waiting for the reply
+ */
+int SendPing(int sock, const struct in_addr &addr, uint16_t id, uint16_t seq)
+{
+    u_char outpack[DEFDATALEN + ICMP_MINLEN];
+    struct sockaddr_in to;
+    struct icmp *icp = (struct icmp *)outpack;
+    int cc = DEFDATALEN + ICMP_MINLEN;
+
+    memset(outpack, 0, sizeof(outpack));
+    icp->icmp_type = ICMP_ECHO;
+    icp->icmp_code = 0;
+    icp->icmp_cksum = 0;
+    icp->icmp_seq = seq;
+    icp->icmp_id = id;
+    icp->icmp_cksum = in_cksum((uint16_t *)icp, cc);
+
+    memset(&to, 0, sizeof(to));
+    to.sin_family = AF_INET;
+    to.sin_addr = addr;
+
+    int i = sendto(sock, (char *)outpack, cc, MSG_DONTWAIT, (struct sockaddr*)&to, (socklen_t)sizeof(struct sockaddr_in));
+    if (i != cc)
+        return -1;
+
+    return 0;
+}
+
+/*
+ * Read the next pending echo reply carrying our id.  Returns 1 when a
+ * reply was read, 0 when nothing (else) is queued and -1 on error.
+ */
+int ReceivePingReply(int sock, uint16_t id, struct in_addr &from, uint16_t &seq)
+{
+    u_char packet[DEFDATALEN + MAXIPLEN + MAXICMPLEN];
+    struct sockaddr_in fromAddr;
+
+    while (true)
+    {
+        socklen_t fromlen = sizeof(fromAddr);
+        int ret = recvfrom(sock, (char *)packet, sizeof(packet), MSG_DONTWAIT, (struct sockaddr *)&fromAddr, &fromlen);
+        if (ret < 0)
+        {
+            if ((errno == EAGAIN) || (errno == EWOULDBLOCK))
+                return 0;
+            if (errno == EINTR)
+                continue;
+            return -1;
+        }
+
+        struct ip *ip = (struct ip *)packet;
+        int hlen = ip->ip_hl << 2;
+        if (ret < (hlen + ICMP_MINLEN))
+            continue;
+
+        struct icmp *icp = (struct icmp *)(packet + hlen);
+        if ((icp->icmp_type != ICMP_ECHOREPLY) || (icp->icmp_id != id))
+            continue;
+
+        from = fromAddr.sin_addr;
+        seq = icp->icmp_seq;
+        return 1;
+    }
+}
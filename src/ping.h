@@ -2,9 +2,18 @@
 #define __PING_H__
 
 #include <string>
+#include <stdint.h>
+#include <netinet/in.h>
 
 int ping(std::string target);
 
-#endif
-
+/*
+ * Non-blocking ICMP echo helpers.  Callers open their own raw socket,
+ * fire off requests to any number of hosts and then collect whatever
+ * replies have arrived, so no single dead host stalls the caller.
+ */
+int OpenPingSocket(void);
+int SendPing(int sock, const struct in_addr &addr, uint16_t id, uint16_t seq);
+int ReceivePingReply(int sock, uint16_t id, struct in_addr &from, uint16_t &seq);
 
+#endif
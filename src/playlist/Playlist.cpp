@@ -43,6 +43,7 @@
 #include "fpp.h"
 #include "log.h"
 #include "mqtt.h"
+#include "MultiSync.h"
 #include "Playlist.h"
 #include "settings.h"
 
@@ -89,7 +90,8 @@ Playlist::Playlist(void *parent, int subPlaylist)
 	m_currentState("idle"),
 	m_currentSectionStr("New"),
 	m_sectionPosition(0),
-	m_startPosition(0)
+	m_startPosition(0),
+	m_prearmedFor(NULL)
 {
 	SetIdle();
 
@@ -377,6 +379,7 @@ void Playlist::SwitchToMainPlaylist(void)
 	m_currentSectionStr = "MainPlaylist";
 	m_currentSection    = &m_mainPlaylist;
 	m_sectionPosition   = 0;
+	m_prearmedFor = NULL;
 	m_mainPlaylist[0]->StartPlaying();
 }
 
@@ -390,6 +393,7 @@ void Playlist::SwitchToLeadOut(void)
 	m_currentSectionStr = "LeadOut";
 	m_currentSection    = &m_leadOut;
 	m_sectionPosition   = 0;
+	m_prearmedFor = NULL;
 	m_leadOut[0]->StartPlaying();
 }
 
@@ -466,6 +470,7 @@ int Playlist::Start(void)
 	}
 
 
+	m_prearmedFor = NULL;
 	m_currentSection->at(m_sectionPosition)->StartPlaying();
 
 	if (mqtt)
@@ -571,6 +576,9 @@ int Playlist::Process(void)
 	if (m_currentSection->at(m_sectionPosition)->IsPlaying())
 		m_currentSection->at(m_sectionPosition)->Process();
 
+	if (m_prearmedFor != m_currentSection->at(m_sectionPosition))
+		PrearmNextSequence();
+
 	if (m_currentSection->at(m_sectionPosition)->IsFinished())
 	{
 		LogDebug(VB_PLAYLIST, "Playlist entry finished\n");
@@ -690,6 +698,7 @@ int Playlist::Process(void)
 						LogDebug(VB_PLAYLIST, "mainPlaylist repeating for another loop, %d <= %d\n", m_loop, m_loopCount);
 
 					m_sectionPosition = 0;
+					m_prearmedFor = NULL;
 					m_mainPlaylist[0]->StartPlaying();
 				}
 				else if (m_leadOut.size())
@@ -713,6 +722,7 @@ int Playlist::Process(void)
 		else
 		{
 			// Start the next item in the current section
+			m_prearmedFor = NULL;
 			m_currentSection->at(m_sectionPosition)->StartPlaying();
 		}
 
@@ -726,6 +736,52 @@ int Playlist::Process(void)
 	return 1;
 }
 
+/*
+ * Let the remotes know which sequence should be up next so they can open
+ * it while the current entry is still playing.  This is only a guess,
+ * branches and random playlists may pick something else in which case the
+ * remotes just open the real one when the start packet arrives.
+ */
+void Playlist::PrearmNextSequence(void)
+{
+	m_prearmedFor = m_currentSection->at(m_sectionPosition);
+
+	if ((getFPPmode() != MASTER_MODE) || !multiSync || m_random)
+		return;
+
+	PlaylistEntryBase *next = NULL;
+	if ((m_sectionPosition + 1) < m_currentSection->size())
+	{
+		next = m_currentSection->at(m_sectionPosition + 1);
+	}
+	else if (m_currentSectionStr == "LeadIn")
+	{
+		if (m_mainPlaylist.size())
+			next = m_mainPlaylist[0];
+		else if (m_leadOut.size())
+			next = m_leadOut[0];
+	}
+	else if (m_currentSectionStr == "MainPlaylist")
+	{
+		if (m_repeat && (!m_loopCount || ((m_loop + 1) < m_loopCount)))
+			next = m_mainPlaylist[0];
+		else if (m_leadOut.size())
+			next = m_leadOut[0];
+	}
+
+	if (!next)
+		return;
+
+	std::string sequenceName;
+	if (next->GetType() == "sequence")
+		sequenceName = ((PlaylistEntrySequence*)next)->GetSequenceName();
+	else if (next->GetType() == "both")
+		sequenceName = ((PlaylistEntryBoth*)next)->GetSequenceName();
+
+	if (sequenceName != "")
+		multiSync->SendSeqOpenPacket(sequenceName.c_str());
+}
+
 /*
  *
  */
@@ -761,6 +817,7 @@ void Playlist::SetIdle(void)
 	m_startPosition = 0;
 	m_sectionPosition = 0;
 	m_repeat = 0;
+	m_prearmedFor = NULL;
 
 	// Remoted per issue #506
 	//Cleanup();
@@ -809,6 +866,7 @@ int Playlist::Cleanup(void)
 	m_loopCount = 0;
 	m_startTime = 0;
 	m_currentSectionStr = "New";
+	m_prearmedFor = NULL;
 
 	return 1;
 }
@@ -140,6 +140,7 @@ class Playlist {
 	void               ReloadIfNeeded(void);
 	void               SwitchToMainPlaylist(void);
 	void               SwitchToLeadOut(void);
+	void               PrearmNextSequence(void);
 
 	void                *m_parent;
 	std::string          m_filename;
@@ -174,6 +175,7 @@ class Playlist {
 	std::vector<PlaylistEntryBase*>  m_mainPlaylist;
 	std::vector<PlaylistEntryBase*>  m_leadOut;
 	std::vector<PlaylistEntryBase*> *m_currentSection;
+	PlaylistEntryBase               *m_prearmedFor;
 };
 
 // Temporary singleton during conversion
@@ -374,6 +374,13 @@ int parseSetting(char *key, char *value)
 		else
 			SetLogMask("");
 	}
+	else if ( strcmp(key, "LogOverflowPolicy") == 0 )
+	{
+		if (strlen(value))
+			SetLogOverflowPolicy(value);
+		else
+			SetLogOverflowPolicy("drop");
+	}
 	else if ( strcmp(key, "logFile") == 0 )
 	{
 		if ( strlen(value) )
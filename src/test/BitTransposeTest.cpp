@@ -0,0 +1,121 @@
+/*
+ *   BitPlaneTranspose() test for Falcon Player (FPP)
+ *
+ *   Copyright (C) 2013-2018 the Falcon Player Developers
+ *      Initial development by:
+ *      - David Pitts (dpitts)
+ *      - Tony Mace (MyKroFt)
+ *      - Mathew Mrosko (Materdaddy)
+ *      - Chris Pinkham (CaptainMurdoch)
+ *      For additional credits and developers, see credits.php.
+ *
+ *   The Falcon Player (FPP) is free software; you can redistribute it
+ *   and/or modify it under the terms of the GNU General Public License
+ *   as published by the Free Software Foundation; either version 2 of
+ *   the License, or (at your option) any later version.
+ *
+ *   This program is distributed in the hope that it will be useful,
+ *   but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *   GNU General Public License for more details.
+ *
+ *   You should have received a copy of the GNU General Public License
+ *   along with this program; if not, see <http://www.gnu.org/licenses/>.
+ */
+
+/*
+ * Compares BitPlaneTranspose() byte for byte against the per-bit loop
+ * BBBMatrix used to build its bit planes.
+ *
+ * Build with "make bittransposetest", exits non-zero on a mismatch.
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include <vector>
+
+#include "channeloutput/BitTranspose.h"
+
+/*
+ * One panel row the way BBBMatrix lays it out, 'width' pixels each
+ * feeding 'channels' output bytes, converted to 'depth' bit planes.
+ */
+static bool TestRow(int width, int channels, int depth)
+{
+	int groups = (width + 7) / 8;
+	int rowLen = groups * channels;
+
+	std::vector<uint8_t> values(width * channels);
+	for (auto &v : values)
+		v = rand();
+
+	// scalar path, test and set one bit at a time
+	std::vector<uint8_t> expected(rowLen * depth, 0);
+	for (int x = 0; x < width; x++) {
+		int bitPos = 1 << (x % 8);
+		for (int c = 0; c < channels; c++) {
+			uint8_t v = values[x * channels + c];
+			int xOff = x / 8 * channels + c;
+			for (int bit = 8; bit > (8 - depth); ) {
+				--bit;
+				if (v & (1 << bit))
+					expected[xOff] |= bitPos;
+				xOff += rowLen;
+			}
+		}
+	}
+
+	// bulk path, stage the 8 pixels sharing an output byte together
+	std::vector<uint8_t> stage(rowLen * 8, 0);
+	for (int x = 0; x < width; x++) {
+		for (int c = 0; c < channels; c++)
+			stage[(x / 8 * channels + c) * 8 + x % 8] = values[x * channels + c];
+	}
+
+	// poison the output so bytes that are never written show up
+	std::vector<uint8_t> actual(rowLen * depth, 0xA5);
+	BitPlaneTranspose(&stage[0], &actual[0], rowLen, rowLen, depth);
+
+	for (int i = 0; i < rowLen * depth; i++) {
+		if (actual[i] != expected[i]) {
+			printf("width %d, channels %d, depth %d: byte %d is 0x%02X, expected 0x%02X\n",
+				width, channels, depth, i, actual[i], expected[i]);
+			return false;
+		}
+	}
+
+	return true;
+}
+
+int main(int argc, char *argv[])
+{
+	srand(argc > 1 ? atoi(argv[1]) : 1);
+
+	int tests = 0;
+	int failures = 0;
+
+	// widths that aren't a multiple of 8 leave the end of the last
+	// group empty
+	for (int width = 1; width <= 80; width++) {
+		for (int channels = 1; channels <= 6; channels++) {
+			for (int depth = 1; depth <= 8; depth++) {
+				tests++;
+				if (!TestRow(width, channels, depth))
+					failures++;
+			}
+		}
+	}
+
+	// full size rows, 8 outputs of 4 chained 64 wide panels
+	for (int depth = 6; depth <= 8; depth++) {
+		tests++;
+		if (!TestRow(4 * 64, 8 * 2 * 3, depth))
+			failures++;
+	}
+
+	printf("%d of %d tests passed\n", tests - failures, tests);
+
+	return failures ? 1 : 0;
+}
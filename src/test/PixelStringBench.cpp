@@ -0,0 +1,143 @@
+/*
+ *   PixelString remap benchmark for Falcon Player (FPP)
+ *
+ *   Copyright (C) 2013-2018 the Falcon Player Developers
+ *      Initial development by:
+ *      - David Pitts (dpitts)
+ *      - Tony Mace (MyKroFt)
+ *      - Mathew Mrosko (Materdaddy)
+ *      - Chris Pinkham (CaptainMurdoch)
+ *      For additional credits and developers, see credits.php.
+ *
+ *   The Falcon Player (FPP) is free software; you can redistribute it
+ *   and/or modify it under the terms of the GNU General Public License
+ *   as published by the Free Software Foundation; either version 2 of
+ *   the License, or (at your option) any later version.
+ *
+ *   This program is distributed in the hope that it will be useful,
+ *   but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *   GNU General Public License for more details.
+ *
+ *   You should have received a copy of the GNU General Public License
+ *   along with this program; if not, see <http://www.gnu.org/licenses/>.
+ */
+
+/*
+ * Times PixelString::Remap() against the per-channel m_outputMap lookup it
+ * replaced, on 48 strings of 1024 pixels written 48 bytes apart the way
+ * BBB48String interleaves them.  Each string is two 512 pixel virtual
+ * strings since a single one is limited to 999 pixels.  The outputs are
+ * compared first so the numbers are for identical work.
+ *
+ * Build with "make pixelstringbench"
+ * Usage: pixelstringbench [colorOrder] [brightness] [gamma] [iterations]
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include <chrono>
+#include <vector>
+
+#include "channeloutput/PixelString.h"
+
+#define BENCH_STRINGS 48
+#define BENCH_PIXELS  1024
+#define BENCH_VIRTUAL 2
+
+// the lookup PixelString did for every channel before Remap()
+static void MapLoop(PixelString *ps, const std::vector<const uint8_t*> &maps,
+                    const uint8_t *in, uint8_t *out, int stride)
+{
+	for (int p = 0; p < ps->m_outputChannels; p++) {
+		*out = maps[p][in[ps->m_outputMap[p]]];
+		out += stride;
+	}
+}
+
+int main(int argc, char *argv[])
+{
+	const char *colorOrder = argc > 1 ? argv[1] : "RGB";
+	int brightness = argc > 2 ? atoi(argv[2]) : 100;
+	const char *gamma = argc > 3 ? argv[3] : "1.0";
+	int iterations = argc > 4 ? atoi(argv[4]) : 1000;
+	int nodeChannels = strlen(colorOrder) == 4 ? 4 : 3;
+	int frameSize = BENCH_STRINGS * BENCH_PIXELS * nodeChannels;
+
+	std::vector<PixelString*> strings;
+	std::vector<std::vector<const uint8_t*> > maps;
+	for (int s = 0; s < BENCH_STRINGS; s++) {
+		Json::Value config;
+		config["portNumber"] = s;
+
+		for (int v = 0; v < BENCH_VIRTUAL; v++) {
+			Json::Value vs;
+			vs["startChannel"] = (s * BENCH_VIRTUAL + v) * (BENCH_PIXELS / BENCH_VIRTUAL) * nodeChannels;
+			vs["pixelCount"] = BENCH_PIXELS / BENCH_VIRTUAL;
+			vs["groupCount"] = 0;
+			vs["reverse"] = 0;
+			vs["nullNodes"] = 0;
+			vs["zigZag"] = 0;
+			vs["brightness"] = brightness;
+			vs["gamma"] = gamma;
+			vs["colorOrder"] = colorOrder;
+			config["virtualStrings"].append(vs);
+		}
+
+		PixelString *ps = new PixelString();
+		if (!ps->Init(config)) {
+			printf("Could not set up string %d\n", s);
+			return 1;
+		}
+		strings.push_back(ps);
+
+		std::vector<const uint8_t*> m;
+		for (auto &vs : ps->m_virtualStrings)
+			m.insert(m.end(), vs.pixelCount * vs.channelsPerNode(), vs.brightnessMap);
+		maps.push_back(m);
+	}
+
+	std::vector<uint8_t> in(frameSize);
+	for (auto &c : in)
+		c = rand();
+
+	std::vector<uint8_t> expected(frameSize);
+	std::vector<uint8_t> actual(frameSize);
+
+	for (int s = 0; s < BENCH_STRINGS; s++) {
+		MapLoop(strings[s], maps[s], &in[0], &expected[s], BENCH_STRINGS);
+		strings[s]->Remap(&in[0], &actual[s], BENCH_STRINGS);
+	}
+	if (expected != actual) {
+		printf("Remap() output does not match the per-channel lookup\n");
+		return 1;
+	}
+
+	auto t1 = std::chrono::steady_clock::now();
+	for (int i = 0; i < iterations; i++) {
+		for (int s = 0; s < BENCH_STRINGS; s++) {
+			MapLoop(strings[s], maps[s], &in[0], &expected[s], BENCH_STRINGS);
+		}
+	}
+	auto t2 = std::chrono::steady_clock::now();
+	for (int i = 0; i < iterations; i++) {
+		for (int s = 0; s < BENCH_STRINGS; s++)
+			strings[s]->Remap(&in[0], &actual[s], BENCH_STRINGS);
+	}
+	auto t3 = std::chrono::steady_clock::now();
+
+	double mapTime = std::chrono::duration<double, std::micro>(t2 - t1).count() / iterations;
+	double remapTime = std::chrono::duration<double, std::micro>(t3 - t2).count() / iterations;
+
+	printf("%d strings x %d pixels, color order %s, brightness %d, gamma %s, %d iterations\n",
+		BENCH_STRINGS, BENCH_PIXELS, colorOrder, brightness, gamma, iterations);
+	printf("  per-channel lookup: %8.1f us/frame\n", mapTime);
+	printf("  Remap()           : %8.1f us/frame\n", remapTime);
+
+	for (auto ps : strings)
+		delete ps;
+
+	return 0;
+}
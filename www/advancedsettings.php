@@ -112,6 +112,112 @@ If
 				output devices such as the FPD do not support rates other than 50ms.</td>
 		</tr>
 		<tr><td colspan='2'><hr></td></tr>
+		<tr><td valign='top'><? PrintSettingSelect("Sequence Read-Ahead", "fseqReadAheadBlocks", 0, 0, "1", Array('Disabled' => '-1', '1 block' => '1', '2 blocks' => '2', '3 blocks' => '3', '4 blocks' => '4')); ?></td>
+			<td valign='top'><b>Sequence Read-Ahead</b> - The number of compressed
+				sequence blocks to decompress in the background ahead of the block
+				currently being played.  More blocks use more memory but can help
+				large sequences play smoothly across block boundaries.  Per-block
+				decode times are available from the fppd/sequence/stats API.
+				Takes effect the next time a sequence is started.</td>
+		</tr>
+		<tr><td colspan='2'><hr></td></tr>
+		<tr><td valign='top'><? PrintSettingSelect("Sequence Frame Cache", "sequenceCacheFrames", 0, 0, "0", Array('Auto' => '0', '8 frames' => '8', '12 frames' => '12', '20 frames' => '20', '30 frames' => '30', '40 frames' => '40')); ?></td>
+			<td valign='top'><b>Sequence Frame Cache</b> - The number of frames read
+				ahead of the frame currently being played.  The buffers are allocated
+				when the sequence is started.  Auto uses up to 8MB, but between 8 and
+				20 frames, depending on the number of channels in the sequence.
+				Takes effect the next time a sequence is started.</td>
+		</tr>
+		<tr><td colspan='2'><hr></td></tr>
+		<tr><td valign='top'><? PrintSettingSelect("Output Thread Priority", "outputThreadPriority", 0, 0, "0", Array('Normal' => '0', 'Realtime Low (10)' => '10', 'Realtime Medium (50)' => '50', 'Realtime High (80)' => '80')); ?></td>
+			<td valign='top'><b>Output Thread Priority</b> - Run the channel output
+				thread with SCHED_FIFO realtime priority so web UI or plugin load
+				doesn't delay frames.  Takes effect the next time output starts.</td>
+		</tr>
+		<tr><td colspan='2'><hr></td></tr>
+		<tr><td valign='top'><? PrintSettingSelect("Pipelined Output", "outputPipeline", 0, 0, "0", Array('Disabled' => '0', 'Enabled' => '1')); ?></td>
+			<td valign='top'><b>Pipelined Output</b> - Read and process the next
+				frame (effects, overlays, output processors) on a second thread while
+				the current frame is being sent.  Useful on multi-core systems with
+				large or busy outputs.  Not used in bridge mode.  Takes effect the next
+				time output starts.</td>
+		</tr>
+		<tr><td colspan='2'><hr></td></tr>
+		<tr><td valign='top'><? PrintSettingSelect("Skip Unchanged Universes", "UDPChangeDetection", 0, 0, "0", Array('Disabled' => '0', 'Enabled' => '1')); ?></td>
+			<td valign='top'><b>Skip Unchanged Universes</b> - Only send E1.31, ArtNet
+				and DDP packets whose channel data changed since they were last sent,
+				plus a periodic keep-alive.  Cuts network traffic for static props,
+				especially over wireless bridges.  Packet counts are available from
+				/fppd/outputs/udp.  Takes effect after restarting fppd.</td>
+		</tr>
+		<tr><td colspan='2'><hr></td></tr>
+		<tr><td valign='top'><? PrintSettingSelect("Unchanged Universe Keep-Alive", "UDPKeepAliveInterval", 0, 0, "1000", Array('250ms' => '250', '500ms' => '500', '800ms' => '800', '1s' => '1000', '2s' => '2000', '4s' => '4000')); ?></td>
+			<td valign='top'><b>Unchanged Universe Keep-Alive</b> - How often an
+				unchanged universe is resent when Skip Unchanged Universes is enabled.
+				E1.31 receivers time out after 2.5 seconds without data, so keep this at
+				1 second or less unless only ArtNet is used.</td>
+		</tr>
+		<tr><td colspan='2'><hr></td></tr>
+		<tr><td valign='top'><? PrintSettingText("E131SyncUniverse", 1, 0, 5, 5); ?><br>
+				<? PrintSettingSave("E1.31 Sync Universe", "E131SyncUniverse", 1, 0); ?></td>
+			<td valign='top'><b>E1.31 Sync Universe</b> - When set to a non-zero
+				universe number, E1.31 outputs send a synchronization packet on this
+				universe after each frame so controllers that support E1.31 sync
+				display all universes at the same time instead of as they arrive.
+				Leave blank or 0 to disable.  Changing this value requires a FPPD
+				restart.</td>
+		</tr>
+		<tr><td colspan='2'><hr></td></tr>
+		<tr><td valign='top'><? PrintSettingSelect("UDP Output Pacing", "UDPPacing", 1, 0, "0", Array('Disabled' => '0', '25% of frame' => '25', '50% of frame' => '50', '75% of frame' => '75')); ?></td>
+			<td valign='top'><b>UDP Output Pacing</b> - Spread large numbers of
+				E1.31, ArtNet and DDP packets over part of each frame instead of
+				sending them in a single burst, which can overflow the buffers in
+				small network switches.  Sync packets are still sent after all of the
+				data.</td>
+		</tr>
+		<tr><td colspan='2'><hr></td></tr>
+		<tr><td valign='top'><? PrintSettingSelect("UDP Send Threads", "UDPSendThreads", 1, 0, "0", Array('Disabled' => '0', '2 threads' => '2', '3 threads' => '3', '4 threads' => '4')); ?></td>
+			<td valign='top'><b>UDP Send Threads</b> - Split the E1.31, ArtNet and
+				DDP data across several sockets, each sent from its own thread.  Each
+				controller's packets always go through the same socket.  Helps
+				multi-core systems driving very large numbers of universes.  Per-thread
+				send times are available from /fppd/outputs/udp.</td>
+		</tr>
+		<tr><td colspan='2'><hr></td></tr>
+		<tr><td valign='top'><? PrintSettingText("UDPSendThreadCPUs", 1, 0, 16, 16); ?><br>
+				<? PrintSettingSave("UDP Send Thread CPUs", "UDPSendThreadCPUs", 1, 0); ?></td>
+			<td valign='top'><b>UDP Send Thread CPUs</b> - Comma separated list of
+				CPU cores to pin the UDP send threads to, one per thread, for example
+				"1,2,3".  Leave blank to let the threads run on any core.</td>
+		</tr>
+		<tr><td colspan='2'><hr></td></tr>
+		<tr><td valign='top'><? PrintSettingText("UDPSendInterfaces", 1, 0, 64, 32); ?><br>
+				<? PrintSettingSave("UDP Send Interfaces", "UDPSendInterfaces", 1, 0); ?></td>
+			<td valign='top'><b>UDP Send Interfaces</b> - Comma separated list of
+				network interfaces for the UDP send threads, one per thread, for
+				example "eth0,eth1".  Threads without an entry use the E1.31
+				interface.</td>
+		</tr>
+		<tr><td colspan='2'><hr></td></tr>
+		<tr><td valign='top'><? PrintSettingSelect("Output Thread CPU", "outputThreadCPU", 0, 0, "", Array('Any' => '', 'CPU 0' => '0', 'CPU 1' => '1', 'CPU 2' => '2', 'CPU 3' => '3')); ?></td>
+			<td valign='top'><b>Output Thread CPU</b> - Pin the channel output thread
+				to a single CPU core.  Frame timing stats are available from
+				/fppd/outputs/timing.  Takes effect the next time output starts.</td>
+		</tr>
+		<tr><td colspan='2'><hr></td></tr>
+		<tr><td valign='top'><? PrintSettingSelect("Background Logging", "LogAsync", 1, 0, "1", Array('Enabled' => '1', 'Disabled' => '0')); ?></td>
+			<td valign='top'><b>Background Logging</b> - Queue log messages and write
+				them to the log file from a background thread so debug logging doesn't
+				affect frame timing.  Disable to write each message as it is logged.</td>
+		</tr>
+		<tr><td colspan='2'><hr></td></tr>
+		<tr><td valign='top'><? PrintSettingSelect("Log Queue Overflow", "LogOverflowPolicy", 1, 0, "drop", Array('Drop Messages' => 'drop', 'Wait' => 'block')); ?></td>
+			<td valign='top'><b>Log Queue Overflow</b> - What to do with background
+				logging when a thread logs faster than the log file can be written.
+				Dropping keeps the logging thread from stalling, the number of dropped
+				messages is written to the log.  Waiting keeps every message.</td>
+		</tr>
+		<tr><td colspan='2'><hr></td></tr>
 		<tr><td valign='top'><? PrintSettingSelect("Boot Delay", "bootDelay", 0, 0, "0", Array('0s' => '0', '1s' => '1', '2s' => '2', '3s' => '3', '4s' => '4', '5s' => '5', '6s' => '6', '7s' => '7', '8s' => '8', '9s' => '9', '10s' => '10', '15s' => '10', '20s' => '20', '25s' => '25', '30s' => '30')); ?></td>
 			<td valign='top'><b>Boot Delay</b> - The time that FPP waits after
 				system boot up to start fppd.  For environments that are